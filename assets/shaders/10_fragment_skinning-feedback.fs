@@ -0,0 +1,8 @@
+#version 330 core
+// El skinning con transform feedback corre con GL_RASTERIZER_DISCARD: nunca llega aquí
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(0.0);
+}
@@ -0,0 +1,68 @@
+#version 330 core
+// Personaje ya deformado por SkinnedVertexCache: mismas salidas y misma física del salto que
+// 10_vertex_skinning-physics.vs, pero sin mezclar huesos (la pose ya viene en los vértices)
+layout (location = 0) in vec3 aPos;       // espacio del modelo, con la pose aplicada
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+out vec3 ex_N;
+out vec3 vertexPosition_cameraspace;
+out vec3 Normal_cameraspace;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// ========== UNIFORMS DE FÍSICA ==========
+uniform float physicsTime;
+uniform bool isJumping;
+uniform float initialVelocity;
+uniform float lunarGravity;
+uniform float astronautMass;
+uniform float groundLevel;
+
+void main()
+{
+    // 1-2. La pose ya está aplicada
+    vec4 PosL = vec4(aPos, 1.0);
+
+    // 3. Transformar al espacio del mundo
+    // IMPORTANTE: La matriz model YA incluye initialTranslation (se aplica en CPU)
+    vec4 worldPosition = model * PosL;
+    
+    // 4. ========== APLICAR FÍSICA DEL SALTO EN ESPACIO WORLD ==========
+    if (isJumping) {
+        // Ecuaciones cinemáticas: y = v0*t - (1/2)*g*t²
+        float t = physicsTime;
+        float v0 = initialVelocity;
+        float g = lunarGravity;
+        
+        float verticalDisplacement = (v0 * t) - (0.5 * g * t * t);
+        
+        // No atravesar el suelo
+        verticalDisplacement = max(verticalDisplacement, 0.0);
+        
+        // Aplicar desplazamiento vertical en ESPACIO WORLD (coordenada Y global)
+        worldPosition.y += verticalDisplacement;
+    }
+    
+    // 5. Asegurar nivel del suelo
+    worldPosition.y = max(worldPosition.y, groundLevel);
+    
+    // 6. Transformar a espacio de cámara y clip space
+    vec4 viewPosition = view * worldPosition;
+    gl_Position = projection * viewPosition;
+
+    // 7. Outputs para iluminación correcta
+    TexCoords = aTexCoords;
+    
+    // Posición en espacio de cámara para iluminación
+    vertexPosition_cameraspace = viewPosition.xyz;
+    
+    // La normal ya viene deformada
+    vec3 transformedNormal = aNormal;
+    Normal_cameraspace = mat3(view) * mat3(model) * transformedNormal;
+    
+    ex_N = transformedNormal;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#version 330 core
+// Skinning con transform feedback (SkinnedVertexCache): deforma cada vértice una sola vez por pose y
+// escribe posición, normal y UV en espacio del modelo; no se rasteriza nada. Las pasadas que dibujan
+// el resultado usan un vertex shader estático (10_vertex_preskinned-physics.vs).
+layout (location = 0) in vec3  aPos;
+layout (location = 1) in vec3  aNormal;
+layout (location = 2) in vec2  aTexCoords;
+layout (location = 5) in uvec4 bIDs1;     // uint8, glVertexAttribIPointer
+layout (location = 6) in uvec4 bIDs2;
+layout (location = 7) in uvec4 bIDs3;
+layout (location = 8) in vec4  bWeights1;
+layout (location = 9) in vec4  bWeights2;
+layout (location = 10) in vec4 bWeights3;
+
+// capturadas en este orden (SKINNING_FEEDBACK_VARYINGS)
+out vec3 skinnedPosition;
+out vec3 skinnedNormal;
+out vec2 skinnedTexCoords;
+
+// Paleta del personaje (BonePaletteBuffer): tres filas (mat3x4) por hueso
+layout (std140) uniform BonePalette {
+    vec4 gBoneRows[300];
+};
+
+vec4 boneRow0, boneRow1, boneRow2;
+
+void addBone(uint bone, float weight)
+{
+    int i = int(bone) * 3;
+    boneRow0 += gBoneRows[i]     * weight;
+    boneRow1 += gBoneRows[i + 1] * weight;
+    boneRow2 += gBoneRows[i + 2] * weight;
+}
+
+void main()
+{
+    boneRow0 = vec4(0.0);
+    boneRow1 = vec4(0.0);
+    boneRow2 = vec4(0.0);
+    for (int i = 0; i < 4; i++) {
+        addBone(bIDs1[i], bWeights1[i]);
+        addBone(bIDs2[i], bWeights2[i]);
+        addBone(bIDs3[i], bWeights3[i]);
+    }
+    mat4 BoneTransform = transpose(mat4(boneRow0, boneRow1, boneRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+
+    skinnedPosition = (BoneTransform * vec4(aPos, 1.0)).xyz;
+    skinnedNormal = mat3(BoneTransform) * aNormal;
+    skinnedTexCoords = aTexCoords;
+    gl_Position = vec4(skinnedPosition, 1.0);
+}
@@ -0,0 +1,79 @@
+#version 330 core
+// Skinning instanciado para multitudes (AnimatedCrowdObject): la paleta de cada instancia se lee
+// de la textura de animación pre-muestreada, con su clip y su tiempo; no hay uniform gBones.
+layout (location = 0) in vec3  aPos;
+layout (location = 1) in vec3  aNormal;
+layout (location = 2) in vec2  aTexCoords;
+layout (location = 5) in uvec4 bIDs1;     // uint8, glVertexAttribIPointer
+layout (location = 6) in uvec4 bIDs2;
+layout (location = 7) in uvec4 bIDs3;
+layout (location = 8) in vec4  bWeights1;
+layout (location = 9) in vec4  bWeights2;
+layout (location = 10) in vec4 bWeights3;
+
+out vec2 TexCoords;
+out vec3 ex_N;
+out vec3 vertexPosition_cameraspace;
+out vec3 Normal_cameraspace;
+
+uniform mat4 model;       // transformación de toda la multitud
+uniform mat4 view;
+uniform mat4 projection;
+
+// AnimationTexture: una fila por frame, tres texels (filas de la matriz) por hueso
+uniform sampler2D boneTexture;
+uniform ivec2 clipFrames[16];         // primer frame y número de frames de cada clip
+uniform float animationSampleRate;    // frames por segundo
+uniform float animationTime;          // segundos
+
+// cuatro texels por instancia: filas de su matriz y (clip, desfase, velocidad, 0)
+uniform samplerBuffer instanceData;
+
+vec4 boneRow0, boneRow1, boneRow2;
+
+void addBone(int frame, uint bone, float weight)
+{
+    if (weight <= 0.0) return;
+    int x = int(bone) * 3;
+    boneRow0 += texelFetch(boneTexture, ivec2(x,     frame), 0) * weight;
+    boneRow1 += texelFetch(boneTexture, ivec2(x + 1, frame), 0) * weight;
+    boneRow2 += texelFetch(boneTexture, ivec2(x + 2, frame), 0) * weight;
+}
+
+void main()
+{
+    // 1. Instancia: matriz, clip y frame actual (el clip se repite)
+    int base = gl_InstanceID * 4;
+    vec4 instanceRow0 = texelFetch(instanceData, base);
+    vec4 instanceRow1 = texelFetch(instanceData, base + 1);
+    vec4 instanceRow2 = texelFetch(instanceData, base + 2);
+    vec4 playback     = texelFetch(instanceData, base + 3);
+    mat4 instanceMatrix = transpose(mat4(instanceRow0, instanceRow1, instanceRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+
+    ivec2 clip = clipFrames[int(playback.x)];
+    float time = animationTime * playback.z + playback.y;
+    int frame = clip.x + int(mod(floor(time * animationSampleRate), float(clip.y)));
+
+    // 2. Paleta mezclada como mat3x4 (tres filas)
+    boneRow0 = vec4(0.0);
+    boneRow1 = vec4(0.0);
+    boneRow2 = vec4(0.0);
+    for (int i = 0; i < 4; i++) {
+        addBone(frame, bIDs1[i], bWeights1[i]);
+        addBone(frame, bIDs2[i], bWeights2[i]);
+        addBone(frame, bIDs3[i], bWeights3[i]);
+    }
+    mat4 BoneTransform = transpose(mat4(boneRow0, boneRow1, boneRow2, vec4(0.0, 0.0, 0.0, 1.0)));
+
+    // 3. Hueso -> instancia -> multitud -> mundo
+    vec4 worldPosition = model * instanceMatrix * BoneTransform * vec4(aPos, 1.0);
+    vec4 viewPosition = view * worldPosition;
+    gl_Position = projection * viewPosition;
+
+    // 4. Outputs para iluminación (mismos que 10_vertex_skinning-physics.vs)
+    TexCoords = aTexCoords;
+    vertexPosition_cameraspace = viewPosition.xyz;
+    vec3 transformedNormal = mat3(instanceMatrix) * mat3(BoneTransform) * aNormal;
+    Normal_cameraspace = mat3(view) * mat3(model) * transformedNormal;
+    ex_N = transformedNormal;
+}
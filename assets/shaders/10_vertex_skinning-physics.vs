@@ -2,11 +2,10 @@
 layout (location = 0) in vec3  aPos;
 layout (location = 1) in vec3  aNormal;
 layout (location = 2) in vec2  aTexCoords;
-layout (location = 3) in vec3  tangent;
-layout (location = 4) in vec3  bitangent;
-layout (location = 5) in vec4  bIDs1;
-layout (location = 6) in vec4  bIDs2;
-layout (location = 7) in vec4  bIDs3;
+layout (location = 3) in vec4  tangent;   // w = signo de la bitangente
+layout (location = 5) in uvec4 bIDs1;     // uint8, glVertexAttribIPointer
+layout (location = 6) in uvec4 bIDs2;
+layout (location = 7) in uvec4 bIDs3;
 layout (location = 8) in vec4  bWeights1;
 layout (location = 9) in vec4  bWeights2;
 layout (location = 10) in vec4 bWeights3;
@@ -19,7 +18,11 @@ out vec3 Normal_cameraspace;
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
-uniform mat4 gBones[100];
+
+// Paleta del personaje (BonePaletteBuffer): tres filas (mat3x4) por hueso, sólo los del esqueleto
+layout (std140) uniform BonePalette {
+    vec4 gBoneRows[300];
+};
 
 // ========== UNIFORMS DE FÍSICA ==========
 uniform float physicsTime;
@@ -29,23 +32,28 @@ uniform float lunarGravity;
 uniform float astronautMass;
 uniform float groundLevel;
 
-void main()
-{
-    // 1. Aplicar transformación de huesos (animación esquelética)
-    mat4 BoneTransform = gBones[int(bIDs1[0])] * bWeights1[0];
-    BoneTransform += gBones[int(bIDs1[1])] * bWeights1[1];
-    BoneTransform += gBones[int(bIDs1[2])] * bWeights1[2];  
-    BoneTransform += gBones[int(bIDs1[3])] * bWeights1[3];
+vec4 boneRow0, boneRow1, boneRow2;
 
-    BoneTransform += gBones[int(bIDs2[0])] * bWeights2[0];
-    BoneTransform += gBones[int(bIDs2[1])] * bWeights2[1];
-    BoneTransform += gBones[int(bIDs2[2])] * bWeights2[2]; 
-    BoneTransform += gBones[int(bIDs2[3])] * bWeights2[3];
+void addBone(uint bone, float weight)
+{
+    int i = int(bone) * 3;
+    boneRow0 += gBoneRows[i]     * weight;
+    boneRow1 += gBoneRows[i + 1] * weight;
+    boneRow2 += gBoneRows[i + 2] * weight;
+}
 
-    BoneTransform += gBones[int(bIDs3[0])] * bWeights3[0];
-    BoneTransform += gBones[int(bIDs3[1])] * bWeights3[1];
-    BoneTransform += gBones[int(bIDs3[2])] * bWeights3[2]; 
-    BoneTransform += gBones[int(bIDs3[3])] * bWeights3[3];
+void main()
+{
+    // 1. Aplicar transformación de huesos (animación esquelética), mezclada como mat3x4
+    boneRow0 = vec4(0.0);
+    boneRow1 = vec4(0.0);
+    boneRow2 = vec4(0.0);
+    for (int i = 0; i < 4; i++) {
+        addBone(bIDs1[i], bWeights1[i]);
+        addBone(bIDs2[i], bWeights2[i]);
+        addBone(bIDs3[i], bWeights3[i]);
+    }
+    mat4 BoneTransform = transpose(mat4(boneRow0, boneRow1, boneRow2, vec4(0.0, 0.0, 0.0, 1.0)));
 
     // 2. Aplicar transformación de huesos al vértice
     vec4 PosL = BoneTransform * vec4(aPos, 1.0f);
@@ -0,0 +1,33 @@
+#version 330 core
+layout (location = 0) in vec3  aPos;
+layout (location = 1) in vec3  aNormal;  // 10:10:10:2 normalizado, se expande solo a vec3
+layout (location = 2) in vec2  aTexCoords; // half float
+layout (location = 3) in vec4  tangent;   // w = signo de la bitangente
+
+out vec2 TexCoords;
+out vec3 ex_N;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform vec3 eye;
+
+out vec3 vertexPosition_cameraspace;
+out vec3 Normal_cameraspace;
+
+void main()
+{
+
+    vec4 PosL = vec4(aPos, 1.0f);
+
+    gl_Position = projection * view * model * PosL;
+
+    TexCoords = aTexCoords;  
+    
+    vertexPosition_cameraspace = ( view * model * vec4(aPos,1)).xyz;
+
+    Normal_cameraspace = ( view * model * vec4(aNormal,0)).xyz;
+
+    ex_N = aNormal;
+}
\ No newline at end of file
@@ -0,0 +1,152 @@
+#ifndef ANIMATED_CROWD_OBJECT_H
+#define ANIMATED_CROWD_OBJECT_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <animatedmodel.h>
+#include <animationtexture.h>
+#include <shader_m.h>
+#include "RenderableObject.h"
+
+#include <vector>
+
+// unidades de textura del shader instanciado; las de material empiezan en 0
+#define CROWD_BONE_TEXTURE_UNIT     14
+#define CROWD_INSTANCE_TEXTURE_UNIT 15
+// texels RGBA32F por instancia: tres filas de la matriz model y (clip, desfase, velocidad, 0)
+#define CROWD_TEXELS_PER_INSTANCE   4
+
+// Un personaje de la multitud, en el espacio del objeto
+struct CrowdInstance {
+    glm::vec3    position;
+    float        yaw;          // grados alrededor de Y
+    float        scale;
+    unsigned int clip;
+    float        timeOffset;   // segundos, para que no vayan todos al paso
+    float        playbackRate;
+};
+
+/**
+ * @brief Multitud de personajes animados dibujada con un draw instanciado por malla
+ * Los clips del modelo se pre-muestrean en una AnimationTexture y cada instancia sólo guarda su
+ * transformación, su clip y su desfase en un buffer de textura que se sube cuando cambian.
+ * Por cuadro no se evalúa ninguna pose ni se sube ninguna paleta: el tiempo es un solo uniform.
+ * Usa 10_vertex_skinning-instanced.vs con el fragment shader de los personajes.
+ */
+class AnimatedCrowdObject : public RenderableObject {
+private:
+    AnimatedModel*        animatedModel;
+    AnimationTexture      animationTexture;
+    vector<CrowdInstance> instances;
+    GLuint                instanceBuffer;
+    GLuint                instanceTexture;
+    bool                  instancesDirty;
+    float                 animationTime; // segundos desde que se creó
+
+public:
+    // sampleRate: frames por segundo con que se pre-muestrean los clips
+    AnimatedCrowdObject(AnimatedModel* mdl, Shader* shdr, float sampleRate = 30.0f,
+        glm::vec3 pos = glm::vec3(0.0f))
+        : RenderableObject(nullptr, shdr, pos),
+          animatedModel(mdl), instanceBuffer(0), instanceTexture(0),
+          instancesDirty(false), animationTime(0.0f) {
+        if (animatedModel) {
+            animationTexture.bake(animatedModel->skeleton, animatedModel->animations,
+                animatedModel->compressedAnimations.empty() ? nullptr : &animatedModel->compressedAnimations, sampleRate);
+        }
+    }
+
+    ~AnimatedCrowdObject() {
+        if (instanceTexture) glDeleteTextures(1, &instanceTexture);
+        if (instanceBuffer) glDeleteBuffers(1, &instanceBuffer);
+    }
+
+    AnimatedCrowdObject(const AnimatedCrowdObject&) = delete;
+    AnimatedCrowdObject& operator=(const AnimatedCrowdObject&) = delete;
+
+    size_t addInstance(const glm::vec3& pos, float yaw = 0.0f, unsigned int clip = 0,
+        float timeOffset = 0.0f, float playbackRate = 1.0f, float instanceScale = 1.0f) {
+        instances.push_back(CrowdInstance{ pos, yaw, instanceScale, clip, timeOffset, playbackRate });
+        instancesDirty = true;
+        return instances.size() - 1;
+    }
+
+    // para mover o cambiar de clip a una instancia (se vuelve a subir el buffer en el siguiente render)
+    CrowdInstance& getInstance(size_t index) {
+        instancesDirty = true;
+        return instances[index];
+    }
+
+    size_t getInstanceCount() const { return instances.size(); }
+
+    void clearInstances() {
+        instances.clear();
+        instancesDirty = true;
+    }
+
+    void update(float deltaTime) override {
+        animationTime += deltaTime;
+    }
+
+    void render(const glm::mat4& projection, const glm::mat4& view,
+        const LightManager& lightManager, const glm::vec3& eyePosition) override {
+        if (!animatedModel || !shader || !animationTexture.valid() || instances.empty()) return;
+        if (instancesDirty) uploadInstances();
+
+        shader->use();
+        shader->setMat4("projection", projection);
+        shader->setMat4("view", view);
+        shader->setMat4("model", getModelMatrix());
+        shader->setFloat("animationTime", animationTime);
+
+        animationTexture.bind(*shader, CROWD_BONE_TEXTURE_UNIT);
+        glActiveTexture(GL_TEXTURE0 + CROWD_INSTANCE_TEXTURE_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+        glActiveTexture(GL_TEXTURE0);
+        shader->setInt("instanceData", CROWD_INSTANCE_TEXTURE_UNIT);
+
+        lightManager.applyLights(shader, affectedLights);
+
+        shader->setVec3("eye", eyePosition);
+        shader->setVec4("MaterialAmbientColor", material.ambient);
+        shader->setVec4("MaterialDiffuseColor", material.diffuse);
+        shader->setVec4("MaterialSpecularColor", material.specular);
+        shader->setFloat("transparency", material.transparency);
+
+        TextureResidency::instance().require(animatedModel->textures_loaded, FLT_MAX);
+
+        animatedModel->DrawInstanced(*shader, (GLsizei)instances.size());
+        glUseProgram(0);
+    }
+
+    const AnimationTexture& getAnimationTexture() const { return animationTexture; }
+
+private:
+    void uploadInstances() {
+        vector<glm::vec4> texels;
+        texels.reserve(instances.size() * CROWD_TEXELS_PER_INSTANCE);
+        for (const CrowdInstance& instance : instances) {
+            glm::mat4 m = glm::translate(glm::mat4(1.0f), instance.position);
+            m = glm::rotate(m, glm::radians(instance.yaw), glm::vec3(0.0f, 1.0f, 0.0f));
+            m = glm::scale(m, glm::vec3(instance.scale));
+            for (int r = 0; r < 3; r++)
+                texels.push_back(glm::vec4(m[0][r], m[1][r], m[2][r], m[3][r]));
+            unsigned int clip = instance.clip < animationTexture.clips.size() ? instance.clip : 0;
+            texels.push_back(glm::vec4((float)clip, instance.timeOffset, instance.playbackRate, 0.0f));
+        }
+
+        if (!instanceBuffer) {
+            glGenBuffers(1, &instanceBuffer);
+            glGenTextures(1, &instanceTexture);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, instanceBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)(texels.size() * sizeof(glm::vec4)), texels.data(), GL_DYNAMIC_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, instanceTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        instancesDirty = false;
+    }
+};
+
+#endif // ANIMATED_CROWD_OBJECT_H
@@ -3,22 +3,51 @@
 
 #include <glm/glm.hpp>
 #include <animatedmodel.h>
+#include <bonepalette.h>
+#include <skinnedvertexcache.h>
 #include <shader_m.h>
 #include "RenderableObject.h"
 #include "PhysicsSystem.h"
 
+// Estados de locomocin que maneja el objeto cuando se le dan sus clips (setLocomotionClips)
+enum LocomotionState {
+    LOCOMOTION_IDLE,
+    LOCOMOTION_WALK,
+    LOCOMOTION_RUN,
+    LOCOMOTION_JUMP,
+    LOCOMOTION_STATE_COUNT
+};
+
 /**
  * @brief Objeto renderizable con animacin
+ * El modelo (mallas, esqueleto y clips) se puede compartir entre varios objetos;
+ * cada objeto lleva su propia AnimationInstance con su tiempo y su paleta de huesos.
  */
 class AnimatedRenderableObject : public RenderableObject {
 private:
     AnimatedModel* animatedModel;
+    AnimationInstance animation;
     glm::vec3* externalPosition;
     float* externalRotation;
     bool isMoving;
     glm::vec3 lastPosition;
     PhysicsSystem* physicsSystem;
 
+    // Grafo de locomocin (idle/walk/run/jump); si no se configura se usa slo "animation"
+    AnimationGraph locomotion;
+    bool useLocomotion;
+    int locomotionStates[LOCOMOTION_STATE_COUNT]; // estado del grafo de cada LocomotionState, -1 si no hay clip
+    float runSpeed;     // unidades por segundo a partir de las que se corre
+    float fadeSeconds;  // duracin de las transiciones
+    float speed;        // velocidad medida en el ltimo update
+
+    // Paleta en GPU; slo se sube cuando cambia la versin de la pose
+    BonePaletteBuffer bonePalette;
+
+    // Skinning una vez por pose con transform feedback (ver setSkinningShader)
+    Shader* skinningShader;
+    SkinnedVertexCache skinnedVertices;
+
 public:
     AnimatedRenderableObject(AnimatedModel* mdl, Shader* shdr, PhysicsSystem* physics,
         glm::vec3* extPos = nullptr, float* extRot = nullptr,
@@ -26,7 +55,13 @@ public:
         : RenderableObject(nullptr, shdr, glm::vec3(0.0f), glm::vec3(0.0f), scl),
           animatedModel(mdl), physicsSystem(physics),
           externalPosition(extPos), externalRotation(extRot),
-          isMoving(false), lastPosition(0.0f) {
+          isMoving(false), lastPosition(0.0f),
+          useLocomotion(false), runSpeed(0.0f), fadeSeconds(0.0f), speed(0.0f),
+          skinningShader(nullptr) {
+        for (int i = 0; i < LOCOMOTION_STATE_COUNT; i++) locomotionStates[i] = -1;
+        if (animatedModel) {
+            animation = animatedModel->createInstance();
+        }
         if (externalPosition) {
             lastPosition = *externalPosition;
         }
@@ -43,6 +78,7 @@ public:
             float movementDistance = glm::length(positionDelta);
 
             isMoving = (movementDistance > movementThreshold);
+            speed = deltaTime > 0.0f ? movementDistance / deltaTime : 0.0f;
             lastPosition = position;
         }
 
@@ -50,9 +86,14 @@ public:
             rotation.y = *externalRotation;
         }
 
+        if (animatedModel && useLocomotion) {
+            // El grafo elige el estado y mezcla la transicin; siempre avanza (idle tambin se anima)
+            locomotion.crossFade(chooseLocomotionState(), fadeSeconds);
+            locomotion.update(deltaTime);
+        }
         // Actualizar la animacin solo si el modelo se est moviendo
-        if (animatedModel && isMoving) {
-            animatedModel->UpdateAnimation(deltaTime);
+        else if (animatedModel && isMoving) {
+            animation.update(deltaTime);
         }
 
         // Actualizar el sistema de fsicas (salto)
@@ -61,17 +102,70 @@ public:
         }
     }
 
+    bool hasPendingPose() const override {
+        return useLocomotion ? locomotion.hasPendingPose() : animation.hasPendingPose();
+    }
+
+    bool getBoundingSphere(glm::vec3& center, float& radius) const override {
+        if (!animatedModel || animatedModel->boundingRadius <= 0.0f) return false;
+        return worldBoundingSphere(getModelMatrix(), animatedModel->boundingCenter, animatedModel->boundingRadius, center, radius);
+    }
+
+    bool isExternallyDriven() const override { return externalPosition != nullptr; }
+
+    /**
+     * @brief Deforma el personaje con transform feedback en lugar de en cada vertex shader
+     * feedbackShader es 10_vertex_skinning-feedback.vs (ya preparado con SetupSkinningFeedbackShader)
+     * y el shader del objeto pasa a ser 10_vertex_preskinned-physics.vs. As la mezcla de huesos se
+     * hace una vez por pose y las dems pasadas (drawSkinned) dibujan los mismos vrtices. nullptr
+     * regresa al skinning en el vertex shader.
+     */
+    void setSkinningShader(Shader* feedbackShader) {
+        skinningShader = feedbackShader;
+        if (!skinningShader) skinnedVertices.release();
+    }
+
+    void skin() override {
+        if (!animatedModel || !skinningShader) return;
+        evaluatePose();
+        bonePalette.upload(getBonePalette(), animatedModel->skeleton.boneCount(), getPoseVersion());
+        skinnedVertices.skin(*animatedModel, *skinningShader, bonePalette, getPoseVersion());
+    }
+
+    /**
+     * @brief Dibuja los vrtices ya deformados con otro shader (profundidad, seleccin, contorno...)
+     * El shader debe estar activo con sus uniforms puestos; slo hay algo que dibujar si se usa setSkinningShader.
+     */
+    void drawSkinned(Shader& passShader, unsigned int lod = 0) {
+        if (animatedModel && skinningShader) skinnedVertices.draw(*animatedModel, passShader, lod);
+    }
+
+    // Slo calcula la paleta (CPU); se sube a la GPU en render, en el hilo de GL
+    void evaluatePose() override {
+        if (useLocomotion) locomotion.evaluatePose();
+        else animation.evaluatePose();
+    }
+
     void render(const glm::mat4& projection, const glm::mat4& view,
         const LightManager& lightManager, const glm::vec3& eyePosition) override {
         if (!animatedModel || !shader) return;
 
+        // Normalmente ya la calcul la fase de poses de SceneManager; si no, aqu
+        evaluatePose();
+        // Igual con la fase de skinning: si la pose no cambi, no hace nada
+        skin();
+
         shader->use();
         shader->setMat4("projection", projection);
         shader->setMat4("view", view);
         shader->setMat4("model", getModelMatrix());
 
-        // Enviar datos de los huesos (skinning)
-        shader->setMat4("gBones", MAX_RIGGING_BONES, animatedModel->gBones);
+        // Enviar datos de los huesos (skinning): slo los del esqueleto y slo si la pose cambi;
+        // con skinningShader ya los us skin() y este shader no los necesita
+        if (!skinningShader) {
+            bonePalette.upload(getBonePalette(), animatedModel->skeleton.boneCount(), getPoseVersion());
+            bonePalette.bind(*shader);
+        }
 
         // Enviar datos de fsicas
         if (physicsSystem) {
@@ -100,11 +194,64 @@ public:
         shader->setVec4("MaterialSpecularColor", material.specular);
         shader->setFloat("transparency", material.transparency);
 
-        animatedModel->Draw(*shader);
+        // Sin esfera envolvente: los personajes piden sus texturas completas
+        TextureResidency::instance().require(animatedModel->textures_loaded, FLT_MAX);
+
+        if (skinningShader) skinnedVertices.draw(*animatedModel, *shader);
+        else animatedModel->Draw(*shader);
         glUseProgram(0);
     }
 
+    /**
+     * @brief Anima al personaje con un grafo de locomocin en lugar de un solo clip
+     * Cada parmetro es el ndice de un clip del modelo (AnimatedModel::findAnimation); -1 si no lo
+     * tiene. Sin idle el personaje camina en su lugar; sin run camina siempre; sin jump sigue el estado de suelo.
+     */
+    bool setLocomotionClips(int idleClip, int walkClip, int runClip = -1, int jumpClip = -1,
+        float runSpeedThreshold = 3.0f, float transitionSeconds = 0.2f) {
+        if (!animatedModel) return false;
+        locomotion = animatedModel->createGraph();
+        const char* names[LOCOMOTION_STATE_COUNT] = { "idle", "walk", "run", "jump" };
+        int clipsForState[LOCOMOTION_STATE_COUNT] = { idleClip, walkClip, runClip, jumpClip };
+        for (int i = 0; i < LOCOMOTION_STATE_COUNT; i++)
+            locomotionStates[i] = clipsForState[i] >= 0
+                ? locomotion.addState(names[i], (unsigned int)clipsForState[i], 1.0f, i != LOCOMOTION_JUMP) : -1;
+        runSpeed = runSpeedThreshold;
+        fadeSeconds = transitionSeconds;
+        useLocomotion = locomotionStates[LOCOMOTION_IDLE] >= 0 || locomotionStates[LOCOMOTION_WALK] >= 0;
+        if (useLocomotion) locomotion.play(chooseLocomotionState());
+        // la versin del grafo no tiene relacin con la de la instancia
+        bonePalette.invalidate();
+        return useLocomotion;
+    }
+
+    const glm::mat4* getBonePalette() const {
+        return useLocomotion ? locomotion.getBonePalette() : animation.getBonePalette();
+    }
+
+    unsigned int getPoseVersion() const {
+        return useLocomotion ? locomotion.getPoseVersion() : animation.getPoseVersion();
+    }
+
     bool getIsMoving() const { return isMoving; }
+
+    AnimationInstance& getAnimation() { return animation; }
+
+    AnimationGraph& getLocomotion() { return locomotion; }
+
+private:
+    // estado del grafo segn el movimiento y el salto, con los que falten sustituidos
+    int chooseLocomotionState() const {
+        int wanted = LOCOMOTION_IDLE;
+        if (physicsSystem && physicsSystem->getIsJumping()) wanted = LOCOMOTION_JUMP;
+        else if (isMoving) wanted = speed > runSpeed ? LOCOMOTION_RUN : LOCOMOTION_WALK;
+
+        if (locomotionStates[wanted] < 0 && wanted == LOCOMOTION_JUMP)
+            wanted = isMoving ? LOCOMOTION_WALK : LOCOMOTION_IDLE;
+        if (locomotionStates[wanted] < 0 && wanted == LOCOMOTION_RUN) wanted = LOCOMOTION_WALK;
+        if (locomotionStates[wanted] < 0) wanted = wanted == LOCOMOTION_IDLE ? LOCOMOTION_WALK : LOCOMOTION_IDLE;
+        return locomotionStates[wanted];
+    }
 };
 
 #endif // ANIMATED_RENDERABLE_OBJECT_H
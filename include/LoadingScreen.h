@@ -7,33 +7,65 @@
 
 /**
  * @brief Pantalla de carga con barra de progreso
+ * La barra se dibuja con glScissor + glClear, as que no necesita shaders ni geometra y puede
+ * mostrarse antes de que se compile cualquier programa. El mensaje va en el ttulo de la ventana.
  */
 class LoadingScreen {
 private:
     GLFWwindow* window;
     int totalSteps;
     int currentStep;
+    float progress; // 0..1
     std::string currentMessage;
 
+    // rectngulo de color slido en pxeles del framebuffer (origen abajo a la izquierda)
+    static void fillRect(int x, int y, int width, int height, float r, float g, float b) {
+        if (width <= 0 || height <= 0) return;
+        glScissor(x, y, width, height);
+        glClearColor(r, g, b, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
 public:
     LoadingScreen(GLFWwindow* win, int steps) 
-        : window(win), totalSteps(steps), currentStep(0), currentMessage("Inicializando...") {}
+        : window(win), totalSteps(steps), currentStep(0), progress(0.0f), currentMessage("Inicializando...") {}
 
+    // avanza un paso de los totalSteps del constructor
     void updateProgress(const std::string& message) {
         currentStep++;
         currentMessage = message;
+        progress = totalSteps > 0 ? (float)currentStep / (float)totalSteps : 1.0f;
+        render();
+    }
+
+    // progreso explcito (p. ej. TaskGraph::progress()); se llama una vez por frame mientras se carga
+    void updateProgress(float fraction, const std::string& message) {
+        progress = fraction < 0.0f ? 0.0f : (fraction > 1.0f ? 1.0f : fraction);
+        if (!message.empty()) currentMessage = message;
         render();
     }
 
     void render() {
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+        glViewport(0, 0, width, height);
+
+        glDisable(GL_SCISSOR_TEST);
         glClearColor(0.1f, 0.1f, 0.15f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Aqu podras dibujar una barra de progreso simple
-        // Por ahora solo actualizamos la ventana
-        float progress = (float)currentStep / (float)totalSteps * 100.0f;
-        
-        std::string title = "Cargando... " + std::to_string((int)progress) + "% - " + currentMessage;
+        // Barra centrada: marco, fondo y relleno
+        int barWidth = width * 3 / 5;
+        int barHeight = height / 24 > 8 ? height / 24 : 8;
+        int x = (width - barWidth) / 2;
+        int y = height / 3;
+        glEnable(GL_SCISSOR_TEST);
+        fillRect(x - 2, y - 2, barWidth + 4, barHeight + 4, 0.6f, 0.6f, 0.65f);
+        fillRect(x, y, barWidth, barHeight, 0.05f, 0.05f, 0.08f);
+        fillRect(x, y, (int)(barWidth * progress), barHeight, 0.85f, 0.55f, 0.15f);
+        glDisable(GL_SCISSOR_TEST);
+
+        std::string title = "Cargando... " + std::to_string((int)(progress * 100.0f)) + "% - " + currentMessage;
         glfwSetWindowTitle(window, title.c_str());
 
         glfwSwapBuffers(window);
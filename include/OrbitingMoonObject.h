@@ -74,6 +74,15 @@ public:
         return glm::vec3(rotatedPos) + orbitCenter + position;
     }
 
+    // la rbita se calcula en el shader: se usa la posicin que tiene el satlite en este instante
+    bool getBoundingSphere(glm::vec3& center, float& radius) const override {
+        if (!model || model->boundingRadius <= 0.0f) return false;
+        float maxScale = glm::max(scale.x, glm::max(scale.y, scale.z));
+        center = getCurrentOrbitPosition();
+        radius = (glm::length(model->boundingCenter) + model->boundingRadius) * maxScale;
+        return true;
+    }
+
     /**
      * @brief Calcula una posicin adelantada en la rbita (para la luz).
      */
@@ -146,6 +155,9 @@ public:
         shader->setVec4("MaterialSpecularColor", material.specular);
         shader->setFloat("transparency", material.transparency);
 
+        // La rbita se calcula en el shader: no hay posicin confiable para estimar el tamao en pantalla
+        TextureResidency::instance().require(model->textures_loaded, FLT_MAX);
+
         model->Draw(*shader);
         glUseProgram(0);
     }
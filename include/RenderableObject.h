@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <cfloat>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <model.h>
@@ -12,6 +13,22 @@
 
 // Forward declaration
 class LightManager;
+extern const unsigned int SCR_HEIGHT;
+
+/**
+ * @brief Parmetros de seleccin de nivel de detalle
+ * Se usa el nivel ms burdo cuyo error proyectado no supera pixelError * bias pxeles.
+ * La histresis evita el parpadeo: para bajar de detalle el error debe caber con margen y
+ * para volver a subir debe pasarse del lmite con margen.
+ */
+struct LodSettings {
+    float pixelError;   // error mximo tolerado en pxeles
+    float bias;         // > 1 favorece niveles ms burdos, < 1 ms detallados
+    float hysteresis;   // fraccin de margen (0.15 = 15%)
+    bool  enabled;
+
+    LodSettings() : pixelError(1.0f), bias(1.0f), hysteresis(0.15f), enabled(true) {}
+};
 
 /**
  * @brief Objeto base renderizable
@@ -35,6 +52,9 @@ protected:
     bool useHierarchicalTransform;
     glm::mat4 hierarchicalTransform;
 
+    // NUEVO: Nivel de detalle actual (con histresis)
+    unsigned int currentLod;
+
 public:
     // Constructor para objetos con seguimiento (ej. jugador)
     RenderableObject(Model* mdl, Shader* shdr, glm::vec3* extPos = nullptr,
@@ -45,7 +65,7 @@ public:
           rotation(extRot ? glm::vec3(0.0f, *extRot, 0.0f) : glm::vec3(0.0f)),
           scale(scl), initialRotation(initRot), initialTranslation(initTrans),
           useBlending(false), externalPosition(extPos), externalRotation(extRot),
-          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)) {
+          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)), currentLod(0) {
         setDefaultMaterial();
     }
 
@@ -55,7 +75,7 @@ public:
         : model(mdl), shader(shdr), position(pos), rotation(rot), scale(scl),
           initialRotation(glm::vec3(0.0f)), initialTranslation(glm::vec3(0.0f)),
           useBlending(false), externalPosition(nullptr), externalRotation(nullptr),
-          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)) {
+          useHierarchicalTransform(false), hierarchicalTransform(glm::mat4(1.0f)), currentLod(0) {
         setDefaultMaterial();
     }
 
@@ -73,6 +93,32 @@ public:
         }
     }
 
+    /**
+     * @brief true si update() dej una pose de animacin por calcular
+     * SceneManager junta estos objetos despus de los update y llama a evaluatePose() de todos en
+     * paralelo, as que evaluatePose() slo puede tocar el estado del propio objeto (nada de OpenGL).
+     */
+    virtual bool hasPendingPose() const { return false; }
+    virtual void evaluatePose() {}
+
+    /**
+     * @brief Fase de skinning: deforma la geometra animada una vez antes de todas las pasadas
+     * SceneManager la llama en el hilo de GL al inicio del render, despus de la fase de poses.
+     */
+    virtual void skin() {}
+
+    /**
+     * @brief Esfera envolvente en espacio del mundo, para el SignificanceManager
+     * Regresa false si el objeto no tiene un volumen conocido.
+     */
+    virtual bool getBoundingSphere(glm::vec3& center, float& radius) const {
+        if (!model || model->boundingRadius <= 0.0f) return false;
+        return worldBoundingSphere(getModelMatrix(), model->boundingCenter, model->boundingRadius, center, radius);
+    }
+
+    // true si su posicin la controla una variable externa (el jugador): se actualiza cada cuadro
+    virtual bool isExternallyDriven() const { return externalPosition != nullptr; }
+
     /**
      * @brief Calcula la matriz de modelo final aplicando todas las transformaciones.
      */
@@ -115,9 +161,10 @@ public:
             glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         }
 
+        glm::mat4 modelMatrix = getModelMatrix();
         shader->setMat4("projection", projection);
         shader->setMat4("view", view);
-        shader->setMat4("model", getModelMatrix());
+        shader->setMat4("model", modelMatrix);
 
         // Aplicar luces globales + locales
         lightManager.applyLights(shader, affectedLights);
@@ -133,10 +180,77 @@ public:
             glBindTexture(GL_TEXTURE_2D, 0);
         }
 
-        model->Draw(*shader);
+        // Mips que necesitan las texturas segn el tamao del objeto en pantalla
+        float pixelsPerUnit = pixelsPerModelUnit(projection, view, modelMatrix);
+        TextureResidency::instance().require(model->textures_loaded,
+            pixelsPerUnit > 0.0f ? pixelsPerUnit * 2.0f * model->boundingRadius : FLT_MAX);
+
+        model->Draw(*shader, selectLod(pixelsPerUnit));
         glUseProgram(0);
     }
 
+    /**
+     * @brief Elige el nivel de detalle segn el tamao proyectado del objeto
+     * @param pixelsPerUnit Resultado de pixelsPerModelUnit (0 si la cmara est dentro de la esfera)
+     */
+    unsigned int selectLod(float pixelsPerUnit) {
+        const LodSettings& settings = lodSettings();
+        if (!settings.enabled || !model || model->getLodCount() < 2) {
+            currentLod = 0;
+            return currentLod;
+        }
+        if (pixelsPerUnit <= 0.0f) {
+            currentLod = 0; // la cmara est dentro o muy cerca de la esfera
+            return currentLod;
+        }
+
+        // el error tolerado pasa de pxeles a unidades del modelo
+        float allowed = settings.pixelError * settings.bias / pixelsPerUnit;
+
+        unsigned int target = 0;
+        while (target + 1 < model->getLodCount() && model->getLodError(target + 1) <= allowed) target++;
+
+        if (target > currentLod) {
+            // bajar de detalle slo si el nivel nuevo cabe con margen
+            while (target > currentLod && model->getLodError(target) > allowed * (1.0f - settings.hysteresis)) target--;
+        }
+        else if (target < currentLod && model->getLodError(currentLod) <= allowed * (1.0f + settings.hysteresis)) {
+            target = currentLod; // todava dentro del margen: no subir de detalle
+        }
+        currentLod = target;
+        return currentLod;
+    }
+
+    /**
+     * @brief Pxeles de pantalla por unidad del modelo en el centro de su esfera envolvente
+     * Regresa 0 si la cmara est dentro o muy cerca de la esfera.
+     */
+    float pixelsPerModelUnit(const glm::mat4& projection, const glm::mat4& view, const glm::mat4& modelMatrix) const {
+        if (!model) return 0.0f;
+        float maxScale = glm::max(glm::length(glm::vec3(modelMatrix[0])),
+            glm::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+        glm::vec4 center = view * modelMatrix * glm::vec4(model->boundingCenter, 1.0f);
+        float distance = -center.z;
+        if (distance <= model->boundingRadius * maxScale) return 0.0f;
+        return projection[1][1] * 0.5f * (float)SCR_HEIGHT * maxScale / distance;
+    }
+
+    // esfera del modelo (localCenter, localRadius) llevada al mundo con modelMatrix
+    static bool worldBoundingSphere(const glm::mat4& modelMatrix, const glm::vec3& localCenter, float localRadius,
+        glm::vec3& center, float& radius) {
+        float maxScale = glm::max(glm::length(glm::vec3(modelMatrix[0])),
+            glm::max(glm::length(glm::vec3(modelMatrix[1])), glm::length(glm::vec3(modelMatrix[2]))));
+        center = glm::vec3(modelMatrix * glm::vec4(localCenter, 1.0f));
+        radius = localRadius * maxScale;
+        return true;
+    }
+
+    // configuracin de LOD compartida por todos los objetos
+    static LodSettings& lodSettings() {
+        static LodSettings settings;
+        return settings;
+    }
+
     // Setters
     void setPosition(const glm::vec3& pos) { position = pos; }
     void setRotation(const glm::vec3& rot) { rotation = rot; }
@@ -202,6 +316,7 @@ public:
     const std::vector<size_t>& getAffectedLights() const { return affectedLights; }
     glm::vec3 getPosition() const { return position; }
     bool isUsingHierarchicalTransform() const { return useHierarchicalTransform; }
+    unsigned int getCurrentLod() const { return currentLod; }
 
 private:
     void setDefaultMaterial() {
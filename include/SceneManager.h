@@ -9,6 +9,7 @@
 #include <camera.h>
 #include <cubemap.h>
 #include <shader_m.h>
+#include <jobsystem.h>
 #include "RenderableObject.h"
 #include "OrbitingMoonObject.h"
 #include "LightManager.h"
@@ -16,6 +17,7 @@
 #include "LightIndicator.h"
 #include "HierarchicalObject.h"
 #include "OrbitVisualizer.h"
+#include "SignificanceManager.h"
 #include <unordered_set>
 #include <functional>
 
@@ -30,6 +32,7 @@ extern const unsigned int SCR_HEIGHT;
 class SceneManager {
 private:
     std::vector<std::unique_ptr<RenderableObject>> objects;
+    std::vector<RenderableObject*> pendingPoses; // memoria de trabajo de evaluatePoses
     LightManager lightManager;
     Material defaultMaterial;
     CubeMap* cubemap;
@@ -55,11 +58,15 @@ private:
     std::vector<std::unique_ptr<HierarchicalObject>> hierarchicalObjects;
     HierarchicalObject* worldRoot;
 
+    // Frecuencia de actualización de cada objeto según su importancia en pantalla
+    SignificanceManager significance;
+    const glm::vec3* playerPosition; // si es nulo se usa la posición de la cámara activa
+
 public:
     SceneManager(Camera& cam1st, Camera& cam3rd, bool& activeCam)
         : cubemap(nullptr), cubemapShader(nullptr), axisGizmo(nullptr), 
           lightIndicator(nullptr), orbitVisualizer(nullptr), worldRoot(nullptr),
-          camera(cam1st), camera3rd(cam3rd), activeCamera(activeCam) {
+          camera(cam1st), camera3rd(cam3rd), activeCamera(activeCam), playerPosition(nullptr) {
     }
 
     ~SceneManager() {
@@ -73,6 +80,19 @@ public:
         objects.push_back(std::move(obj));
     }
 
+    /**
+     * @brief Quita un objeto de la escena y lo destruye
+     */
+    void removeObject(RenderableObject* obj) {
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (objects[i].get() == obj) {
+                significance.forget(obj);
+                objects.erase(objects.begin() + i);
+                return;
+            }
+        }
+    }
+
     LightManager& getLightManager() { return lightManager; }
     Material& getMaterial() { return defaultMaterial; }
 
@@ -103,11 +123,18 @@ public:
 
     HierarchicalObject* getWorldRoot() { return worldRoot; }
 
+    SignificanceManager& getSignificance() { return significance; }
+
+    // posición desde la que se mide la cercanía de los objetos (normalmente la del jugador)
+    void setPlayerPosition(const glm::vec3* pos) { playerPosition = pos; }
+
     /**
      * @brief Vincula una luz a un satélite orbital para que lo siga
      */
     void addSatelliteLight(OrbitingMoonObject* satellite, size_t lightManagerIndex, size_t lightIndicatorIndex) {
         satelliteLights.push_back({satellite, lightManagerIndex, lightIndicatorIndex});
+        // la luz sigue su órbita aunque el satélite no se vea
+        significance.setAlwaysUpdate(satellite);
     }
 
     void update(float deltaTime) {
@@ -126,22 +153,44 @@ public:
             }
         }
 
-        // Actualizar todos los objetos de la escena
+        // Actualizar los objetos de la escena; los poco importantes sólo algunos cuadros, con el tiempo acumulado
+        glm::mat4 projection, view;
+        glm::vec3 eyePosition;
+        getCameraMatrices(projection, view, eyePosition);
+        significance.beginFrame(projection, view, playerPosition ? *playerPosition : eyePosition);
         for (auto& obj : objects) {
-            obj->update(deltaTime);
+            float elapsed = significance.schedule(obj.get(), deltaTime);
+            if (elapsed > 0.0f) obj->update(elapsed);
         }
         
         // Actualizar jerarquía si existe
         if (worldRoot) {
             worldRoot->update(deltaTime);
         }
+
+        evaluatePoses();
     }
 
-    void render() {
-        glm::mat4 projection;
-        glm::mat4 view;
-        glm::vec3 eyePosition;
+    /**
+     * @brief Fase de poses: calcula en paralelo las paletas de todos los personajes animados
+     * Los update sólo avanzan el tiempo; aquí se juntan los objetos con una pose pendiente y cada
+     * uno la evalúa en un hilo del JobSystem sobre su propia paleta. El render la sube después en
+     * el hilo de GL.
+     */
+    void evaluatePoses() {
+        pendingPoses.clear();
+        for (auto& obj : objects) {
+            if (obj->hasPendingPose()) pendingPoses.push_back(obj.get());
+        }
+        JobSystem::instance().parallelFor(pendingPoses.size(), [this](size_t i) {
+            pendingPoses[i]->evaluatePose();
+        });
+    }
 
+    /**
+     * @brief Proyección, vista y posición de la cámara activa
+     */
+    void getCameraMatrices(glm::mat4& projection, glm::mat4& view, glm::vec3& eyePosition) const {
         if (activeCamera) {
             projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 10000.0f);
             view = camera.GetViewMatrix();
@@ -152,6 +201,18 @@ public:
             view = camera3rd.GetViewMatrix();
             eyePosition = camera3rd.Position;
         }
+    }
+
+    void render() {
+        glm::mat4 projection;
+        glm::mat4 view;
+        glm::vec3 eyePosition;
+        getCameraMatrices(projection, view, eyePosition);
+
+        // Fase de skinning: los personajes con transform feedback se deforman una vez antes de todas las pasadas
+        for (auto& obj : objects) {
+            obj->skin();
+        }
 
         // Dibujar cubemap si está disponible
         if (cubemap && cubemapShader) {
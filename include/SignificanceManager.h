@@ -0,0 +1,160 @@
+#ifndef SIGNIFICANCE_MANAGER_H
+#define SIGNIFICANCE_MANAGER_H
+
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "RenderableObject.h"
+
+extern const unsigned int SCR_HEIGHT;
+
+/**
+ * @brief Umbrales y frecuencias de actualización según la importancia
+ * La importancia va de 0 a 1: 0 si el objeto no está en pantalla; si lo está, la mayor entre su tamaño
+ * proyectado (fullRatePixels de diámetro = 1) y su cercanía al jugador (1 hasta nearDistance, 0 en farDistance).
+ */
+struct SignificanceSettings {
+    float fullRatePixels;
+    float nearDistance;
+    float farDistance;
+    float highScore;      // desde aquí, cada cuadro
+    float mediumScore;    // desde aquí, mediumRate; por debajo (y en pantalla), lowRate
+    float mediumRate;     // actualizaciones por segundo
+    float lowRate;
+    bool  pauseOffscreen; // fuera de pantalla no se actualiza; el tiempo se acumula y se aplica al volver
+    float offscreenRate;  // si no se pausa, frecuencia fuera de pantalla
+    bool  enabled;
+
+    SignificanceSettings()
+        : fullRatePixels(200.0f), nearDistance(10.0f), farDistance(150.0f),
+          highScore(0.5f), mediumScore(0.15f), mediumRate(15.0f), lowRate(5.0f),
+          pauseOffscreen(true), offscreenRate(1.0f), enabled(true) {}
+};
+
+/**
+ * @brief Decide cada cuadro qué objetos se actualizan
+ * Los objetos importantes (y los que no tienen esfera envolvente) se actualizan cada cuadro; los
+ * pequeños o lejanos, a 15 o 5 Hz, y los que están fuera de pantalla se pausan. Cuando les toca
+ * reciben todo el tiempo acumulado, así que nada se atrasa: la pose salta al instante correcto, pero
+ * entre dos actualizaciones se queda quieta (no se interpola entre paletas), por eso sólo se
+ * reduce la frecuencia de lo que apenas se ve. Los que tocan el mismo periodo se reparten en
+ * cuadros distintos para que el costo por cuadro no tenga picos. Los objetos controlados desde fuera
+ * (el jugador) y los marcados con setAlwaysUpdate (p. ej. satélites que mueven luces) siempre se actualizan.
+ */
+class SignificanceManager {
+public:
+    struct FrameStats {
+        size_t updated;
+        size_t skipped;
+        size_t offscreen;
+    };
+
+    SignificanceManager() : recordsCreated(0), playerPosition(0.0f), stats{ 0, 0, 0 } {}
+
+    SignificanceSettings& getSettings() { return settings; }
+    const FrameStats& getStats() const { return stats; }
+
+    // cámara y jugador de este cuadro
+    void beginFrame(const glm::mat4& projection, const glm::mat4& viewMatrix, const glm::vec3& player) {
+        view = viewMatrix;
+        projectionScale = projection[1][1] * 0.5f * (float)SCR_HEIGHT;
+        playerPosition = player;
+        glm::mat4 m = projection * viewMatrix;
+        // planos del frustum a partir de las filas de la matriz de vista-proyección
+        for (int i = 0; i < 3; i++) {
+            glm::vec4 row(m[0][i], m[1][i], m[2][i], m[3][i]);
+            glm::vec4 w(m[0][3], m[1][3], m[2][3], m[3][3]);
+            planes[i * 2] = w + row;
+            planes[i * 2 + 1] = w - row;
+        }
+        for (glm::vec4& plane : planes)
+            plane /= glm::length(glm::vec3(plane));
+        stats = FrameStats{ 0, 0, 0 };
+    }
+
+    void setAlwaysUpdate(const RenderableObject* object, bool always = true) {
+        record(object).alwaysUpdate = always;
+    }
+
+    float getScore(const RenderableObject* object) { return record(object).score; }
+
+    /**
+     * @brief Tiempo que hay que pasarle a update() este cuadro, o 0 si el objeto se salta
+     */
+    float schedule(const RenderableObject* object, float deltaTime) {
+        Record& r = record(object);
+        r.accumulated += deltaTime;
+        r.score = score(*object);
+
+        if (r.score <= 0.0f) stats.offscreen++;
+
+        bool update = true;
+        if (settings.enabled && !r.alwaysUpdate && !object->isExternallyDriven() && r.score < settings.highScore) {
+            float rate = settings.mediumRate;
+            if (r.score <= 0.0f) rate = settings.pauseOffscreen ? 0.0f : settings.offscreenRate;
+            else if (r.score < settings.mediumScore) rate = settings.lowRate;
+
+            // con cuadros más largos que el periodo, la fase pasa de 1 cada cuadro y se actualiza siempre
+            r.phase += deltaTime * rate;
+            update = r.phase >= 1.0f;
+            if (update) r.phase -= std::floor(r.phase);
+        }
+        if (!update) {
+            stats.skipped++;
+            return 0.0f;
+        }
+        stats.updated++;
+        float elapsed = r.accumulated;
+        r.accumulated = 0.0f;
+        return elapsed;
+    }
+
+    // el objeto dejó la escena (SceneManager::removeObject)
+    void forget(const RenderableObject* object) {
+        records.erase(object);
+    }
+
+private:
+    struct Record {
+        float accumulated; // tiempo desde su último update
+        float phase;       // fracción del periodo de su frecuencia actual
+        float score;
+        bool  alwaysUpdate;
+    };
+
+    SignificanceSettings settings;
+    std::unordered_map<const RenderableObject*, Record> records; // O(1) por objeto y por cuadro
+    unsigned int         recordsCreated;
+    glm::mat4            view;
+    glm::vec4            planes[6];
+    float                projectionScale;
+    glm::vec3            playerPosition;
+    FrameStats           stats;
+
+    Record& record(const RenderableObject* object) {
+        auto found = records.find(object);
+        if (found != records.end()) return found->second;
+        // fase inicial repartida (razón áurea) para que los objetos nuevos no se actualicen todos juntos
+        float phase = std::fmod((float)(recordsCreated++) * 0.618034f, 1.0f);
+        return records.emplace(object, Record{ 0.0f, phase, 1.0f, false }).first->second;
+    }
+
+    float score(const RenderableObject& object) const {
+        glm::vec3 center;
+        float radius;
+        if (!object.getBoundingSphere(center, radius)) return 1.0f; // sin volumen conocido: siempre importa
+
+        for (const glm::vec4& plane : planes)
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) return 0.0f;
+
+        float depth = -(view * glm::vec4(center, 1.0f)).z;
+        float size = depth > radius ? radius * 2.0f * projectionScale / depth / settings.fullRatePixels : 1.0f;
+        float distance = glm::length(center - playerPosition);
+        float span = std::max(settings.farDistance - settings.nearDistance, 1e-3f);
+        float proximity = 1.0f - glm::clamp((distance - settings.nearDistance) / span, 0.0f, 1.0f);
+        return std::max(std::min(size, 1.0f), std::max(proximity, 1e-3f));
+    }
+};
+
+#endif // SIGNIFICANCE_MANAGER_H
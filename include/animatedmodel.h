@@ -2,46 +2,44 @@
 #define ANIMATEDMODEL_H
 
 #include <modelstructs.h>
-
-// Max number of bones
-#define MAX_RIGGING_BONES 100
+#include <meshimport.h>
+#include <modelbake.h>
+#include <texturecache.h>
+#include <loadprofiler.h>
+#include <skeleton.h>
+#include <animationinstance.h>
+#include <animationcompress.h>
+#include <animationgraph.h>
 
 class AnimatedModel 
 {
 public:
     /*  Model Data */
-    vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
-    vector<Mesh>    meshes;
+    vector<Texture> textures_loaded;	// one entry per reference taken from TextureCache; released in the destructor
+    vector<SkinnedMesh> meshes;
     string          directory;
     bool            gammaCorrection;
 
 	string          filename;
 
-	/* Bones data */
-	vector<Bone>    bones;
-
-	/* Scene data */
-	Assimp::Importer importer;
-	const aiScene*   scene;
+	/* Shared animation data: node tree, bones and clips. The Assimp scene is freed right after import;
+	   the pose (time and bone palette) lives in each AnimationInstance */
+	Skeleton              skeleton;
+	vector<AnimationClip> animations;           // after compressAnimations() only name, duration and ticks per second are kept
+	vector<CompressedClip> compressedAnimations; // keys actually sampled by the instances, one per entry of animations
 	
 	map<string, unsigned int> m_BoneMapping; // maps a bone name to its index
 	unsigned int              m_NumBones;
 	vector<BoneInfo>          m_BoneInfo;
-	glm::mat4                 m_GlobalInverseTransform;
 
-	float	       fps;   // framerate (frames per second)
-	int		       keys;     // number of keyframes
-	int		       animationCount; // key counter
-	float          elapsedTime; // time elapsed
+	unsigned int   currentAnimation = 0; // clip that new instances start with
 
-	unsigned int   currentAnimation = 0; // first animation
-
-	// Pose inicial del modelo
-	glm::mat4 gBones[MAX_RIGGING_BONES];
+	glm::vec3 boundingCenter = glm::vec3(0.0f); // bind-pose bounding sphere in model space
+	float     boundingRadius = 0.0f;
 
     /*  Functions   */
     // constructor, expects a filepath to a 3D model.
-    AnimatedModel(string const &path, unsigned int cAnimation = 0, bool gamma = false) : gammaCorrection(gamma)
+    AnimatedModel(string const &path, unsigned int cAnimation = 0, bool gamma = false) : gammaCorrection(gamma), m_NumBones(0)
     {
 		this->currentAnimation = cAnimation;
         loadModel(path);
@@ -52,62 +50,44 @@ public:
     {
         for(unsigned int i = 0; i < meshes.size(); i++)
             meshes[i].Draw(shader);
+        GeometryPool::instance().unbind();
     }
 
-	// update transformations in time 
-	void SetPose(float time, glm::mat4 *gBones) {
-		
-		// processNode(scene->mRootNode, time);
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, scene->mRootNode, n_matrix);
-
-		for (unsigned int i = 0; i < bones.size(); i++) {
-			if (i < 100) {
-				
-				gBones[i] = bones[i].transformation;
-				// cout << "bone: " << i << " : " << bones[i].name.data << " T= " << glm::to_string(gBones[i]) << endl;
-			}
-		}
-	}
-
-	// update animation
-	void UpdateAnimation(float deltaTime) {
-		elapsedTime += deltaTime;
-		if (elapsedTime > 1.0f / fps) {
-			animationCount++;
-			if (animationCount > keys - 1) {
-				animationCount = 0;
-			}
-			// Configuracin de la pose en el instante t
-			SetPose((float)animationCount, gBones);
-			elapsedTime = 0.0f;
-		}
-	}
-
-private:
-
-	// Return the duration of the animation in ticks (frames)
-	double getNumFrames() {
-
-		const aiAnimation* pAnimation = scene->mAnimations[currentAnimation];
-		if (pAnimation == nullptr) return -1.0;
-
-		cout << "Animation total frames:" << pAnimation->mDuration << endl;
+    // draws every mesh once for instanceCount instances; the shader places and poses each one from gl_InstanceID
+    void DrawInstanced(Shader shader, GLsizei instanceCount)
+    {
+        for(unsigned int i = 0; i < meshes.size(); i++)
+            meshes[i].Draw(shader, 0, instanceCount);
+        GeometryPool::instance().unbind();
+    }
 
-		return pAnimation->mDuration;
+    // returns the geometry of every mesh to the pool
+    ~AnimatedModel()
+    {
+        for (SkinnedMesh& mesh : meshes) mesh.release();
+        for (const Texture& texture : textures_loaded) TextureCache::instance().release(texture.id);
+    }
 
+	// independent playback state over this model's skeleton; the model must outlive it
+	AnimationInstance createInstance() const {
+		return AnimationInstance(&skeleton, &animations, currentAnimation,
+			compressedAnimations.empty() ? nullptr : &compressedAnimations);
 	}
 
-	// return the number of ticks per second
-	double getFramerate() {
-		const aiAnimation* pAnimation = scene->mAnimations[currentAnimation];
-		if (pAnimation == nullptr) return -1.0;
-
-		cout << "Animation framerate:" << pAnimation->mTicksPerSecond << " fps" << endl;
+	// empty state machine over this model's clips (see AnimationGraph); the model must outlive it
+	AnimationGraph createGraph() const {
+		return AnimationGraph(&skeleton, &animations, compressedAnimations.empty() ? nullptr : &compressedAnimations);
+	}
 
-		return  pAnimation->mTicksPerSecond;
+	// index of the clip with that name, -1 if there is none
+	int findAnimation(const string& name) const {
+		for (size_t i = 0; i < animations.size(); i++)
+			if (animations[i].name == name) return (int)i;
+		return -1;
 	}
 
+private:
+
     /*  Functions   */
 
 	inline glm::mat4 aiMatrix4x4ToGlm(aiMatrix4x4 from)
@@ -125,186 +105,156 @@ private:
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path)
     {
-        // read file via ASSIMP
-		cout << "Loading model: " << path << endl;
-		scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-		cout << "Model loaded." << endl;
-        // check for errors
-        if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
-        {
-            cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-            return;
-        }
 		filename = path;
         // retrieve the directory path of the filepath
         directory = path.substr(0, path.find_last_of('/'));
 
-		aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
-		inverseTransform.Inverse();
-		m_GlobalInverseTransform = aiMatrix4x4ToGlm(inverseTransform);
+		// skip Assimp entirely when an up-to-date bake exists
+		if (!loadBakedModel(path))
+		{
+			// read file via ASSIMP; the importer (and the whole aiScene) is freed at the end of this block
+			cout << "Loading model: " << path << endl;
+			Assimp::Importer importer;
+			const aiScene* scene;
+			{
+				ScopedLoadTimer timer(path, "assimp parse");
+				scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+			}
+			cout << "Model loaded." << endl;
+			// check for errors
+			if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+			{
+				cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
+				return;
+			}
+
+			aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
+			inverseTransform.Inverse();
+			skeleton.globalInverseTransform = aiMatrix4x4ToGlm(inverseTransform);
+
+			// process ASSIMP's root node recursively
+			processNode(scene->mRootNode, scene);
+
+			// keep only the node tree and the animation keys
+			BuildNodeHierarchy(scene->mRootNode, -1, skeleton.nodes);
+			animations = BuildAnimationClips(scene, skeleton.nodes);
+			skeleton.linkBones();
+
+			// bake it for the next start-up
+			ScopedLoadTimer timer(path, "bake write");
+			vector<BakeMeshSource> bakeMeshes;
+			AddBakeMeshes(bakeMeshes, meshes);
+			WriteModelBake(path, skeleton.nodes, animations, bakeMeshes, vector<BakedMaterial>(), skeleton.bones, skeleton.globalInverseTransform);
+		}
 
-        // process ASSIMP's root node recursively
-        processNode(scene->mRootNode, scene);
+		compressAnimations(AnimationCompressionSettings());
+		computeBounds();
 
-		fps = (float)getFramerate();
-		keys = (int)getNumFrames();
-		animationCount = 0;
-		elapsedTime = 0.0f;
 		std::cout << "Model loaded: " << path << " with " << meshes.size() << " meshes." << std::endl;
-		SetPose(0.0f, gBones);
+		if (currentAnimation < animations.size())
+			cout << "Animation total frames:" << animations[currentAnimation].duration << ", framerate:"
+				<< animations[currentAnimation].ticksPerSecond << " fps" << endl;
     }
 
-	void processNode(aiNode *node, float time){
-		
-		if (node == nullptr) return;
+	// loads meshes, bones and animation data from a binary bake (.mhbake); vertex data is uploaded straight from the mapping
+	bool loadBakedModel(string const &path)
+	{
+		BakedModel baked;
+		{
+			ScopedLoadTimer timer(path, "bake read");
+			if (!LoadModelBake(path, baked))
+				return false;
+			timer.addBytes(LOAD_BYTES_FILE, baked.file.size());
+		}
+		if (!BakeHasMeshesFor(baked, true)) {
+			cout << "BAKE:: " << GetBakePath(path) << " has no skinned meshes, reimporting" << endl;
+			return false;
+		}
+		ScopedLoadTimer timer(path, "mesh upload");
+
+		for (const BakedMesh& bm : baked.meshes) {
+			if (bm.vertexFormat != VERTEX_FORMAT_SKINNED) continue;
+			vector<Texture> textures;
+			for (const BakedTextureRef& ref : bm.textures)
+				textures.push_back(loadTexture(ref.path.c_str(), ref.type));
+			meshes.push_back(SkinnedMesh((const SkinnedVertex*)bm.vertices, bm.vertexCount, bm.indices, bm.indexCount, bm.indexType, textures, bm.materialIndex));
+			timer.addBytes(LOAD_BYTES_VERTEX, meshes.back().gpuVertexBytes());
+			timer.addBytes(LOAD_BYTES_INDEX, meshes.back().gpuIndexBytes());
+		}
+
+		skeleton.bones.clear();
+		for (const BakedBone& bb : baked.bones)
+			skeleton.bones.push_back(SkeletonBone{ bb.name, bb.offsetMatrix });
+		m_NumBones = (unsigned int)baked.bones.size();
+		skeleton.globalInverseTransform = baked.globalInverseTransform;
+
+		skeleton.nodes = std::move(baked.nodes);
+		animations = std::move(baked.animations);
+		skeleton.linkBones();
+		cout << "Model loaded from bake: " << GetBakePath(path) << endl;
+		return true;
+	}
 
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, node, n_matrix);
+	// replaces every clip's keys with the compressed version and prints its ratio and worst error;
+	// the raw channels are freed, a library of clips only keeps the packed keys in memory
+	void compressAnimations(const AnimationCompressionSettings& settings)
+	{
+		ScopedLoadTimer timer(filename, "clip compress");
+		compressedAnimations.clear();
+		for (AnimationClip& clip : animations) {
+			AnimationCompressionReport report;
+			compressedAnimations.push_back(CompressAnimationClip(clip, settings, &report));
+			cout << "Animation " << report.summary(clip.name) << endl;
+			vector<AnimationChannel>().swap(clip.channels);
+			vector<int32_t>().swap(clip.channelForNode);
+		}
+	}
 
+	// bounding sphere of every mesh's bind-pose box; enough to cull and rank a character, limbs may reach a little past it
+	void computeBounds()
+	{
+		glm::vec3 minP(1e30f), maxP(-1e30f);
+		for (const SkinnedMesh& mesh : meshes) {
+			minP = glm::min(minP, mesh.boundsMin);
+			maxP = glm::max(maxP, mesh.boundsMax);
+		}
+		if (minP.x > maxP.x) return;
+		boundingCenter = 0.5f * (minP + maxP);
+		boundingRadius = 0.5f * glm::length(maxP - minP);
 	}
 
-    // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
+    // processes the node tree in two stages: the CPU stage converts every aiMesh concurrently on the job system,
+    // then the GL stage below loads the textures and uploads the finished buffers in one pass on the context thread.
     void processNode(aiNode *node, const aiScene *scene)
     {
-		// cout << node->mName.data << endl;
-		// cout << "Meshes: " << node->mNumMeshes << endl;
-        // process each mesh located at the current node
-        for(unsigned int i = 0; i < node->mNumMeshes; i++)
+        vector<MeshData> meshData;
         {
-            // the node object only contains indices to index the actual objects in the scene. 
-            // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-            aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			// cout << "Mesh: " << mesh->mName.data << endl;
-            meshes.push_back(processMesh(mesh, scene));
+            ScopedLoadTimer timer(filename, "mesh convert");
+            meshData = ConvertSceneMeshes(node, scene);
         }
-        // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-        for(unsigned int i = 0; i < node->mNumChildren; i++)
-        {
-            processNode(node->mChildren[i], scene);
+        ScopedLoadTimer timer(filename, "mesh upload");
+        for(MeshData& data : meshData) {
+            meshes.push_back(processMesh(data, scene));
+            timer.addBytes(LOAD_BYTES_VERTEX, meshes.back().gpuVertexBytes());
+            timer.addBytes(LOAD_BYTES_INDEX, meshes.back().gpuIndexBytes());
         }
-
     }
 
-    Mesh processMesh(aiMesh *mesh, const aiScene *scene)
+    // GL stage for one converted mesh (must run on the thread that owns the context)
+    SkinnedMesh processMesh(MeshData& data, const aiScene *scene)
     {
-        // data to fill
-        vector<Vertex> vertices;
-        vector<unsigned int> indices;
         vector<Texture> textures;
 
-		// cout << "NumVertices: " << mesh->mNumVertices << endl;
-
-        // Walk through each of the mesh's vertices
-        for(unsigned int i = 0; i < mesh->mNumVertices; i++)
-        {
-            Vertex vertex;
-            glm::vec3 vector; // we declare a placeholder vector since assimp uses its own vector class that doesn't directly convert to glm's vec3 class so we transfer the data to this placeholder glm::vec3 first.
-            // positions
-            vector.x = mesh->mVertices[i].x;
-            vector.y = mesh->mVertices[i].y;
-            vector.z = mesh->mVertices[i].z;
-            vertex.Position = vector;
-            // normals
-            vector.x = mesh->mNormals[i].x;
-            vector.y = mesh->mNormals[i].y;
-            vector.z = mesh->mNormals[i].z;
-            vertex.Normal = vector;
-            // texture coordinates
-            if(mesh->mTextureCoords[0]) // does the mesh contain texture coordinates?
-            {
-                glm::vec2 vec;
-                // a vertex can contain up to 8 different texture coordinates. We thus make the assumption that we won't 
-                // use models where a vertex can have multiple texture coordinates so we always take the first set (0).
-                vec.x = mesh->mTextureCoords[0][i].x; 
-                vec.y = mesh->mTextureCoords[0][i].y;
-                vertex.TexCoords = vec;
-            }
-            else
-                vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-            // tangent
-            vector.x = mesh->mTangents[i].x;
-            vector.y = mesh->mTangents[i].y;
-            vector.z = mesh->mTangents[i].z;
-            vertex.Tangent = vector;
-            // bitangent
-            vector.x = mesh->mBitangents[i].x;
-            vector.y = mesh->mBitangents[i].y;
-            vector.z = mesh->mBitangents[i].z;
-            vertex.Bitangent = vector;
-            
-			// Bones
-			int bcount = 0;
-			for (unsigned int pb = 0; pb < MAX_NUM_BONES; pb++) {
-				vertex.IDs1[pb] = 0.0f;
-				vertex.IDs2[pb] = 0.0f;
-				vertex.IDs3[pb] = 0.0f;
-				vertex.Weights1[pb] = 0.0f;
-				vertex.Weights2[pb] = 0.0f;
-				vertex.Weights3[pb] = 0.0f;
-			}
-			m_NumBones = mesh->mNumBones;
-			for (unsigned int j = 0; j < mesh->mNumBones; j++) {
-
-				for (unsigned int k = 0; k < mesh->mBones[j]->mNumWeights; k++) {
-					unsigned int VertexID = mesh->mBones[j]->mWeights[k].mVertexId;
-					float Weight = (float)(mesh->mBones[j]->mWeights[k].mWeight);
-					if ( VertexID == i && bcount < MAX_NUM_BONES ) {
-						vertex.IDs1[bcount] = (float)j;
-						vertex.Weights1[bcount] = Weight;
-						bcount++;
-						/*cout << "Vertex " << VertexID << ": Bone: " << j
-						<< ": W = " << Weight << endl;*/
-					}
-					if (VertexID == i && bcount >= MAX_NUM_BONES && bcount < 2*MAX_NUM_BONES) {
-						vertex.IDs2[bcount - MAX_NUM_BONES] = (float)j;
-						vertex.Weights2[bcount - MAX_NUM_BONES] = Weight;
-						bcount++;
-						/*cout << "Vertex " << VertexID << ": Bone: " << j
-							<< ": W = " << Weight << endl;*/
-					}
-					if (VertexID == i && bcount >= 2 * MAX_NUM_BONES && bcount < 3 * MAX_NUM_BONES) {
-						vertex.IDs3[bcount - 2*MAX_NUM_BONES] = (float)j;
-						vertex.Weights3[bcount - 2*MAX_NUM_BONES] = Weight;
-						bcount++;
-						/*cout << "Vertex " << VertexID << ": Bone: " << j
-							<< ": W = " << Weight << endl;*/
-					}
-				}
-			}
-			vertices.push_back(vertex);
-			//cout << "Vertex " << i << ": " << glm::to_string(vertex.IDs1) << glm::to_string(vertex.IDs2) << glm::to_string(vertex.IDs3)  << endl;
-			//cout << "Vertex " << i << ": " << glm::to_string(vertex.Weights1) << glm::to_string(vertex.Weights2) << glm::to_string(vertex.Weights3) << endl;
-        }
-		// cout << "Vertex readed: " << vertices.size() << endl;
-
-		// Process Bones
-		// cout << "Num bones readed: " << mesh->mNumBones << endl;
-		bones.clear();
-		for (unsigned int i = 0; i < mesh->mNumBones; i++) {
-
-			Bone  newBone;
-			newBone.name = mesh->mBones[i]->mName;
-			newBone.offsetMatrix = aiMatrix4x4ToGlm(mesh->mBones[i]->mOffsetMatrix);
-			newBone.transformation = glm::mat4(1.0f);
-
-			for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++) {
-				unsigned int VertexID = mesh->mBones[i]->mWeights[j].mVertexId;
-				float Weight = mesh->mBones[i]->mWeights[j].mWeight;
-				newBone.push( VertexID, Weight );
-			}
-
-			bones.push_back(newBone);
-		}
-		// cout << "NumFaces: " << mesh->mNumFaces << endl;
+		// bones of the last processed mesh are kept, as before (only name and offset; weights are in the vertices)
+		m_NumBones = (unsigned int)data.bones.size();
+		skeleton.bones.clear();
+		for (const Bone& bone : data.bones)
+			skeleton.bones.push_back(SkeletonBone{ bone.name, bone.offsetMatrix });
+		if (m_NumBones > 0)
+			cout << "Mesh " << data.source->mName.C_Str() << ": " << data.boneStats << endl;
+		cout << "Mesh " << data.source->mName.C_Str() << ": " << data.optimizeStats << endl;
 
-        // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
-        for(unsigned int i = 0; i < mesh->mNumFaces; i++)
-        {
-            aiFace face = mesh->mFaces[i];
-            // retrieve all indices of the face and store them in the indices vector
-            for(unsigned int j = 0; j < face.mNumIndices; j++)
-                indices.push_back(face.mIndices[j]);
-        }
+        const aiMesh* mesh = data.source;
         // process materials
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];    
         // we assume a convention for sampler names in the shaders. Each diffuse texture should be named
@@ -314,234 +264,22 @@ private:
         // specular: texture_specularN
         // normal: texture_normalN
 
-        // 1. diffuse maps
-        vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        // 2. specular maps
-        vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-        // 3. normal maps
-        std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-        textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-        // 4. height maps
-        std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-        textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+        for (const BakedTextureRef& ref : CollectMaterialTextureRefs(material, false))
+            textures.push_back(loadTexture(ref.path.c_str(), ref.type));
         
         // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        return SkinnedMesh(ConvertVertices<SkinnedVertex>(data.vertices), std::move(data.indices), textures, data.materialIndex);
     }
 
-	void ReadNodeHierarchy(float AnimationTime, const aiNode* pNode, const glm::mat4& ParentTransform)
-	{
-		if (pNode == nullptr || scene == nullptr) return;
-
-		string NodeName(pNode->mName.data);
-
-		const aiAnimation* pAnimation = scene->mAnimations[currentAnimation];
-
-		//cout << NodeName << endl;
-		
-		if (pAnimation == nullptr) { 
-			cout << "Error: no valid animation index." << endl;
-			return; 
-		}
-
-		//cout << "valid animation" << endl;
-
-		//aiMatrix4x4 NodeTransformation(pNode->mTransformation);
-		aiMatrix4x4 NodeTransformation;
-
-		const aiNodeAnim* pNodeAnim = FindNodeAnim(pAnimation, NodeName);
-		
-		if (pNodeAnim != nullptr) {
-			aiVector3D Scaling;
-			CalcInterpolatedScaling(Scaling, AnimationTime, pNodeAnim);
-			aiMatrix4x4 ScalingM;
-			if (ScalingM.IsIdentity()) 
-				aiMatrix4x4::Scaling(Scaling, ScalingM);
-
-			aiQuaternion RotationQ;
-			CalcInterpolatedRotation(RotationQ, AnimationTime, pNodeAnim);
-			aiMatrix4x4 RotationM(RotationQ.GetMatrix());
-
-			aiVector3D Translation;
-			CalcInterpolatedPosition(Translation, AnimationTime, pNodeAnim);
-			aiMatrix4x4 TranslationM;
-			if (ScalingM.IsIdentity())
-				aiMatrix4x4::Translation(Translation, TranslationM);
-
-			// Combine the above transformations
-			NodeTransformation = TranslationM * RotationM * ScalingM;
-
-			// cout << "Compute Node Transformation: " << pNodeAnim->mNodeName.data << endl;
-		}
-
-		glm::mat4 GlobalTransformation = ParentTransform * aiMatrix4x4ToGlm(NodeTransformation);
-
-		//cout << "GT=" << glm::to_string(GlobalTransformation) << endl;
-
-		// cout << "Parent: " << NodeName << endl;
-
-		// Modify bones transformation
-		for (unsigned int b = 0; b < bones.size(); b++) {
-			if (bones[b].name == pNode->mName) {
-				bones[b].transformation =  m_GlobalInverseTransform * GlobalTransformation*bones[b].offsetMatrix;
-				//cout << "bone: " << b << " : " << bones[b].name.data << " T= " << glm::to_string(bones[b].transformation) << endl;
-			}
-		}
-
-		for (unsigned int i = 0; i < pNode->mNumChildren; i++) {
-			// cout << "Child: " << pNode->mChildren[i]->mName.data << ": " << i << endl;
-			ReadNodeHierarchy(AnimationTime, pNode->mChildren[i], GlobalTransformation);
-		}
-	}
-
-	const aiNodeAnim* FindNodeAnim(const aiAnimation* pAnimation, const string NodeName)
-	{
-		for (unsigned int i = 0; i < pAnimation->mNumChannels; i++) {
-			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
-
-			if (string(pNodeAnim->mNodeName.data) == NodeName) {
-				return pNodeAnim;
-			}
-		}
-
-		return nullptr;
-	}
-
-
-	void CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		if (pNodeAnim->mNumScalingKeys == 1) {
-			Out = pNodeAnim->mScalingKeys[0].mValue;
-			return;
-		}
-
-		unsigned int ScalingIndex = FindScaling(AnimationTime, pNodeAnim);
-		unsigned int NextScalingIndex = (ScalingIndex + 1);
-		assert(NextScalingIndex < pNodeAnim->mNumScalingKeys);
-		float DeltaTime = (float)(pNodeAnim->mScalingKeys[NextScalingIndex].mTime - pNodeAnim->mScalingKeys[ScalingIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mScalingKeys[ScalingIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mScalingKeys[ScalingIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mScalingKeys[NextScalingIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
-	}
-
-	unsigned int FindScaling(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		assert(pNodeAnim->mNumScalingKeys > 0);
-
-		for (unsigned int i = 0; i < pNodeAnim->mNumScalingKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mScalingKeys[i + 1].mTime) {
-				return i;
-			}
-		}
-
-		assert(0);
-
-		return 0;
-	}
-
-	void CalcInterpolatedRotation(aiQuaternion& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		// we need at least two values to interpolate...
-		if (pNodeAnim->mNumRotationKeys == 1) {
-			Out = pNodeAnim->mRotationKeys[0].mValue;
-			return;
-		}
-
-		unsigned int RotationIndex = FindRotation(AnimationTime, pNodeAnim);
-		unsigned int NextRotationIndex = (RotationIndex + 1);
-		assert(NextRotationIndex < pNodeAnim->mNumRotationKeys);
-		float DeltaTime = (float)(pNodeAnim->mRotationKeys[NextRotationIndex].mTime - pNodeAnim->mRotationKeys[RotationIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mRotationKeys[RotationIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiQuaternion& StartRotationQ = pNodeAnim->mRotationKeys[RotationIndex].mValue;
-		const aiQuaternion& EndRotationQ = pNodeAnim->mRotationKeys[NextRotationIndex].mValue;
-		aiQuaternion::Interpolate(Out, StartRotationQ, EndRotationQ, Factor);
-		Out = Out.Normalize();
-	}
-
-	unsigned int FindRotation(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		assert(pNodeAnim->mNumRotationKeys > 0);
-
-		for (unsigned int i = 0; i < pNodeAnim->mNumRotationKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mRotationKeys[i + 1].mTime) {
-				return i;
-			}
-		}
-
-		assert(0);
-
-		return 0;
-	}
-
-	unsigned int FindPosition(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		for (unsigned int i = 0; i < pNodeAnim->mNumPositionKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mPositionKeys[i + 1].mTime) {
-				return i;
-			}
-		}
-
-		assert(0);
-
-		return 0;
-	}
-
-	void CalcInterpolatedPosition(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		if (pNodeAnim->mNumPositionKeys == 1) {
-			Out = pNodeAnim->mPositionKeys[0].mValue;
-			return;
-		}
-
-		unsigned int PositionIndex = FindPosition(AnimationTime, pNodeAnim);
-		unsigned int NextPositionIndex = (PositionIndex + 1);
-		assert(NextPositionIndex < pNodeAnim->mNumPositionKeys);
-		float DeltaTime = (float)(pNodeAnim->mPositionKeys[NextPositionIndex].mTime - pNodeAnim->mPositionKeys[PositionIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mPositionKeys[PositionIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mPositionKeys[PositionIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mPositionKeys[NextPositionIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
-	}
-
-    // checks all material textures of a given type and loads the textures if they're not loaded yet.
-    // the required info is returned as a Texture struct.
-    vector<Texture> loadMaterialTextures(aiMaterial *mat, aiTextureType type, string typeName)
+    // takes a reference to the texture in the process-wide cache; it's only loaded the first time any model asks for it
+    Texture loadTexture(const char* path, const string &typeName)
     {
-        vector<Texture> textures;
-        for(unsigned int i = 0; i < mat->GetTextureCount(type); i++)
-        {
-            aiString str;
-            mat->GetTexture(type, i, &str);
-            // check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
-            bool skip = false;
-            for(unsigned int j = 0; j < textures_loaded.size(); j++)
-            {
-                if(std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-                {
-                    textures.push_back(textures_loaded[j]);
-                    skip = true; // a texture with the same filepath has already been loaded, continue to next one. (optimization)
-                    break;
-                }
-            }
-            if(!skip)
-            {   // if texture hasn't been loaded already, load it
-                Texture texture;
-                texture.id = TextureFromFile(str.C_Str(), this->directory);
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-                textures_loaded.push_back(texture);  // store it as texture loaded for entire model, to ensure we won't unnecesery load duplicate textures.
-            }
-        }
-        return textures;
+        Texture texture;
+        texture.id = TextureCache::instance().acquire(this->directory + '/' + path, false, TextureUsageForType(typeName));
+        texture.type = typeName;
+        texture.path = path;
+        textures_loaded.push_back(texture);  // the reference is released in the destructor
+        return texture;
     }
 };
 
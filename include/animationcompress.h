@@ -0,0 +1,419 @@
+#ifndef ANIMATIONCOMPRESS_H
+#define ANIMATIONCOMPRESS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <animationdata.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+using namespace std;
+
+// Llaves por bloque: 8 llaves de 8 bytes = una línea de caché de 64 bytes
+#define ANIMATION_KEY_BLOCK_SIZE 8
+
+// pasos hacia adelante de un cursor de llaves antes de cambiar a búsqueda binaria (saltos grandes de tiempo)
+#define KEY_CURSOR_MAX_STEPS 4
+
+/**
+ * @brief Llave empaquetada: tiempo y valor en 8 bytes
+ * El tiempo es una fracción de 16 bits de la duración del clip. El valor es un vec3 de 16 bits
+ * por componente relativo al rango de su pista (posición y escala) o un cuaternión "smallest
+ * three" de 48 bits (2 bits del índice de la componente mayor y 15 bits por cada una de las otras tres).
+ */
+struct PackedKey {
+	uint16_t time;
+	uint16_t value[3];
+};
+
+// Una pista (posición, rotación o escala) de un canal: sus llaves seguidas en CompressedClip::keys
+struct CompressedTrack {
+	uint32_t  firstKey;
+	uint32_t  keyCount;
+	uint32_t  firstBlock;  // en CompressedClip::blockTimes
+	glm::vec3 rangeMin;    // sólo posición y escala
+	glm::vec3 rangeExtent;
+};
+
+struct CompressedChannel {
+	int32_t         node;
+	CompressedTrack position;
+	CompressedTrack rotation;
+	CompressedTrack scale;
+};
+
+/**
+ * @brief Clip comprimido: las llaves de todas las pistas en un solo arreglo, por bloques
+ * blockTimes guarda el tiempo de la primera llave de cada bloque de ANIMATION_KEY_BLOCK_SIZE llaves
+ * de una pista: una búsqueda binaria ahí y luego unas cuantas llaves dentro de una línea de caché.
+ */
+struct CompressedClip {
+	string                    name;
+	double                    duration;       // en ticks
+	double                    ticksPerSecond;
+	vector<CompressedChannel> channels;
+	vector<int32_t>           channelForNode;
+	vector<PackedKey>         keys;
+	vector<float>             blockTimes;
+
+	CompressedClip() : duration(0.0), ticksPerSecond(0.0) {}
+
+	size_t byteSize() const {
+		return sizeof(CompressedClip) + channels.size() * sizeof(CompressedChannel) + channelForNode.size() * sizeof(int32_t) +
+			keys.size() * sizeof(PackedKey) + blockTimes.size() * sizeof(float);
+	}
+
+	float keyTime(const CompressedTrack& track, size_t key) const {
+		return (float)(keys[track.firstKey + key].time * (duration / 65535.0));
+	}
+
+	glm::vec3 vectorKey(const CompressedTrack& track, size_t key) const;
+	glm::quat rotationKey(const CompressedTrack& track, size_t key) const;
+};
+
+// Tolerancias de la reducción de llaves, por articulación (cada pista se reduce por separado)
+struct AnimationCompressionSettings {
+	float positionTolerance; // unidades del modelo
+	float rotationTolerance; // radianes
+	float scaleTolerance;
+
+	AnimationCompressionSettings() : positionTolerance(0.001f), rotationTolerance(0.0015f), scaleTolerance(0.001f) {}
+};
+
+// Resultado de comprimir un clip; el error se mide contra las llaves originales ya cuantizado
+struct AnimationCompressionReport {
+	size_t rawBytes;
+	size_t compressedBytes;
+	size_t rawKeys;
+	size_t keptKeys;
+	float  maxPositionError;
+	float  maxRotationError; // radianes
+	float  maxScaleError;
+
+	AnimationCompressionReport() : rawBytes(0), compressedBytes(0), rawKeys(0), keptKeys(0),
+		maxPositionError(0.0f), maxRotationError(0.0f), maxScaleError(0.0f) {}
+
+	float ratio() const { return compressedBytes > 0 ? (float)rawBytes / (float)compressedBytes : 0.0f; }
+
+	// una línea: llaves, tamaño, razón y peor error (rotación en grados)
+	string summary(const string& clipName) const {
+		char line[256];
+		snprintf(line, sizeof(line), "%s: %zu -> %zu keys, %.1f -> %.1f KB (%.1fx), max error pos %.5f rot %.4f deg scale %.5f",
+			clipName.c_str(), rawKeys, keptKeys, rawBytes / 1024.0, compressedBytes / 1024.0, ratio(),
+			maxPositionError, glm::degrees(maxRotationError), maxScaleError);
+		return line;
+	}
+};
+
+inline size_t AnimationClipByteSize(const AnimationClip& clip)
+{
+	size_t bytes = sizeof(AnimationClip) + clip.channelForNode.size() * sizeof(int32_t);
+	for (const AnimationChannel& ch : clip.channels) {
+		bytes += sizeof(AnimationChannel);
+		bytes += ch.positions.size() * (sizeof(float) + sizeof(glm::vec3));
+		bytes += ch.rotations.size() * (sizeof(float) + sizeof(glm::quat));
+		bytes += ch.scales.size() * (sizeof(float) + sizeof(glm::vec3));
+	}
+	return bytes;
+}
+
+/*  ------------------------------------------------------------------
+ *  Cuantización
+ *  ------------------------------------------------------------------ */
+
+inline uint16_t QuantizeUnit16(float v)
+{
+	return (uint16_t)std::lround(glm::clamp(v, 0.0f, 1.0f) * 65535.0f);
+}
+
+inline void PackVector48(const glm::vec3& v, const glm::vec3& rangeMin, const glm::vec3& rangeExtent, uint16_t out[3])
+{
+	for (int c = 0; c < 3; c++)
+		out[c] = rangeExtent[c] > 0.0f ? QuantizeUnit16((v[c] - rangeMin[c]) / rangeExtent[c]) : 0;
+}
+
+inline glm::vec3 UnpackVector48(const uint16_t in[3], const glm::vec3& rangeMin, const glm::vec3& rangeExtent)
+{
+	return rangeMin + rangeExtent * glm::vec3(in[0], in[1], in[2]) * (1.0f / 65535.0f);
+}
+
+#define SMALLEST_THREE_RANGE 0.70710678f // las tres menores caben en [-1/sqrt(2), 1/sqrt(2)]
+
+inline void PackQuat48(const glm::quat& rotation, uint16_t out[3])
+{
+	glm::quat q = glm::normalize(rotation);
+	float c[4] = { q.x, q.y, q.z, q.w };
+	int largest = 0;
+	for (int i = 1; i < 4; i++)
+		if (std::fabs(c[i]) > std::fabs(c[largest])) largest = i;
+	float sign = c[largest] < 0.0f ? -1.0f : 1.0f; // q y -q son la misma rotación
+	uint16_t packed[3];
+	for (int i = 0, j = 0; i < 4; i++) {
+		if (i == largest) continue;
+		float v = glm::clamp(sign * c[i] / SMALLEST_THREE_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+		packed[j++] = (uint16_t)std::lround(v * 32767.0f);
+	}
+	out[0] = (uint16_t)(packed[0] | ((largest & 2) << 14));
+	out[1] = (uint16_t)(packed[1] | ((largest & 1) << 15));
+	out[2] = packed[2];
+}
+
+inline glm::quat UnpackQuat48(const uint16_t in[3])
+{
+	int largest = ((in[0] >> 15) << 1) | (in[1] >> 15);
+	float c[4];
+	float sum = 0.0f;
+	for (int i = 0, j = 0; i < 4; i++) {
+		if (i == largest) continue;
+		float v = ((in[j++] & 0x7fff) / 32767.0f * 2.0f - 1.0f) * SMALLEST_THREE_RANGE;
+		c[i] = v;
+		sum += v * v;
+	}
+	c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+	return glm::normalize(glm::quat(c[3], c[0], c[1], c[2]));
+}
+
+inline glm::vec3 CompressedClip::vectorKey(const CompressedTrack& track, size_t key) const
+{
+	return UnpackVector48(keys[track.firstKey + key].value, track.rangeMin, track.rangeExtent);
+}
+
+inline glm::quat CompressedClip::rotationKey(const CompressedTrack& track, size_t key) const
+{
+	return UnpackQuat48(keys[track.firstKey + key].value);
+}
+
+/*  ------------------------------------------------------------------
+ *  Reducción de llaves
+ *  ------------------------------------------------------------------ */
+
+// ángulo entre dos rotaciones; con la cuerda en vez de acos(dot), que en float no distingue ángulos pequeños
+inline float RotationAngle(const glm::quat& a, const glm::quat& b)
+{
+	glm::quat d = glm::dot(a, b) < 0.0f ? a + b : a - b;
+	float chord = std::min(2.0f, std::sqrt(glm::dot(d, d)));
+	return 4.0f * std::asin(chord * 0.5f);
+}
+
+/**
+ * @brief Llaves que hay que conservar para que la interpolación lineal entre ellas reproduzca todas
+ * las demás dentro de la tolerancia
+ * Avanza desde la última llave conservada mientras todas las intermedias se puedan reconstruir; al
+ * fallar conserva la anterior. Como la curva original es lineal por tramos, basta revisar en los
+ * tiempos de las llaves. decoded(k) es el valor cuantizado (lo que va a ver el muestreo).
+ */
+template <typename T, typename Decoded, typename Interpolate, typename Distance>
+inline vector<uint32_t> ReduceKeys(const vector<float>& times, const vector<T>& values, float tolerance,
+	Decoded decoded, Interpolate interpolate, Distance distance)
+{
+	vector<uint32_t> kept;
+	size_t count = values.size();
+	if (count == 0) return kept;
+
+	// pista constante dentro de la tolerancia: una llave
+	bool constant = true;
+	for (size_t k = 1; k < count && constant; k++)
+		constant = distance(decoded(0), values[k]) <= tolerance;
+	kept.push_back(0);
+	if (constant) return kept;
+
+	size_t anchor = 0;
+	for (size_t end = anchor + 2; end < count; end++) {
+		bool fits = true;
+		float span = times[end] - times[anchor];
+		for (size_t k = anchor + 1; k < end && fits; k++) {
+			float factor = span > 0.0f ? (times[k] - times[anchor]) / span : 0.0f;
+			fits = distance(interpolate(decoded(anchor), decoded(end), factor), values[k]) <= tolerance;
+		}
+		if (!fits) {
+			anchor = end - 1;
+			kept.push_back((uint32_t)anchor);
+		}
+	}
+	if (anchor != count - 1) kept.push_back((uint32_t)(count - 1));
+	return kept;
+}
+
+inline void RangeOf(const vector<glm::vec3>& values, glm::vec3& rangeMin, glm::vec3& rangeExtent)
+{
+	glm::vec3 lo(0.0f), hi(0.0f);
+	if (!values.empty()) lo = hi = values.front();
+	for (const glm::vec3& v : values) {
+		lo = glm::min(lo, v);
+		hi = glm::max(hi, v);
+	}
+	rangeMin = lo;
+	rangeExtent = hi - lo;
+}
+
+inline uint16_t QuantizeKeyTime(float time, double duration)
+{
+	return duration > 0.0 ? QuantizeUnit16((float)(time / duration)) : 0;
+}
+
+// agrega las llaves conservadas al clip y la tabla de bloques de la pista
+inline void AppendTrackKeys(CompressedClip& out, CompressedTrack& track, const vector<uint32_t>& kept,
+	const vector<PackedKey>& packed)
+{
+	track.firstKey = (uint32_t)out.keys.size();
+	track.keyCount = (uint32_t)kept.size();
+	track.firstBlock = (uint32_t)out.blockTimes.size();
+	for (size_t i = 0; i < kept.size(); i++) {
+		out.keys.push_back(packed[kept[i]]);
+		if (i % ANIMATION_KEY_BLOCK_SIZE == 0)
+			out.blockTimes.push_back(out.keyTime(track, i));
+	}
+}
+
+inline void CompressVectorTrack(CompressedClip& out, CompressedTrack& track, const vector<float>& times, const vector<glm::vec3>& values,
+	float tolerance)
+{
+	RangeOf(values, track.rangeMin, track.rangeExtent);
+	vector<PackedKey> packed(values.size());
+	vector<glm::vec3> decodedValues(values.size());
+	for (size_t k = 0; k < values.size(); k++) {
+		packed[k].time = QuantizeKeyTime(times[k], out.duration);
+		PackVector48(values[k], track.rangeMin, track.rangeExtent, packed[k].value);
+		decodedValues[k] = UnpackVector48(packed[k].value, track.rangeMin, track.rangeExtent);
+	}
+	vector<uint32_t> kept = ReduceKeys(times, values, tolerance,
+		[&](size_t k) { return decodedValues[k]; },
+		[](const glm::vec3& a, const glm::vec3& b, float f) { return a + f * (b - a); },
+		[](const glm::vec3& a, const glm::vec3& b) { return glm::length(a - b); });
+	AppendTrackKeys(out, track, kept, packed);
+}
+
+inline void CompressRotationTrack(CompressedClip& out, CompressedTrack& track, const vector<float>& times, const vector<glm::quat>& values,
+	float tolerance)
+{
+	track.rangeMin = track.rangeExtent = glm::vec3(0.0f);
+	vector<PackedKey> packed(values.size());
+	vector<glm::quat> decodedValues(values.size());
+	for (size_t k = 0; k < values.size(); k++) {
+		packed[k].time = QuantizeKeyTime(times[k], out.duration);
+		PackQuat48(values[k], packed[k].value);
+		decodedValues[k] = UnpackQuat48(packed[k].value);
+	}
+	vector<uint32_t> kept = ReduceKeys(times, values, tolerance,
+		[&](size_t k) { return decodedValues[k]; },
+		[](const glm::quat& a, const glm::quat& b, float f) { return glm::normalize(glm::slerp(a, b, f)); },
+		[](const glm::quat& a, const glm::quat& b) { return RotationAngle(a, b); });
+	AppendTrackKeys(out, track, kept, packed);
+}
+
+/*  ------------------------------------------------------------------
+ *  Muestreo
+ *  ------------------------------------------------------------------ */
+
+/**
+ * @brief Llave anterior a time en una pista comprimida, partiendo del cursor del muestreo anterior
+ * Mismo contrato que AdvanceKeyCursor: unos pasos hacia adelante y, si no alcanza o el tiempo
+ * retrocedió, búsqueda binaria en blockTimes y lineal dentro del bloque.
+ */
+inline size_t AdvanceCompressedCursor(const CompressedClip& clip, const CompressedTrack& track, float time, uint32_t& cursor, float& factor)
+{
+	factor = 0.0f;
+	size_t count = track.keyCount;
+	if (count < 2 || time <= clip.keyTime(track, 0)) { cursor = 0; return 0; }
+	if (time >= clip.keyTime(track, count - 1)) { cursor = (uint32_t)(count - 1); return count - 1; }
+
+	size_t index = cursor < count ? cursor : 0;
+	bool search = clip.keyTime(track, index) > time;
+	int steps = 0;
+	while (!search && clip.keyTime(track, index + 1) <= time) {
+		if (++steps > KEY_CURSOR_MAX_STEPS) search = true;
+		else index++;
+	}
+	if (search) {
+		const float* blocks = clip.blockTimes.data() + track.firstBlock;
+		size_t blockCount = (count + ANIMATION_KEY_BLOCK_SIZE - 1) / ANIMATION_KEY_BLOCK_SIZE;
+		size_t block = (size_t)(std::upper_bound(blocks, blocks + blockCount, time) - blocks) - 1;
+		index = block * ANIMATION_KEY_BLOCK_SIZE;
+		while (clip.keyTime(track, index + 1) <= time) index++;
+	}
+	cursor = (uint32_t)index;
+	float t0 = clip.keyTime(track, index);
+	float delta = clip.keyTime(track, index + 1) - t0;
+	factor = delta > 0.0f ? (time - t0) / delta : 0.0f;
+	return index;
+}
+
+inline glm::vec3 SampleCompressedVector(const CompressedClip& clip, const CompressedTrack& track, float time, uint32_t& cursor, const glm::vec3& fallback)
+{
+	if (track.keyCount == 0) return fallback;
+	float factor;
+	size_t index = AdvanceCompressedCursor(clip, track, time, cursor, factor);
+	glm::vec3 a = clip.vectorKey(track, index);
+	if (index + 1 >= track.keyCount) return a;
+	return a + factor * (clip.vectorKey(track, index + 1) - a);
+}
+
+inline glm::quat SampleCompressedRotation(const CompressedClip& clip, const CompressedTrack& track, float time, uint32_t& cursor)
+{
+	if (track.keyCount == 0) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	float factor;
+	size_t index = AdvanceCompressedCursor(clip, track, time, cursor, factor);
+	glm::quat a = clip.rotationKey(track, index);
+	if (index + 1 >= track.keyCount) return a;
+	return glm::normalize(glm::slerp(a, clip.rotationKey(track, index + 1), factor));
+}
+
+/*  ------------------------------------------------------------------
+ *  Compresión de un clip
+ *  ------------------------------------------------------------------ */
+
+/**
+ * @brief Comprime un clip y mide el peor error contra sus llaves originales
+ */
+inline CompressedClip CompressAnimationClip(const AnimationClip& clip, const AnimationCompressionSettings& settings,
+	AnimationCompressionReport* report = nullptr)
+{
+	CompressedClip out;
+	out.name = clip.name;
+	out.duration = clip.duration;
+	out.ticksPerSecond = clip.ticksPerSecond;
+	out.channelForNode = clip.channelForNode;
+	out.channels.resize(clip.channels.size());
+
+	for (size_t c = 0; c < clip.channels.size(); c++) {
+		const AnimationChannel& ch = clip.channels[c];
+		CompressedChannel& cc = out.channels[c];
+		cc.node = ch.node;
+		CompressVectorTrack(out, cc.position, ch.positionTimes, ch.positions, settings.positionTolerance);
+		CompressRotationTrack(out, cc.rotation, ch.rotationTimes, ch.rotations, settings.rotationTolerance);
+		CompressVectorTrack(out, cc.scale, ch.scaleTimes, ch.scales, settings.scaleTolerance);
+	}
+
+	if (report) {
+		*report = AnimationCompressionReport();
+		report->rawBytes = AnimationClipByteSize(clip);
+		report->compressedBytes = out.byteSize();
+		report->rawKeys = AnimationKeyCount(clip);
+		report->keptKeys = out.keys.size();
+		// error real: se muestrea el clip comprimido en el tiempo de cada llave original
+		for (size_t c = 0; c < clip.channels.size(); c++) {
+			const AnimationChannel& ch = clip.channels[c];
+			const CompressedChannel& cc = out.channels[c];
+			uint32_t cursor = 0;
+			for (size_t k = 0; k < ch.positions.size(); k++)
+				report->maxPositionError = std::max(report->maxPositionError,
+					glm::length(SampleCompressedVector(out, cc.position, ch.positionTimes[k], cursor, glm::vec3(0.0f)) - ch.positions[k]));
+			cursor = 0;
+			for (size_t k = 0; k < ch.rotations.size(); k++)
+				report->maxRotationError = std::max(report->maxRotationError,
+					RotationAngle(SampleCompressedRotation(out, cc.rotation, ch.rotationTimes[k], cursor), ch.rotations[k]));
+			cursor = 0;
+			for (size_t k = 0; k < ch.scales.size(); k++)
+				report->maxScaleError = std::max(report->maxScaleError,
+					glm::length(SampleCompressedVector(out, cc.scale, ch.scaleTimes[k], cursor, glm::vec3(1.0f)) - ch.scales[k]));
+		}
+	}
+	return out;
+}
+
+#endif
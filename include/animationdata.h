@@ -0,0 +1,282 @@
+#ifndef ANIMATIONDATA_H
+#define ANIMATIONDATA_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <assimp/scene.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+using namespace std;
+
+/**
+ * @brief Jerarquía de nodos aplanada en preorden
+ * El padre de un nodo siempre aparece antes que él, así que las transformaciones globales
+ * se calculan con un solo recorrido lineal del arreglo, sin recursión.
+ */
+struct NodeHierarchy {
+	vector<string>    names;
+	vector<int32_t>   parents; // -1 en la raíz
+	vector<glm::mat4> localTransforms; // mTransformation del nodo (pose de enlace)
+
+	size_t size() const { return names.size(); }
+
+	int32_t find(const string& name) const {
+		for (size_t i = 0; i < names.size(); i++)
+			if (names[i] == name) return (int32_t)i;
+		return -1;
+	}
+
+	void add(const string& name, int32_t parent, const glm::mat4& local) {
+		names.push_back(name);
+		parents.push_back(parent);
+		localTransforms.push_back(local);
+	}
+};
+
+/**
+ * @brief Llaves de un nodo animado, en arreglos separados por componente (SoA)
+ * Los tiempos están en ticks, igual que en aiNodeAnim.
+ */
+struct AnimationChannel {
+	int32_t           node; // índice en la NodeHierarchy
+	vector<float>     positionTimes;
+	vector<glm::vec3> positions;
+	vector<float>     rotationTimes;
+	vector<glm::quat> rotations;
+	vector<float>     scaleTimes;
+	vector<glm::vec3> scales;
+};
+
+/**
+ * @brief Una animación ya convertida, independiente de Assimp
+ */
+struct AnimationClip {
+	string                   name;
+	double                   duration;       // en ticks
+	double                   ticksPerSecond;
+	vector<AnimationChannel> channels;
+	vector<int32_t>          channelForNode; // por nodo de la jerarquía; -1 si no está animado
+
+	AnimationClip() : duration(0.0), ticksPerSecond(0.0) {}
+
+	// llena channelForNode a partir del nodo de cada canal
+	void linkNodes(size_t nodeCount) {
+		channelForNode.assign(nodeCount, -1);
+		for (size_t c = 0; c < channels.size(); c++) {
+			int32_t node = channels[c].node;
+			if (node >= 0 && (size_t)node < nodeCount && channelForNode[node] < 0)
+				channelForNode[node] = (int32_t)c;
+		}
+	}
+};
+
+inline glm::mat4 AiMatrixToGlm(const aiMatrix4x4& from)
+{
+	glm::mat4 to;
+	to[0][0] = from.a1; to[0][1] = from.b1; to[0][2] = from.c1; to[0][3] = from.d1;
+	to[1][0] = from.a2; to[1][1] = from.b2; to[1][2] = from.c2; to[1][3] = from.d2;
+	to[2][0] = from.a3; to[2][1] = from.b3; to[2][2] = from.c3; to[2][3] = from.d3;
+	to[3][0] = from.a4; to[3][1] = from.b4; to[3][2] = from.c4; to[3][3] = from.d4;
+	return to;
+}
+
+inline void BuildNodeHierarchy(const aiNode* node, int32_t parent, NodeHierarchy& out)
+{
+	int32_t self = (int32_t)out.size();
+	out.add(node->mName.C_Str(), parent, AiMatrixToGlm(node->mTransformation));
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+		BuildNodeHierarchy(node->mChildren[i], self, out);
+}
+
+// copia las llaves de una aiAnimation; los canales de nodos que no existen en la jerarquía se descartan
+inline AnimationClip BuildAnimationClip(const aiAnimation* anim, const NodeHierarchy& nodes)
+{
+	AnimationClip clip;
+	clip.name = anim->mName.C_Str();
+	clip.duration = anim->mDuration;
+	clip.ticksPerSecond = anim->mTicksPerSecond;
+	clip.channels.reserve(anim->mNumChannels);
+	for (unsigned int c = 0; c < anim->mNumChannels; c++) {
+		const aiNodeAnim* ch = anim->mChannels[c];
+		AnimationChannel channel;
+		channel.node = nodes.find(ch->mNodeName.C_Str());
+		if (channel.node < 0) continue;
+
+		channel.positionTimes.reserve(ch->mNumPositionKeys);
+		channel.positions.reserve(ch->mNumPositionKeys);
+		for (unsigned int k = 0; k < ch->mNumPositionKeys; k++) {
+			const aiVectorKey& key = ch->mPositionKeys[k];
+			channel.positionTimes.push_back((float)key.mTime);
+			channel.positions.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+		}
+		channel.rotationTimes.reserve(ch->mNumRotationKeys);
+		channel.rotations.reserve(ch->mNumRotationKeys);
+		for (unsigned int k = 0; k < ch->mNumRotationKeys; k++) {
+			const aiQuatKey& key = ch->mRotationKeys[k];
+			channel.rotationTimes.push_back((float)key.mTime);
+			channel.rotations.push_back(glm::quat(key.mValue.w, key.mValue.x, key.mValue.y, key.mValue.z));
+		}
+		channel.scaleTimes.reserve(ch->mNumScalingKeys);
+		channel.scales.reserve(ch->mNumScalingKeys);
+		for (unsigned int k = 0; k < ch->mNumScalingKeys; k++) {
+			const aiVectorKey& key = ch->mScalingKeys[k];
+			channel.scaleTimes.push_back((float)key.mTime);
+			channel.scales.push_back(glm::vec3(key.mValue.x, key.mValue.y, key.mValue.z));
+		}
+		clip.channels.push_back(std::move(channel));
+	}
+	clip.linkNodes(nodes.size());
+	return clip;
+}
+
+inline vector<AnimationClip> BuildAnimationClips(const aiScene* scene, const NodeHierarchy& nodes)
+{
+	vector<AnimationClip> clips;
+	for (unsigned int a = 0; a < scene->mNumAnimations; a++)
+		clips.push_back(BuildAnimationClip(scene->mAnimations[a], nodes));
+	return clips;
+}
+
+/**
+ * @brief Llave anterior a time y factor de interpolación hacia la siguiente (búsqueda binaria)
+ * Antes de la primera llave o después de la última se mantiene el valor del extremo.
+ */
+inline size_t FindKeyFrame(const vector<float>& times, float time, float& factor)
+{
+	factor = 0.0f;
+	if (times.size() < 2 || time <= times.front()) return 0;
+	if (time >= times.back()) return times.size() - 1;
+	size_t next = (size_t)(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+	size_t index = next - 1;
+	float delta = times[next] - times[index];
+	factor = delta > 0.0f ? (time - times[index]) / delta : 0.0f;
+	return index;
+}
+
+// valor entre la llave index y la siguiente (factor de FindKeyFrame)
+inline glm::vec3 LerpVectorKeys(const vector<glm::vec3>& values, size_t index, float factor)
+{
+	if (index + 1 >= values.size()) return values[index];
+	return values[index] + factor * (values[index + 1] - values[index]);
+}
+
+inline glm::quat SlerpRotationKeys(const vector<glm::quat>& values, size_t index, float factor)
+{
+	if (index + 1 >= values.size()) return values[index];
+	return glm::normalize(glm::slerp(values[index], values[index + 1], factor));
+}
+
+inline glm::vec3 SampleVectorKeys(const vector<float>& times, const vector<glm::vec3>& values, float time, const glm::vec3& fallback)
+{
+	if (values.empty()) return fallback;
+	float factor;
+	size_t index = FindKeyFrame(times, time, factor);
+	return LerpVectorKeys(values, index, factor);
+}
+
+inline glm::quat SampleRotationKeys(const vector<float>& times, const vector<glm::quat>& values, float time)
+{
+	if (values.empty()) return glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	float factor;
+	size_t index = FindKeyFrame(times, time, factor);
+	return SlerpRotationKeys(values, index, factor);
+}
+
+/**
+ * @brief Transformación local T * R * S de una pista ya muestreada
+ * Como en la versión con aiNodeAnim, la traslación sólo se aplica cuando la escala es unitaria.
+ */
+inline glm::mat4 ComposeKeyTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	glm::mat4 m = glm::mat4_cast(rotation);
+	m[0] *= scale.x;
+	m[1] *= scale.y;
+	m[2] *= scale.z;
+	const float epsilon = 10e-3f; // el de aiMatrix4x4::IsIdentity
+	if (std::fabs(scale.x - 1.0f) <= epsilon && std::fabs(scale.y - 1.0f) <= epsilon && std::fabs(scale.z - 1.0f) <= epsilon)
+		m[3] = glm::vec4(position, 1.0f);
+	return m;
+}
+
+// transformación local de un canal en el instante time (ticks)
+inline glm::mat4 SampleChannel(const AnimationChannel& channel, float time)
+{
+	glm::vec3 scale = SampleVectorKeys(channel.scaleTimes, channel.scales, time, glm::vec3(1.0f));
+	glm::quat rotation = SampleRotationKeys(channel.rotationTimes, channel.rotations, time);
+	glm::vec3 position = SampleVectorKeys(channel.positionTimes, channel.positions, time, glm::vec3(0.0f));
+	return ComposeKeyTransform(position, rotation, scale);
+}
+
+/**
+ * @brief Transformaciones globales de todos los nodos para una animación
+ * Los nodos sin canal usan la identidad (no su mTransformation), igual que ReadNodeHierarchy.
+ */
+inline void EvaluateNodeGlobals(const NodeHierarchy& nodes, const AnimationClip& clip, float time, vector<glm::mat4>& globals)
+{
+	globals.resize(nodes.size());
+	for (size_t i = 0; i < nodes.size(); i++) {
+		int32_t c = i < clip.channelForNode.size() ? clip.channelForNode[i] : -1;
+		glm::mat4 local = c >= 0 ? SampleChannel(clip.channels[c], time) : glm::mat4(1.0f);
+		int32_t parent = nodes.parents[i];
+		globals[i] = parent >= 0 ? globals[parent] * local : local;
+	}
+}
+
+// quita las llaves iguales a la anterior y a la siguiente (o la última si repite la anterior); con
+// interpolación lineal y el valor del extremo fuera del rango la curva no cambia
+template <typename T>
+inline size_t RemoveRedundantKeys(vector<float>& times, vector<T>& values)
+{
+	if (values.size() < 2) return 0;
+	size_t kept = 1;
+	for (size_t k = 1; k < values.size(); k++) {
+		bool last = k + 1 == values.size();
+		if (values[k] == values[kept - 1] && (last || values[k] == values[k + 1])) continue;
+		times[kept] = times[k];
+		values[kept] = values[k];
+		kept++;
+	}
+	size_t removed = values.size() - kept;
+	times.resize(kept);
+	values.resize(kept);
+	return removed;
+}
+
+/**
+ * @brief Compacta un clip sin perder precisión: quita llaves redundantes de cada pista
+ * @return Número de llaves eliminadas
+ */
+inline size_t CompactAnimationClip(AnimationClip& clip)
+{
+	size_t removed = 0;
+	for (AnimationChannel& ch : clip.channels) {
+		removed += RemoveRedundantKeys(ch.positionTimes, ch.positions);
+		removed += RemoveRedundantKeys(ch.rotationTimes, ch.rotations);
+		removed += RemoveRedundantKeys(ch.scaleTimes, ch.scales);
+	}
+	return removed;
+}
+
+inline size_t AnimationKeyCount(const AnimationClip& clip)
+{
+	size_t count = 0;
+	for (const AnimationChannel& ch : clip.channels)
+		count += ch.positions.size() + ch.rotations.size() + ch.scales.size();
+	return count;
+}
+
+// nodo de cada hueso (por nombre); -1 si el hueso no está en la jerarquía
+template <typename BoneT>
+inline vector<int32_t> MapBonesToNodes(const vector<BoneT>& bones, const NodeHierarchy& nodes)
+{
+	vector<int32_t> result(bones.size(), -1);
+	for (size_t b = 0; b < bones.size(); b++)
+		result[b] = nodes.find(bones[b].name.C_Str());
+	return result;
+}
+
+#endif
@@ -0,0 +1,230 @@
+#ifndef ANIMATIONGRAPH_H
+#define ANIMATIONGRAPH_H
+
+#include <glm/glm.hpp>
+
+#include <skeleton.h>
+#include <animationsampler.h>
+#include <animationcompress.h>
+#include <localpose.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+using namespace std;
+
+// Un estado del grafo: un clip con su velocidad y si se repite (idle, walk, run...) o se queda en el último frame (jump)
+struct AnimationGraphState {
+	string       name;
+	unsigned int clip;
+	float        speed;
+	bool         loop;
+};
+
+/**
+ * @brief Máquina de estados de animación de un personaje, con transiciones suaves y capas aditivas
+ * Cada estado activo se muestrea a una LocalPose y las poses se mezclan componente a componente
+ * (BlendLocalPoses, AddLocalPose); la jerarquía se recorre una sola vez al final. Así mezclar varios
+ * clips cuesta unas cuantas operaciones SIMD por hueso y no una matriz por hueso y por clip.
+ * Como AnimationInstance, sólo guarda estado de reproducción: el esqueleto y los clips son del AnimatedModel.
+ */
+class AnimationGraph {
+public:
+	AnimationGraph()
+		: skeleton(nullptr), clips(nullptr), compressedClips(nullptr), posePending(false), poseVersion(0),
+		  palette(MAX_RIGGING_BONES, glm::mat4(1.0f)) {}
+
+	// compressedClips: si no es nulo, las llaves se muestrean de ahí (ver AnimatedModel::compressedAnimations)
+	AnimationGraph(const Skeleton* skeleton, const vector<AnimationClip>* clips, const vector<CompressedClip>* compressedClips = nullptr)
+		: skeleton(skeleton), clips(clips), compressedClips(compressedClips), posePending(false), poseVersion(0),
+		  palette(MAX_RIGGING_BONES, glm::mat4(1.0f)) {}
+
+	bool valid() const { return skeleton && clips && !tracks.empty(); }
+
+	// devuelve el índice del estado, -1 si el clip no existe
+	int addState(const string& name, unsigned int clip, float speed = 1.0f, bool loop = true) {
+		if (!clips || clip >= clips->size()) {
+			cout << "Error: no valid animation index for state " << name << "." << endl;
+			return -1;
+		}
+		states.push_back(AnimationGraphState{ name, clip, speed, loop });
+		return (int)states.size() - 1;
+	}
+
+	int findState(const string& name) const {
+		for (size_t i = 0; i < states.size(); i++)
+			if (states[i].name == name) return (int)i;
+		return -1;
+	}
+
+	const AnimationGraphState& getState(int state) const { return states[state]; }
+
+	// estado al que va (o ya llegó) el grafo; -1 antes del primer play
+	int getCurrentState() const { return tracks.empty() ? -1 : tracks.back().state; }
+
+	// true si el estado actual no se repite y ya llegó a su último frame
+	bool isCurrentStateFinished() const {
+		if (tracks.empty()) return false;
+		const Track& track = tracks.back();
+		return !states[track.state].loop && track.time >= (float)(*clips)[states[track.state].clip].duration;
+	}
+
+	// cambia de estado de golpe, desde el inicio de su clip
+	void play(int state) {
+		if (state < 0 || state >= (int)states.size()) return;
+		tracks.clear();
+		tracks.push_back(makeTrack(state, 1.0f, 0.0f));
+		posePending = true;
+	}
+
+	/**
+	 * @brief Pasa al estado en seconds segundos mezclando desde la pose actual
+	 * Las transiciones se pueden encadenar: la pose de la que se sale es la mezcla que había.
+	 */
+	void crossFade(int state, float seconds) {
+		if (state < 0 || state >= (int)states.size()) return;
+		if (!tracks.empty() && tracks.back().state == state) return;
+		if (tracks.empty() || seconds <= 0.0f) {
+			play(state);
+			return;
+		}
+		tracks.push_back(makeTrack(state, 0.0f, 1.0f / seconds));
+	}
+
+	/**
+	 * @brief Agrega un clip que se suma encima de los estados (p. ej. respirar, apuntar)
+	 * Se suma la diferencia de cada frame respecto al primer frame del clip, escalada por weight.
+	 */
+	int addAdditiveLayer(unsigned int clip, float weight = 1.0f, float speed = 1.0f) {
+		if (!skeleton || !clips || clip >= clips->size()) {
+			cout << "Error: no valid animation index for additive layer." << endl;
+			return -1;
+		}
+		Layer layer;
+		layer.clip = clip;
+		layer.time = 0.0f;
+		layer.weight = weight;
+		layer.speed = speed;
+		bindSampler(layer.sampler, clip);
+		layer.sampler.samplePose(0.0f, layer.reference);
+		layers.push_back(std::move(layer));
+		return (int)layers.size() - 1;
+	}
+
+	void setLayerWeight(int layer, float weight) {
+		if (layer >= 0 && layer < (int)layers.size()) layers[layer].weight = weight;
+	}
+
+	// avanza estados, transiciones y capas; la paleta queda pendiente hasta evaluatePose()
+	void update(float deltaTime) {
+		if (!valid()) return;
+
+		for (Track& track : tracks) {
+			advance(track.time, states[track.state].clip, states[track.state].speed, states[track.state].loop, deltaTime);
+			track.weight = std::min(1.0f, track.weight + track.fadeRate * deltaTime);
+		}
+		// lo que está antes de una transición terminada ya no se ve
+		for (size_t i = tracks.size(); i-- > 1;) {
+			if (tracks[i].weight >= 1.0f) {
+				tracks.erase(tracks.begin(), tracks.begin() + i);
+				break;
+			}
+		}
+		for (Layer& layer : layers)
+			advance(layer.time, layer.clip, layer.speed, true, deltaTime);
+
+		posePending = true;
+	}
+
+	bool hasPendingPose() const { return posePending; }
+
+	// mezcla las poses y calcula la paleta si update() dejó una pendiente; igual que
+	// AnimationInstance::evaluatePose, se puede llamar desde un trabajo del JobSystem
+	void evaluatePose() {
+		if (!posePending || !valid()) return;
+		posePending = false;
+		evaluate();
+	}
+
+	// MAX_RIGGING_BONES matrices; se suben con BonePaletteBuffer
+	const glm::mat4* getBonePalette() const { return palette.data(); }
+
+	// cambia cada vez que se recalcula la paleta (ver BonePaletteBuffer)
+	unsigned int getPoseVersion() const { return poseVersion; }
+
+private:
+	struct Track {
+		int         state;
+		float       time;     // ticks
+		float       weight;   // cuánto ha reemplazado a la mezcla de los tracks anteriores (0..1)
+		float       fadeRate; // por segundo
+		PoseSampler sampler;
+	};
+
+	struct Layer {
+		unsigned int clip;
+		float        time;
+		float        weight;
+		float        speed;
+		PoseSampler  sampler;
+		LocalPose    reference; // primer frame del clip
+	};
+
+	const Skeleton*               skeleton;
+	const vector<AnimationClip>*  clips;
+	const vector<CompressedClip>* compressedClips;
+	vector<AnimationGraphState>   states;
+	vector<Track>                 tracks; // el último es el estado actual
+	vector<Layer>                 layers;
+	bool                          posePending;
+	unsigned int                  poseVersion;
+	LocalPose                     blended, scratch, delta;
+	vector<glm::mat4>             poseGlobals;
+	vector<glm::mat4>             palette;
+
+	void bindSampler(PoseSampler& sampler, unsigned int clip) const {
+		if (compressedClips && clip < compressedClips->size())
+			sampler.bind(&(*compressedClips)[clip], skeleton->poseNodes);
+		else
+			sampler.bind(&(*clips)[clip], skeleton->poseNodes);
+	}
+
+	Track makeTrack(int state, float weight, float fadeRate) const {
+		Track track;
+		track.state = state;
+		track.time = 0.0f;
+		track.weight = weight;
+		track.fadeRate = fadeRate;
+		bindSampler(track.sampler, states[state].clip);
+		return track;
+	}
+
+	void advance(float& time, unsigned int clip, float speed, bool loop, float deltaTime) const {
+		const AnimationClip& c = (*clips)[clip];
+		time += deltaTime * (float)c.ticksPerSecond * speed;
+		float duration = (float)c.duration;
+		if (duration <= 0.0f) time = 0.0f;
+		else if (loop) time = std::fmod(time, duration);
+		else time = std::min(time, duration);
+	}
+
+	void evaluate() {
+		tracks[0].sampler.samplePose(tracks[0].time, blended);
+		for (size_t i = 1; i < tracks.size(); i++) {
+			tracks[i].sampler.samplePose(tracks[i].time, scratch);
+			BlendLocalPoses(blended, scratch, tracks[i].weight, blended);
+		}
+		for (Layer& layer : layers) {
+			if (layer.weight <= 0.0f) continue;
+			layer.sampler.samplePose(layer.time, scratch);
+			SubtractLocalPose(scratch, layer.reference, delta);
+			AddLocalPose(blended, delta, layer.weight);
+		}
+		skeleton->computePalette(blended, poseGlobals, palette.data(), palette.size());
+		poseVersion++;
+	}
+};
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef ANIMATIONINSTANCE_H
+#define ANIMATIONINSTANCE_H
+
+#include <glm/glm.hpp>
+
+#include <skeleton.h>
+
+#include <vector>
+#include <iostream>
+#include <cmath>
+using namespace std;
+
+/**
+ * @brief Estado de reproducción de un personaje animado
+ * Guarda sólo el clip actual, el tiempo, los cursores de llaves y la paleta de huesos; el esqueleto
+ * y los clips son del AnimatedModel, que debe vivir más que sus instancias. Varios objetos pueden usar el mismo
+ * modelo cargado una sola vez y cada uno anima por su cuenta.
+ */
+class AnimationInstance {
+public:
+	AnimationInstance()
+		: skeleton(nullptr), clips(nullptr), compressedClips(nullptr), clip(0), frame(0), time(0.0f),
+		  posePending(false), pendingTime(0.0f), poseVersion(0), palette(MAX_RIGGING_BONES, glm::mat4(1.0f)) {}
+
+	// compressedClips: si no es nulo, las llaves se muestrean de ahí y de clips sólo se usan duración y ticks por segundo
+	AnimationInstance(const Skeleton* skeleton, const vector<AnimationClip>* clips, unsigned int clip = 0,
+		const vector<CompressedClip>* compressedClips = nullptr)
+		: skeleton(skeleton), clips(clips), compressedClips(compressedClips), clip(0), frame(0), time(0.0f),
+		  posePending(false), pendingTime(0.0f), poseVersion(0), palette(MAX_RIGGING_BONES, glm::mat4(1.0f)) {
+		setClip(clip);
+	}
+
+	bool valid() const { return skeleton && clips && clip < clips->size(); }
+
+	// cambia de clip y regresa a su primer frame
+	bool setClip(unsigned int index) {
+		if (!skeleton || !clips || index >= clips->size()) {
+			cout << "Error: no valid animation index." << endl;
+			return false;
+		}
+		clip = index;
+		if (compressedClips && clip < compressedClips->size())
+			sampler.bind(&(*compressedClips)[clip], skeleton->poseNodes);
+		else
+			sampler.bind(&(*clips)[clip], skeleton->poseNodes);
+		frame = 0;
+		time = 0.0f;
+		setPose(0.0f);
+		return true;
+	}
+
+	// avanza deltaTime segundos y regresa al inicio al pasar el último frame; la pose del instante
+	// exacto (interpolada entre llaves) queda pendiente hasta evaluatePose(). Un deltaTime grande, como
+	// el de los objetos que el SignificanceManager actualiza pocas veces por segundo, sólo salta más adelante
+	void update(float deltaTime) {
+		if (!valid()) return;
+		const AnimationClip& current = (*clips)[clip];
+		float duration = (float)current.duration;
+		time += deltaTime * (float)current.ticksPerSecond;
+		time = duration > 0.0f ? std::fmod(time, duration) : 0.0f;
+		frame = (int)time;
+		requestPose(time);
+	}
+
+	// salta a un frame (p. ej. para desfasar personajes que comparten clip)
+	void seek(int targetFrame) {
+		if (!valid()) return;
+		int keys = (int)(*clips)[clip].duration;
+		frame = keys > 0 ? ((targetFrame % keys) + keys) % keys : 0;
+		time = (float)frame;
+		setPose(time);
+	}
+
+	// pide la pose del instante time sin calcularla (ver evaluatePose)
+	void requestPose(float time) {
+		pendingTime = time;
+		posePending = true;
+	}
+
+	bool hasPendingPose() const { return posePending; }
+
+	/**
+	 * @brief Calcula la pose pedida, si hay una
+	 * Sólo toca el estado de esta instancia, así que la fase de poses de SceneManager llama a
+	 * evaluatePose de muchos personajes a la vez en el JobSystem; el render la llama de nuevo por si
+	 * nadie lo hizo (entonces no hace nada).
+	 */
+	void evaluatePose() {
+		if (posePending) setPose(pendingTime);
+	}
+
+	// pose del clip actual en el instante time (ticks), calculada en el momento
+	void setPose(float time) {
+		posePending = false;
+		if (!valid()) return;
+		skeleton->computePalette(sampler, time, poseGlobals, palette.data(), palette.size());
+		poseVersion++;
+	}
+
+	// MAX_RIGGING_BONES matrices; se suben con BonePaletteBuffer
+	const glm::mat4* getBonePalette() const { return palette.data(); }
+
+	// cambia cada vez que se recalcula la paleta (ver BonePaletteBuffer)
+	unsigned int getPoseVersion() const { return poseVersion; }
+
+	unsigned int getClip() const { return clip; }
+	int getFrame() const { return frame; }
+
+private:
+	const Skeleton*               skeleton;
+	const vector<AnimationClip>*  clips;
+	const vector<CompressedClip>* compressedClips;
+	unsigned int                  clip;
+	int                           frame;       // frame actual (ticks enteros)
+	float                         time;        // ticks desde el inicio del clip
+	bool                          posePending; // requestPose sin evaluatePose
+	float                         pendingTime;
+	unsigned int                  poseVersion;
+	PoseSampler                   sampler;     // canales ligados al esqueleto y cursores de llaves
+	vector<glm::mat4>             poseGlobals; // memoria de trabajo de setPose
+	vector<glm::mat4>             palette;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef ANIMATIONSAMPLER_H
+#define ANIMATIONSAMPLER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <animationdata.h>
+#include <animationcompress.h>
+#include <localpose.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// Llave actual de cada pista de un canal (índices en sus arreglos de tiempos)
+struct KeyCursor {
+	uint32_t position;
+	uint32_t rotation;
+	uint32_t scale;
+};
+
+/**
+ * @brief Como FindKeyFrame, pero parte de la llave del muestreo anterior
+ * Al reproducir, el tiempo avanza poco entre muestras y la llave es la misma o una de las
+ * siguientes, así que basta con avanzar el cursor; al saltar hacia atrás (vuelta del ciclo, seek)
+ * o muy adelante se usa búsqueda binaria. Devuelve la misma llave y factor que FindKeyFrame.
+ */
+inline size_t AdvanceKeyCursor(const vector<float>& times, float time, uint32_t& cursor, float& factor)
+{
+	factor = 0.0f;
+	size_t count = times.size();
+	if (count < 2 || time <= times.front()) { cursor = 0; return 0; }
+	if (time >= times.back()) { cursor = (uint32_t)(count - 1); return count - 1; }
+
+	size_t index = cursor < count ? cursor : 0;
+	if (times[index] > time) {
+		index = (size_t)(std::upper_bound(times.begin(), times.begin() + index, time) - times.begin()) - 1;
+	}
+	else {
+		int steps = 0;
+		while (index + 1 < count && times[index + 1] <= time) {
+			if (++steps > KEY_CURSOR_MAX_STEPS) {
+				index = (size_t)(std::upper_bound(times.begin() + index, times.end(), time) - times.begin()) - 1;
+				break;
+			}
+			index++;
+		}
+	}
+	cursor = (uint32_t)index;
+	float delta = times[index + 1] - times[index];
+	factor = delta > 0.0f ? (time - times[index]) / delta : 0.0f;
+	return index;
+}
+
+/**
+ * @brief Muestreador de un clip ligado a los nodos de pose de un esqueleto
+ * bind() resuelve una sola vez qué canal mueve a cada nodo (ver Skeleton::poseNodes); después
+ * sample() sólo recorre esos nodos con un cursor por canal, sin buscar nombres ni recorrer llaves
+ * desde el principio. Cada AnimationInstance tiene el suyo (los cursores son estado de reproducción).
+ */
+class PoseSampler {
+public:
+	PoseSampler() : clip(nullptr), compressed(nullptr) {}
+
+	// poseNodes: nodo de la jerarquía de cada posición de la pose
+	void bind(const AnimationClip* boundClip, const vector<int32_t>& poseNodes) {
+		clip = boundClip;
+		compressed = nullptr;
+		bindChannels(clip ? &clip->channelForNode : nullptr, poseNodes);
+	}
+
+	// mismo muestreo sobre un clip comprimido (ver CompressAnimationClip)
+	void bind(const CompressedClip* boundClip, const vector<int32_t>& poseNodes) {
+		clip = nullptr;
+		compressed = boundClip;
+		bindChannels(compressed ? &compressed->channelForNode : nullptr, poseNodes);
+	}
+
+	bool bound() const { return clip != nullptr || compressed != nullptr; }
+	size_t size() const { return channels.size(); }
+
+	// transformación local del nodo de pose slot en el instante time (ticks); identidad si no está animado
+	glm::mat4 sample(size_t slot, float time) {
+		glm::vec3 position, scale;
+		glm::quat rotation;
+		if (!sampleLocal(slot, time, position, rotation, scale)) return glm::mat4(1.0f);
+		return ComposeKeyTransform(position, rotation, scale);
+	}
+
+	// lo mismo sin componer la matriz; false (y la identidad) si el nodo no está animado
+	bool sampleLocal(size_t slot, float time, glm::vec3& position, glm::quat& rotation, glm::vec3& scale) {
+		position = glm::vec3(0.0f);
+		rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		scale = glm::vec3(1.0f);
+		int32_t c = channels[slot];
+		if (c < 0) return false;
+		KeyCursor& cursor = cursors[slot];
+		if (compressed) {
+			const CompressedChannel& channel = compressed->channels[c];
+			scale = SampleCompressedVector(*compressed, channel.scale, time, cursor.scale, glm::vec3(1.0f));
+			rotation = SampleCompressedRotation(*compressed, channel.rotation, time, cursor.rotation);
+			position = SampleCompressedVector(*compressed, channel.position, time, cursor.position, glm::vec3(0.0f));
+			return true;
+		}
+		const AnimationChannel& channel = clip->channels[c];
+		float factor;
+		size_t key;
+
+		if (!channel.scales.empty()) {
+			key = AdvanceKeyCursor(channel.scaleTimes, time, cursor.scale, factor);
+			scale = LerpVectorKeys(channel.scales, key, factor);
+		}
+		if (!channel.rotations.empty()) {
+			key = AdvanceKeyCursor(channel.rotationTimes, time, cursor.rotation, factor);
+			rotation = SlerpRotationKeys(channel.rotations, key, factor);
+		}
+		if (!channel.positions.empty()) {
+			key = AdvanceKeyCursor(channel.positionTimes, time, cursor.position, factor);
+			position = LerpVectorKeys(channel.positions, key, factor);
+		}
+		return true;
+	}
+
+	// pose local de todos los nodos en el instante time, para mezclarla con otras (ver LocalPose)
+	void samplePose(float time, LocalPose& pose) {
+		if (pose.count != channels.size()) pose.reset(channels.size());
+		glm::vec3 position, scale;
+		glm::quat rotation;
+		for (size_t slot = 0; slot < channels.size(); slot++) {
+			sampleLocal(slot, time, position, rotation, scale);
+			pose.set(slot, position, rotation, scale);
+		}
+	}
+
+private:
+	const AnimationClip*  clip;
+	const CompressedClip* compressed;
+	vector<int32_t>       channels; // canal de cada nodo de pose; -1 si no está animado
+	vector<KeyCursor>     cursors;
+
+	void bindChannels(const vector<int32_t>* channelForNode, const vector<int32_t>& poseNodes) {
+		channels.assign(poseNodes.size(), -1);
+		if (channelForNode) {
+			for (size_t slot = 0; slot < poseNodes.size(); slot++) {
+				int32_t node = poseNodes[slot];
+				if (node >= 0 && (size_t)node < channelForNode->size())
+					channels[slot] = (*channelForNode)[node];
+			}
+		}
+		cursors.assign(poseNodes.size(), KeyCursor{ 0, 0, 0 });
+	}
+};
+
+#endif
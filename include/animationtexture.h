@@ -0,0 +1,143 @@
+#ifndef ANIMATIONTEXTURE_H
+#define ANIMATIONTEXTURE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <skeleton.h>
+#include <animationsampler.h>
+#include <animationcompress.h>
+#include <jobsystem.h>
+#include <shader_m.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <cmath>
+using namespace std;
+
+// texels RGBA32F por hueso y frame: las tres filas de la matriz como mat3x4
+#define ANIMATION_TEXTURE_TEXELS_PER_BONE 3
+// clips que caben en el uniform clipFrames del shader instanciado
+#define MAX_ANIMATION_TEXTURE_CLIPS 16
+
+// Frames de un clip dentro de la textura (filas consecutivas)
+struct AnimationTextureClip {
+	int firstFrame;
+	int frameCount;
+};
+
+/**
+ * @brief Paletas de huesos pre-muestreadas de todos los clips de un modelo
+ * Cada fila de la textura es un frame (los clips van uno tras otro) y cada hueso ocupa tres texels
+ * con las filas de su matriz. El shader 10_vertex_skinning-instanced.vs toma la paleta de ahí con el
+ * clip y el tiempo de cada instancia, así que un draw instanciado anima cientos de personajes sin
+ * evaluar poses ni subir uniforms por personaje. Se muestrea a una frecuencia fija sin interpolar
+ * entre frames: la frecuencia decide la calidad y la memoria (bones * 48 bytes por frame).
+ */
+class AnimationTexture {
+public:
+	GLuint                       texture;
+	int                          boneCount;
+	int                          frameCount;  // todos los clips
+	float                        sampleRate;  // frames por segundo
+	vector<AnimationTextureClip> clips;       // uno por clip del modelo
+
+	AnimationTexture() : texture(0), boneCount(0), frameCount(0), sampleRate(30.0f) {}
+	~AnimationTexture() { release(); }
+
+	AnimationTexture(const AnimationTexture&) = delete;
+	AnimationTexture& operator=(const AnimationTexture&) = delete;
+
+	/**
+	 * @brief Muestrea todos los clips a framesPerSecond y sube la textura
+	 * @param compressed Si no es nulo, las llaves se toman de ahí (ver AnimatedModel::compressedAnimations)
+	 */
+	bool bake(const Skeleton& skeleton, const vector<AnimationClip>& animations, const vector<CompressedClip>* compressed,
+		float framesPerSecond = 30.0f) {
+		release();
+		sampleRate = framesPerSecond;
+		boneCount = (int)std::min(skeleton.boneCount(), (size_t)MAX_RIGGING_BONES);
+		if (boneCount == 0 || animations.empty() || sampleRate <= 0.0f) {
+			cout << "ANIMATIONTEXTURE:: nothing to bake" << endl;
+			return false;
+		}
+		if (animations.size() > MAX_ANIMATION_TEXTURE_CLIPS)
+			cout << "ANIMATIONTEXTURE:: only the first " << MAX_ANIMATION_TEXTURE_CLIPS << " clips are baked" << endl;
+
+		size_t clipCount = std::min(animations.size(), (size_t)MAX_ANIMATION_TEXTURE_CLIPS);
+		frameCount = 0;
+		for (size_t c = 0; c < clipCount; c++) {
+			const AnimationClip& clip = animations[c];
+			double seconds = clip.ticksPerSecond > 0.0 ? clip.duration / clip.ticksPerSecond : 0.0;
+			int frames = std::max(1, (int)std::lround(seconds * sampleRate));
+			clips.push_back(AnimationTextureClip{ frameCount, frames });
+			frameCount += frames;
+		}
+
+		GLint maxSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+		int width = boneCount * ANIMATION_TEXTURE_TEXELS_PER_BONE;
+		if (frameCount > maxSize || width > maxSize) {
+			cout << "ANIMATIONTEXTURE:: " << width << "x" << frameCount << " exceeds GL_MAX_TEXTURE_SIZE " << maxSize
+				<< ", lower the sample rate" << endl;
+			clips.clear();
+			return false;
+		}
+
+		// cada clip en su trabajo: su muestreador avanza los cursores en orden, frame tras frame
+		vector<glm::vec4> texels((size_t)width * frameCount);
+		JobSystem::instance().parallelFor(clipCount, [&](size_t c) {
+			PoseSampler sampler;
+			if (compressed && c < compressed->size()) sampler.bind(&(*compressed)[c], skeleton.poseNodes);
+			else sampler.bind(&animations[c], skeleton.poseNodes);
+			vector<glm::mat4> poseGlobals;
+			vector<glm::mat4> palette(boneCount, glm::mat4(1.0f));
+			double ticksPerFrame = animations[c].ticksPerSecond / sampleRate;
+			for (int f = 0; f < clips[c].frameCount; f++) {
+				skeleton.computePalette(sampler, (float)(f * ticksPerFrame), poseGlobals, palette.data(), palette.size());
+				glm::vec4* row = &texels[(size_t)(clips[c].firstFrame + f) * width];
+				for (int b = 0; b < boneCount; b++)
+					for (int r = 0; r < ANIMATION_TEXTURE_TEXELS_PER_BONE; r++)
+						row[b * ANIMATION_TEXTURE_TEXELS_PER_BONE + r] = glm::vec4(palette[b][0][r], palette[b][1][r], palette[b][2][r], palette[b][3][r]);
+			}
+		});
+
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, frameCount, 0, GL_RGBA, GL_FLOAT, texels.data());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		cout << "ANIMATIONTEXTURE:: " << clipCount << " clips, " << frameCount << " frames at " << sampleRate << " fps, "
+			<< boneCount << " bones, " << texels.size() * sizeof(glm::vec4) / 1024 << " KB" << endl;
+		return true;
+	}
+
+	bool valid() const { return texture != 0; }
+
+	// enlaza la textura en unit y llena los uniforms del shader instanciado
+	void bind(const Shader& shader, unsigned int unit) const {
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glActiveTexture(GL_TEXTURE0);
+		shader.setInt("boneTexture", (int)unit);
+		shader.setFloat("animationSampleRate", sampleRate);
+		for (size_t c = 0; c < clips.size(); c++)
+			glUniform2i(glGetUniformLocation(shader.ID, ("clipFrames[" + std::to_string(c) + "]").c_str()),
+				clips[c].firstFrame, clips[c].frameCount);
+	}
+
+	void release() {
+		if (texture) glDeleteTextures(1, &texture);
+		texture = 0;
+		clips.clear();
+		frameCount = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef BONEINFLUENCE_H
+#define BONEINFLUENCE_H
+
+#include <assimp/scene.h>
+
+#include <mesh.h>
+
+#include <vector>
+#include <iostream>
+using namespace std;
+
+// influencias por vértice que caben en Vertex (IDs1..3 / Weights1..3)
+#define MAX_VERTEX_INFLUENCES (3 * MAX_NUM_BONES)
+
+/**
+ * @brief Estadísticas de las influencias de hueso de una malla
+ */
+struct BoneInfluenceStats {
+	unsigned int vertexCount;
+	unsigned int influencedVertices;  // vértices con al menos un peso
+	unsigned int maxInfluences;       // máximo de pesos que llegaban a un mismo vértice (antes de recortar)
+	unsigned int droppedWeights;      // pesos descartados por exceder el límite
+	float        maxDroppedWeight;    // mayor peso descartado (antes de renormalizar)
+
+	BoneInfluenceStats() : vertexCount(0), influencedVertices(0), maxInfluences(0),
+		droppedWeights(0), maxDroppedWeight(0.0f) {}
+};
+
+inline ostream& operator<<(ostream& os, const BoneInfluenceStats& s) {
+	return os << s.influencedVertices << "/" << s.vertexCount << " skinned vertices, max influences: "
+		<< s.maxInfluences << ", dropped weights: " << s.droppedWeights
+		<< " (largest " << s.maxDroppedWeight << ")";
+}
+
+/**
+ * @brief Construye las influencias de hueso por dispersión (scatter)
+ * Recorre una sola vez los pesos de cada hueso y los reparte a su vértice, conservando
+ * las N influencias más fuertes. El costo es O(vértices + pesos) en lugar de
+ * O(vértices x pesos) como al buscar el VertexID de cada vértice en todos los huesos.
+ */
+class BoneInfluenceBuilder {
+public:
+	BoneInfluenceBuilder(unsigned int numVertices, unsigned int maxPerVertex = MAX_VERTEX_INFLUENCES)
+		: maxInfluences(maxPerVertex > MAX_VERTEX_INFLUENCES ? MAX_VERTEX_INFLUENCES : maxPerVertex),
+		  boneIds((size_t)numVertices * maxInfluences, 0),
+		  weights((size_t)numVertices * maxInfluences, 0.0f),
+		  counts(numVertices, 0),
+		  received(numVertices, 0) {
+		stats.vertexCount = numVertices;
+	}
+
+	/**
+	 * @brief Agrega todos los pesos de los huesos de un aiMesh
+	 */
+	void addMesh(const aiMesh* mesh) {
+		for (unsigned int b = 0; b < mesh->mNumBones; b++) {
+			const aiBone* bone = mesh->mBones[b];
+			for (unsigned int w = 0; w < bone->mNumWeights; w++)
+				add(bone->mWeights[w].mVertexId, b, (float)bone->mWeights[w].mWeight);
+		}
+	}
+
+	void add(unsigned int vertex, unsigned int bone, float weight) {
+		if (vertex >= counts.size() || weight <= 0.0f) return;
+
+		unsigned int seen = ++received[vertex];
+		if (seen > stats.maxInfluences) stats.maxInfluences = seen;
+
+		size_t base = (size_t)vertex * maxInfluences;
+		if (counts[vertex] < maxInfluences) {
+			boneIds[base + counts[vertex]] = bone;
+			weights[base + counts[vertex]] = weight;
+			counts[vertex]++;
+			return;
+		}
+
+		// Lleno: reemplazar la influencia más débil si la nueva es mayor
+		unsigned int weakest = 0;
+		for (unsigned int i = 1; i < maxInfluences; i++) {
+			if (weights[base + i] < weights[base + weakest]) weakest = i;
+		}
+		float dropped = weight;
+		if (weight > weights[base + weakest]) {
+			dropped = weights[base + weakest];
+			boneIds[base + weakest] = bone;
+			weights[base + weakest] = weight;
+		}
+		stats.droppedWeights++;
+		if (dropped > stats.maxDroppedWeight) stats.maxDroppedWeight = dropped;
+	}
+
+	/**
+	 * @brief Ordena las influencias de mayor a menor y las renormaliza para que sumen 1
+	 */
+	void finalize() {
+		stats.influencedVertices = 0;
+		for (size_t v = 0; v < counts.size(); v++) {
+			unsigned int n = counts[v];
+			if (n == 0) continue;
+			stats.influencedVertices++;
+
+			size_t base = v * maxInfluences;
+			// inserción: n <= 12
+			for (unsigned int i = 1; i < n; i++) {
+				unsigned int id = boneIds[base + i];
+				float w = weights[base + i];
+				unsigned int j = i;
+				while (j > 0 && weights[base + j - 1] < w) {
+					boneIds[base + j] = boneIds[base + j - 1];
+					weights[base + j] = weights[base + j - 1];
+					j--;
+				}
+				boneIds[base + j] = id;
+				weights[base + j] = w;
+			}
+
+			float sum = 0.0f;
+			for (unsigned int i = 0; i < n; i++) sum += weights[base + i];
+			if (sum > 0.0f) {
+				float inv = 1.0f / sum;
+				for (unsigned int i = 0; i < n; i++) weights[base + i] *= inv;
+			}
+		}
+	}
+
+	/**
+	 * @brief Escribe las influencias del vértice en IDs1..3 / Weights1..3
+	 */
+	void pack(unsigned int vertex, Vertex& out) const {
+		glm::vec4* ids[3] = { &out.IDs1, &out.IDs2, &out.IDs3 };
+		glm::vec4* ws[3] = { &out.Weights1, &out.Weights2, &out.Weights3 };
+		size_t base = (size_t)vertex * maxInfluences;
+		unsigned int n = vertex < counts.size() ? counts[vertex] : 0;
+		for (unsigned int i = 0; i < MAX_VERTEX_INFLUENCES; i++) {
+			bool used = i < n;
+			(*ids[i / MAX_NUM_BONES])[i % MAX_NUM_BONES] = used ? (float)boneIds[base + i] : 0.0f;
+			(*ws[i / MAX_NUM_BONES])[i % MAX_NUM_BONES] = used ? weights[base + i] : 0.0f;
+		}
+	}
+
+	unsigned int influenceCount(unsigned int vertex) const { return counts[vertex]; }
+	unsigned int boneId(unsigned int vertex, unsigned int slot) const { return boneIds[(size_t)vertex * maxInfluences + slot]; }
+	float weight(unsigned int vertex, unsigned int slot) const { return weights[(size_t)vertex * maxInfluences + slot]; }
+	const BoneInfluenceStats& getStats() const { return stats; }
+
+private:
+	unsigned int          maxInfluences;
+	vector<unsigned int>  boneIds;
+	vector<float>         weights;
+	vector<unsigned char> counts;
+	vector<unsigned int>  received;
+	BoneInfluenceStats    stats;
+};
+
+#endif
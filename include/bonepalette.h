@@ -0,0 +1,94 @@
+#ifndef BONEPALETTE_H
+#define BONEPALETTE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <skeleton.h>
+#include <shader_m.h>
+
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+// punto de enlace del bloque BonePalette de los shaders de skinning
+#define BONE_PALETTE_BINDING 0
+// vec4 por hueso: las tres filas de la matriz como mat3x4 (la cuarta siempre es 0,0,0,1)
+#define BONE_PALETTE_ROWS_PER_BONE 3
+
+/**
+ * @brief Paleta de huesos de un personaje en un uniform buffer
+ * Sólo guarda los huesos que tiene el esqueleto, cada uno como mat3x4 (48 bytes en lugar de los 64
+ * de un mat4), y sólo se vuelve a subir cuando cambia la versión de la pose: un personaje quieto o
+ * que el SignificanceManager no actualizó este cuadro no sube nada. El shader la lee del bloque
+ *     layout(std140) uniform BonePalette { vec4 gBoneRows[300]; };
+ * con las filas del hueso i en gBoneRows[i * 3 .. i * 3 + 2].
+ */
+class BonePaletteBuffer {
+public:
+	BonePaletteBuffer() : buffer(0), boneCount(0), uploadedVersion(0), hasUpload(false) {}
+	~BonePaletteBuffer() { release(); }
+
+	BonePaletteBuffer(const BonePaletteBuffer&) = delete;
+	BonePaletteBuffer& operator=(const BonePaletteBuffer&) = delete;
+
+	/**
+	 * @brief Sube la paleta si version es distinta de la última subida
+	 * @param count Huesos del esqueleto (se recorta a MAX_RIGGING_BONES)
+	 * @return true si hubo que subirla
+	 */
+	bool upload(const glm::mat4* palette, size_t count, unsigned int version) {
+		count = std::min(count, (size_t)MAX_RIGGING_BONES);
+		if (count == 0) return false;
+		if (!buffer) {
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			// el bloque del shader declara MAX_RIGGING_BONES huesos: el buffer enlazado debe cubrirlo entero
+			glBufferData(GL_UNIFORM_BUFFER, (GLsizeiptr)(MAX_RIGGING_BONES * BONE_PALETTE_ROWS_PER_BONE * sizeof(glm::vec4)), nullptr, GL_DYNAMIC_DRAW);
+		}
+		else if (hasUpload && version == uploadedVersion && count == boneCount) {
+			return false;
+		}
+		else {
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+		}
+
+		rows.resize(count * BONE_PALETTE_ROWS_PER_BONE);
+		for (size_t b = 0; b < count; b++)
+			for (int r = 0; r < BONE_PALETTE_ROWS_PER_BONE; r++)
+				rows[b * BONE_PALETTE_ROWS_PER_BONE + r] = glm::vec4(palette[b][0][r], palette[b][1][r], palette[b][2][r], palette[b][3][r]);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, (GLsizeiptr)(rows.size() * sizeof(glm::vec4)), rows.data());
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+		boneCount = count;
+		uploadedVersion = version;
+		hasUpload = true;
+		return true;
+	}
+
+	// enlaza el buffer al bloque BonePalette de shader para el siguiente draw
+	void bind(const Shader& shader) const {
+		GLuint block = glGetUniformBlockIndex(shader.ID, "BonePalette");
+		if (block == GL_INVALID_INDEX || !buffer) return;
+		glUniformBlockBinding(shader.ID, block, BONE_PALETTE_BINDING);
+		glBindBufferBase(GL_UNIFORM_BUFFER, BONE_PALETTE_BINDING, buffer);
+	}
+
+	// obliga a subir la paleta en el siguiente upload (p. ej. si cambió de dónde viene la pose)
+	void invalidate() { hasUpload = false; }
+
+	void release() {
+		if (buffer) glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		hasUpload = false;
+	}
+
+private:
+	GLuint            buffer;
+	size_t            boneCount;
+	unsigned int      uploadedVersion;
+	bool              hasUpload;
+	vector<glm::vec4> rows; // memoria de trabajo de upload
+};
+
+#endif
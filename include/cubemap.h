@@ -15,6 +15,7 @@
 #include <vector>
 #include <stdlib.h>
 #include <shader_m.h>
+#include <texturecache.h>
 
 using namespace std;
 
@@ -82,37 +83,15 @@ public:
 	}
 
 	~CubeMap() {
-	
+        if (textureID != 0) TextureCache::instance().release(textureID);
 	}
 
+    // las seis caras se decodifican en paralelo; mientras tanto el cubemap es gris.
+    // Otro CubeMap con las mismas caras comparte la textura.
     void loadCubemap(vector<std::string> faces)
     {
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-        int width, height, nrChannels;
-        for (unsigned int i = 0; i < faces.size(); i++)
-        {
-            unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-            if (data)
-            {
-                glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                    0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data
-                );
-                stbi_image_free(data);
-            }
-            else
-            {
-                std::cout << "Cubemap tex failed to load at path: " << faces[i] << std::endl;
-                stbi_image_free(data);
-            }
-        }
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
+        if (textureID != 0) TextureCache::instance().release(textureID);
+        textureID = TextureCache::instance().acquireCubemap(faces);
     }
 
     void drawCubeMap(Shader &shad, glm::mat4 &projection, glm::mat4 &view) {
@@ -0,0 +1,294 @@
+#ifndef GEOMETRYPOOL_H
+#define GEOMETRYPOOL_H
+
+#include <glad/glad.h>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief Asignador de rangos con lista libre (primer ajuste)
+ * Administra unidades abstractas (vértices o bytes); los huecos contiguos se fusionan al liberar.
+ */
+class RangeAllocator {
+public:
+	static const size_t npos = (size_t)-1;
+
+	RangeAllocator() : capacity(0) {}
+
+	size_t getCapacity() const { return capacity; }
+
+	size_t allocate(size_t size, size_t alignment = 1) {
+		if (size == 0) size = 1;
+		for (size_t i = 0; i < freeRanges.size(); i++) {
+			Range r = freeRanges[i];
+			size_t start = (r.offset + alignment - 1) / alignment * alignment;
+			size_t pad = start - r.offset;
+			if (r.size < pad + size) continue;
+
+			freeRanges.erase(freeRanges.begin() + i);
+			// lo que sobra antes (alineación) y después vuelve a la lista
+			if (r.size > pad + size) insertFree(start + size, r.size - pad - size);
+			if (pad > 0) insertFree(r.offset, pad);
+			return start;
+		}
+		return npos;
+	}
+
+	void free(size_t offset, size_t size) {
+		if (size == 0) size = 1;
+		insertFree(offset, size);
+	}
+
+	// agrega [capacity, newCapacity) al final del espacio libre
+	void grow(size_t newCapacity) {
+		if (newCapacity <= capacity) return;
+		insertFree(capacity, newCapacity - capacity);
+		capacity = newCapacity;
+	}
+
+private:
+	struct Range {
+		size_t offset;
+		size_t size;
+	};
+	vector<Range> freeRanges; // ordenados por offset, nunca adyacentes
+	size_t capacity;
+
+	void insertFree(size_t offset, size_t size) {
+		size_t i = 0;
+		while (i < freeRanges.size() && freeRanges[i].offset < offset) i++;
+		freeRanges.insert(freeRanges.begin() + i, Range{ offset, size });
+		// fusionar con el siguiente y con el anterior
+		if (i + 1 < freeRanges.size() && freeRanges[i].offset + freeRanges[i].size == freeRanges[i + 1].offset) {
+			freeRanges[i].size += freeRanges[i + 1].size;
+			freeRanges.erase(freeRanges.begin() + i + 1);
+		}
+		if (i > 0 && freeRanges[i - 1].offset + freeRanges[i - 1].size == freeRanges[i].offset) {
+			freeRanges[i - 1].size += freeRanges[i].size;
+			freeRanges.erase(freeRanges.begin() + i);
+		}
+	}
+};
+
+// índices de 16 bits siempre que la malla tenga menos de 65536 vértices
+inline GLenum SmallestIndexType(size_t vertexCount) {
+	return vertexCount <= 0xFFFFu ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+inline size_t IndexTypeSize(GLenum indexType) {
+	return indexType == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+
+/**
+ * @brief Ubicación de una malla dentro del pool
+ * Se dibuja con glDrawElementsBaseVertex(count, indexType, indexOffset, baseVertex).
+ */
+struct GeometryRange {
+	unsigned int format;      // VertexFormat
+	GLint        baseVertex;
+	unsigned int vertexCount;
+	size_t       indexOffset; // en bytes dentro del buffer de índices
+	unsigned int indexCount;
+	GLenum       indexType;   // GL_UNSIGNED_INT o GL_UNSIGNED_SHORT
+
+	GeometryRange() : format(0), baseVertex(-1), vertexCount(0), indexOffset(0), indexCount(0), indexType(GL_UNSIGNED_INT) {}
+
+	bool valid() const { return baseVertex >= 0; }
+
+	size_t indexBytes() const {
+		return (size_t)indexCount * IndexTypeSize(indexType);
+	}
+};
+
+// Un nivel de detalle dentro de los índices de una malla
+struct MeshLod {
+	unsigned int firstIndex;
+	unsigned int indexCount;
+	float        error; // desviación geométrica máxima respecto a LOD0, en unidades del modelo
+};
+
+/**
+ * @brief Pool global de geometría
+ * Todas las mallas de un mismo formato de vértice comparten un VBO, un EBO y un VAO, así que
+ * dibujar un modelo completo cambia de VAO una sola vez. Los buffers crecen al doble copiando
+ * el contenido en la GPU (glCopyBufferSubData) y los rangos liberados se reutilizan.
+ * Sólo se usa desde el hilo del contexto de GL.
+ */
+class GeometryPool {
+public:
+	static GeometryPool& instance() {
+		static GeometryPool pool;
+		return pool;
+	}
+
+	/**
+	 * @brief Copia vértices e índices de una malla al pool
+	 * @param indexData Índices de 16 o 32 bits según indexType
+	 */
+	template <typename VertexT>
+	GeometryRange allocate(const VertexT* vertexData, size_t vertexCount, const void* indexData, size_t indexCount, GLenum indexType = GL_UNSIGNED_INT) {
+		Arena& arena = getArena(VertexT::format(), sizeof(VertexT), &VertexT::setupAttributes);
+
+		GeometryRange range;
+		range.format = VertexT::format();
+		range.vertexCount = (unsigned int)vertexCount;
+		range.indexCount = (unsigned int)indexCount;
+		range.indexType = indexType;
+
+		size_t vertexOffset = allocateIn(arena, arena.vertices, vertexCount, 1, true);
+		range.indexOffset = allocateIn(arena, arena.indices, range.indexBytes(), 4, false);
+		range.baseVertex = (GLint)vertexOffset;
+
+		glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)(vertexOffset * arena.stride), (GLsizeiptr)(vertexCount * arena.stride), vertexData);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		// el EBO es estado del VAO: se escribe por GL_COPY_WRITE_BUFFER para no tocar ningún VAO
+		glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+		glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)range.indexOffset, (GLsizeiptr)range.indexBytes(), indexData);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		return range;
+	}
+
+	// devuelve el rango a la lista libre; los datos quedan en la GPU hasta que se reutilice
+	void free(GeometryRange& range) {
+		if (!range.valid() || range.format >= arenas.size() || arenas[range.format].vao == 0) return;
+		Arena& arena = arenas[range.format];
+		arena.vertices.free((size_t)range.baseVertex, range.vertexCount);
+		arena.indices.free(range.indexOffset, range.indexBytes());
+		range = GeometryRange();
+	}
+
+	// enlaza el VAO del formato sólo si no es el que ya está enlazado
+	void bind(unsigned int format) {
+		if (format >= arenas.size()) return;
+		GLuint vao = arenas[format].vao;
+		if (vao != boundVAO) {
+			glBindVertexArray(vao);
+			boundVAO = vao;
+		}
+	}
+
+	// buffer de índices del formato, 0 si no hay mallas de ese formato; cambia cuando el pool crece,
+	// así que quien lo enlace en su propio VAO debe volver a pedirlo si cambia bufferGeneration
+	GLuint indexBuffer(unsigned int format) const {
+		return format < arenas.size() ? arenas[format].ebo : 0;
+	}
+
+	// aumenta cada vez que se crean los buffers del formato o alguno crece; el nombre de GL del buffer
+	// no sirve para detectarlo porque el nuevo puede reutilizar el de uno borrado
+	unsigned int bufferGeneration(unsigned int format) const {
+		return format < arenas.size() ? arenas[format].generation : 0;
+	}
+
+	// deja el estado limpio después de una serie de draws (otro código puede enlazar sus VAOs)
+	void unbind() {
+		glBindVertexArray(0);
+		boundVAO = 0;
+	}
+
+	void draw(const GeometryRange& range) {
+		draw(range, 0, range.indexCount);
+	}
+
+	// dibuja sólo [firstIndex, firstIndex + count) de los índices del rango (p. ej. un LOD);
+	// con instanceCount > 1 es un solo draw instanciado (el shader usa gl_InstanceID)
+	void draw(const GeometryRange& range, unsigned int firstIndex, unsigned int count, GLsizei instanceCount = 1) {
+		if (!range.valid() || instanceCount <= 0) return;
+		bind(range.format);
+		void* offset = (void*)(range.indexOffset + (size_t)firstIndex * IndexTypeSize(range.indexType));
+		if (instanceCount == 1)
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)count, range.indexType, offset, range.baseVertex);
+		else
+			glDrawElementsInstancedBaseVertex(GL_TRIANGLES, (GLsizei)count, range.indexType, offset, instanceCount, range.baseVertex);
+	}
+
+private:
+	// vértices/índices iniciales por formato; se duplican al llenarse
+	static const size_t INITIAL_VERTICES = 1 << 16;
+	static const size_t INITIAL_INDEX_BYTES = 1 << 20;
+
+	struct Arena {
+		GLuint vao, vbo, ebo;
+		size_t stride;
+		void (*setupAttributes)();
+		RangeAllocator vertices; // en vértices
+		RangeAllocator indices;  // en bytes
+		unsigned int generation; // ver bufferGeneration
+
+		Arena() : vao(0), vbo(0), ebo(0), stride(0), setupAttributes(nullptr), generation(0) {}
+	};
+	vector<Arena> arenas; // indexado por VertexFormat
+	GLuint boundVAO;
+
+	GeometryPool() : boundVAO(0) {}
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+
+	Arena& getArena(unsigned int format, size_t stride, void (*setupAttributes)()) {
+		if (format >= arenas.size()) arenas.resize(format + 1);
+		Arena& arena = arenas[format];
+		if (arena.vao != 0) return arena;
+
+		arena.stride = stride;
+		arena.setupAttributes = setupAttributes;
+		glGenVertexArrays(1, &arena.vao);
+		glGenBuffers(1, &arena.vbo);
+		glGenBuffers(1, &arena.ebo);
+		glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(INITIAL_VERTICES * stride), nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, arena.ebo);
+		glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)INITIAL_INDEX_BYTES, nullptr, GL_STATIC_DRAW);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		arena.vertices.grow(INITIAL_VERTICES);
+		arena.indices.grow(INITIAL_INDEX_BYTES);
+		setupVertexArray(arena);
+		return arena;
+	}
+
+	// también al crecer un buffer: cuenta como una generación nueva
+	void setupVertexArray(Arena& arena) {
+		arena.generation++;
+		glBindVertexArray(arena.vao);
+		glBindBuffer(GL_ARRAY_BUFFER, arena.vbo);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.ebo);
+		arena.setupAttributes();
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		boundVAO = 0;
+	}
+
+	size_t allocateIn(Arena& arena, RangeAllocator& allocator, size_t size, size_t alignment, bool vertexBuffer) {
+		size_t offset = allocator.allocate(size, alignment);
+		while (offset == RangeAllocator::npos) {
+			size_t unit = vertexBuffer ? arena.stride : 1;
+			size_t oldCapacity = allocator.getCapacity();
+			size_t newCapacity = oldCapacity * 2;
+			while (newCapacity < oldCapacity + size + alignment) newCapacity *= 2;
+			cout << "GEOMETRYPOOL:: growing " << (vertexBuffer ? "vertex" : "index") << " buffer of format "
+				<< (&arena - arenas.data()) << " to " << newCapacity * unit / 1024 << " KB" << endl;
+
+			GLuint& buffer = vertexBuffer ? arena.vbo : arena.ebo;
+			GLuint grown;
+			glGenBuffers(1, &grown);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+			glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(newCapacity * unit), nullptr, GL_STATIC_DRAW);
+			glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)(oldCapacity * unit));
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glDeleteBuffers(1, &buffer);
+			buffer = grown;
+
+			allocator.grow(newCapacity);
+			setupVertexArray(arena);
+			offset = allocator.allocate(size, alignment);
+		}
+		return offset;
+	}
+};
+
+#endif
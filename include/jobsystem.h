@@ -0,0 +1,129 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <algorithm>
+
+/**
+ * @brief Pool de hilos de trabajo compartido por todo el proceso
+ * Se usa para el trabajo de CPU de la carga (conversión de mallas, decodificación, etc.).
+ * Nunca se debe llamar a OpenGL desde un trabajo: el contexto sólo vive en el hilo principal.
+ */
+class JobSystem {
+public:
+	static JobSystem& instance() {
+		static JobSystem system;
+		return system;
+	}
+
+	size_t workerCount() const { return workers.size(); }
+
+	/**
+	 * @brief Encola un trabajo y regresa un future para esperarlo
+	 */
+	std::future<void> submit(std::function<void()> job) {
+		auto task = std::make_shared<std::packaged_task<void()>>(std::move(job));
+		std::future<void> result = task->get_future();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.push_back([task]() { (*task)(); });
+		}
+		available.notify_one();
+		return result;
+	}
+
+	/**
+	 * @brief Ejecuta fn(i) para i en [0, count) repartido entre los hilos y espera a que terminen
+	 * El hilo que llama también trabaja, así que no hay bloqueo aunque se llame desde un trabajo.
+	 */
+	void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+		if (count == 0) return;
+		if (count == 1 || workers.empty()) {
+			for (size_t i = 0; i < count; i++) fn(i);
+			return;
+		}
+
+		struct Batch {
+			std::atomic<size_t> next;
+			std::atomic<size_t> done;
+			std::mutex m;
+			std::condition_variable finished;
+		};
+		auto batch = std::make_shared<Batch>();
+		batch->next = 0;
+		batch->done = 0;
+
+		auto drain = [batch, count, &fn]() {
+			size_t i;
+			while ((i = batch->next.fetch_add(1)) < count) {
+				fn(i);
+				if (batch->done.fetch_add(1) + 1 == count) {
+					std::lock_guard<std::mutex> lock(batch->m);
+					batch->finished.notify_all();
+				}
+			}
+		};
+
+		size_t helpers = std::min(workers.size(), count - 1);
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (size_t h = 0; h < helpers; h++) queue.push_back(drain);
+		}
+		available.notify_all();
+
+		drain();
+
+		std::unique_lock<std::mutex> lock(batch->m);
+		batch->finished.wait(lock, [&]() { return batch->done.load() == count; });
+	}
+
+	~JobSystem() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		available.notify_all();
+		for (std::thread& t : workers) t.join();
+	}
+
+private:
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> queue;
+	std::mutex mutex;
+	std::condition_variable available;
+	bool stopping;
+
+	JobSystem() : stopping(false) {
+		unsigned int hw = std::thread::hardware_concurrency();
+		unsigned int count = hw > 1 ? hw - 1 : 1; // se deja un núcleo para el hilo de GL
+		for (unsigned int i = 0; i < count; i++)
+			workers.emplace_back([this]() { workerLoop(); });
+	}
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	void workerLoop() {
+		for (;;) {
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				available.wait(lock, [this]() { return stopping || !queue.empty(); });
+				if (stopping && queue.empty()) return;
+				job = std::move(queue.front());
+				queue.pop_front();
+			}
+			job();
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef LOADPROFILER_H
+#define LOADPROFILER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+using namespace std;
+
+// Tipos de bytes que se cuentan por etapa
+enum LoadBytesKind {
+	LOAD_BYTES_FILE,    // leídos del disco
+	LOAD_BYTES_VERTEX,  // subidos a buffers de vértices
+	LOAD_BYTES_INDEX,   // subidos a buffers de índices
+	LOAD_BYTES_TEXTURE, // pixeles decodificados o subidos
+	LOAD_BYTES_KIND_COUNT
+};
+
+/**
+ * @brief Tiempos de carga por recurso y por etapa
+ * Cada medición se acumula bajo (ruta del recurso, etapa): número de llamadas, segundos y bytes por
+ * tipo. Se puede usar desde cualquier hilo. print() muestra la tabla y writeJSON() la guarda para
+ * comparar antes y después de una optimización.
+ */
+class LoadProfiler {
+public:
+	struct StageStats {
+		unsigned int calls;
+		double       seconds; // suma; en etapas que corren en paralelo puede pasar del tiempo de reloj
+		size_t       bytes[LOAD_BYTES_KIND_COUNT];
+
+		StageStats() : calls(0), seconds(0.0), bytes() {}
+
+		size_t totalBytes() const {
+			size_t total = 0;
+			for (size_t b : bytes) total += b;
+			return total;
+		}
+
+		double bytesPerSecond() const {
+			return seconds > 0.0 ? (double)totalBytes() / seconds : 0.0;
+		}
+	};
+
+	static LoadProfiler& instance() {
+		static LoadProfiler profiler;
+		return profiler;
+	}
+
+	void record(const string& asset, const string& stage, double seconds, const size_t* bytes = nullptr) {
+		if (!enabled) return;
+		lock_guard<mutex> lock(statsMutex);
+		StageStats& stats = assets[asset][stage];
+		stats.calls++;
+		stats.seconds += seconds;
+		if (bytes)
+			for (int k = 0; k < LOAD_BYTES_KIND_COUNT; k++) stats.bytes[k] += bytes[k];
+	}
+
+	void setEnabled(bool value) { enabled = value; }
+	bool isEnabled() const { return enabled; }
+
+	void reset() {
+		lock_guard<mutex> lock(statsMutex);
+		assets.clear();
+	}
+
+	// tabla por recurso y etapa, con el total de cada etapa al final
+	void print() {
+		lock_guard<mutex> lock(statsMutex);
+		map<string, StageStats> totals = stageTotals();
+		cout << "LOADPROFILER:: per asset" << endl;
+		for (const auto& asset : assets) {
+			cout << "  " << asset.first << endl;
+			for (const auto& stage : asset.second) printStage(stage.first, stage.second);
+		}
+		cout << "LOADPROFILER:: per stage" << endl;
+		for (const auto& stage : totals) printStage(stage.first, stage.second);
+	}
+
+	bool writeJSON(const string& path) {
+		lock_guard<mutex> lock(statsMutex);
+		// fopen está marcado como inseguro con /sdl
+#ifdef _MSC_VER
+		FILE* file = nullptr;
+		if (fopen_s(&file, path.c_str(), "w") != 0) file = nullptr;
+#else
+		FILE* file = fopen(path.c_str(), "w");
+#endif
+		if (!file) {
+			cout << "LOADPROFILER:: could not write " << path << endl;
+			return false;
+		}
+		fprintf(file, "{\n  \"assets\": [");
+		bool firstAsset = true;
+		for (const auto& asset : assets) {
+			fprintf(file, "%s\n    { \"path\": \"%s\", \"stages\": [", firstAsset ? "" : ",", escape(asset.first).c_str());
+			writeStages(file, asset.second, "      ");
+			fprintf(file, "] }");
+			firstAsset = false;
+		}
+		fprintf(file, "\n  ],\n  \"stages\": [");
+		writeStages(file, stageTotals(), "    ");
+		fprintf(file, "]\n}\n");
+		fclose(file);
+		cout << "LOADPROFILER:: wrote " << path << endl;
+		return true;
+	}
+
+private:
+	map<string, map<string, StageStats>> assets; // ordenados para que dos corridas se puedan comparar con diff
+	mutex statsMutex;
+	bool enabled;
+
+	LoadProfiler() : enabled(true) {}
+	LoadProfiler(const LoadProfiler&) = delete;
+	LoadProfiler& operator=(const LoadProfiler&) = delete;
+
+	static const char* kindName(int kind) {
+		static const char* names[LOAD_BYTES_KIND_COUNT] = { "file", "vertex", "index", "texture" };
+		return names[kind];
+	}
+
+	map<string, StageStats> stageTotals() const {
+		map<string, StageStats> totals;
+		for (const auto& asset : assets) {
+			for (const auto& stage : asset.second) {
+				StageStats& total = totals[stage.first];
+				total.calls += stage.second.calls;
+				total.seconds += stage.second.seconds;
+				for (int k = 0; k < LOAD_BYTES_KIND_COUNT; k++) total.bytes[k] += stage.second.bytes[k];
+			}
+		}
+		return totals;
+	}
+
+	static void printStage(const string& name, const StageStats& stats) {
+		char line[256];
+		snprintf(line, sizeof(line), "    %-20s %4u x %9.2f ms", name.c_str(), stats.calls, stats.seconds * 1000.0);
+		cout << line;
+		for (int k = 0; k < LOAD_BYTES_KIND_COUNT; k++)
+			if (stats.bytes[k] > 0) cout << "  " << kindName(k) << " " << stats.bytes[k] / 1024 << " KB";
+		if (stats.totalBytes() > 0) {
+			snprintf(line, sizeof(line), "  (%.1f MB/s)", stats.bytesPerSecond() / (1024.0 * 1024.0));
+			cout << line;
+		}
+		cout << endl;
+	}
+
+	static void writeStages(FILE* file, const map<string, StageStats>& stages, const char* indent) {
+		bool first = true;
+		for (const auto& stage : stages) {
+			const StageStats& s = stage.second;
+			fprintf(file, "%s\n%s{ \"stage\": \"%s\", \"calls\": %u, \"ms\": %.3f", first ? "" : ",", indent,
+				escape(stage.first).c_str(), s.calls, s.seconds * 1000.0);
+			for (int k = 0; k < LOAD_BYTES_KIND_COUNT; k++)
+				fprintf(file, ", \"%sBytes\": %llu", kindName(k), (unsigned long long)s.bytes[k]);
+			fprintf(file, ", \"bytesPerSecond\": %.0f }", s.bytesPerSecond());
+			first = false;
+		}
+	}
+
+	static string escape(const string& text) {
+		string out;
+		for (char c : text) {
+			if (c == '"' || c == '\\') { out += '\\'; out += c; }
+			else if ((unsigned char)c < 0x20) out += ' ';
+			else out += c;
+		}
+		return out;
+	}
+};
+
+/**
+ * @brief Mide el tiempo de vida del objeto y lo registra al destruirse
+ * Uso: { ScopedLoadTimer t(path, "stbi_load"); ...; t.addBytes(LOAD_BYTES_TEXTURE, n); }
+ */
+class ScopedLoadTimer {
+public:
+	ScopedLoadTimer(const string& asset, const char* stage)
+		: asset(asset), stage(stage), bytes(), begin(chrono::steady_clock::now()) {}
+
+	~ScopedLoadTimer() {
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+		LoadProfiler::instance().record(asset, stage, seconds, bytes);
+	}
+
+	void addBytes(LoadBytesKind kind, size_t count) { bytes[kind] += count; }
+
+private:
+	string      asset;
+	const char* stage;
+	size_t      bytes[LOAD_BYTES_KIND_COUNT];
+	chrono::steady_clock::time_point begin;
+
+	ScopedLoadTimer(const ScopedLoadTimer&) = delete;
+	ScopedLoadTimer& operator=(const ScopedLoadTimer&) = delete;
+};
+
+#endif
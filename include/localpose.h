@@ -0,0 +1,186 @@
+#ifndef LOCALPOSE_H
+#define LOCALPOSE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cmath>
+using namespace std;
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define LOCAL_POSE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+/**
+ * @brief Pose local (traslación, rotación y escala de cada nodo de pose) en arreglos separados
+ * Cada componente es un arreglo de floats con el tamaño redondeado a múltiplo de 4, así que las
+ * mezclas trabajan de cuatro nodos a la vez con SSE y sin matrices: mezclar cuesta lo mismo por hueso
+ * sin importar cuántos clips se combinen, y las matrices se arman una sola vez en la jerarquía
+ * (Skeleton::computePalette). Los nodos de pose son los de Skeleton::poseNodes.
+ */
+struct LocalPose {
+	size_t        count;
+	vector<float> tx, ty, tz;
+	vector<float> qx, qy, qz, qw;
+	vector<float> sx, sy, sz;
+
+	LocalPose() : count(0) {}
+
+	// n nodos en la pose identidad
+	void reset(size_t n) {
+		count = n;
+		size_t padded = (n + 3) & ~(size_t)3;
+		tx.assign(padded, 0.0f); ty.assign(padded, 0.0f); tz.assign(padded, 0.0f);
+		qx.assign(padded, 0.0f); qy.assign(padded, 0.0f); qz.assign(padded, 0.0f); qw.assign(padded, 1.0f);
+		sx.assign(padded, 1.0f); sy.assign(padded, 1.0f); sz.assign(padded, 1.0f);
+	}
+
+	size_t padded() const { return tx.size(); }
+
+	void set(size_t i, const glm::vec3& t, const glm::quat& q, const glm::vec3& s) {
+		tx[i] = t.x; ty[i] = t.y; tz[i] = t.z;
+		qx[i] = q.x; qy[i] = q.y; qz[i] = q.z; qw[i] = q.w;
+		sx[i] = s.x; sy[i] = s.y; sz[i] = s.z;
+	}
+
+	glm::vec3 translation(size_t i) const { return glm::vec3(tx[i], ty[i], tz[i]); }
+	glm::quat rotation(size_t i) const { return glm::quat(qw[i], qx[i], qy[i], qz[i]); }
+	glm::vec3 scale(size_t i) const { return glm::vec3(sx[i], sy[i], sz[i]); }
+};
+
+/**
+ * @brief out = mezcla de a hacia b con peso weight: lerp en traslación y escala, nlerp en rotación
+ * nlerp (lerp por el camino corto y normalizar) en lugar de slerp: entre poses cercanas la diferencia
+ * no se nota y no necesita trigonometría. out puede ser a o b.
+ */
+inline void BlendLocalPoses(const LocalPose& a, const LocalPose& b, float weight, LocalPose& out)
+{
+	if (out.padded() != a.padded()) out.reset(a.count);
+	size_t n = a.padded();
+#ifdef LOCAL_POSE_SSE
+	const __m128 w = _mm_set1_ps(weight);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	const float* av[6] = { a.tx.data(), a.ty.data(), a.tz.data(), a.sx.data(), a.sy.data(), a.sz.data() };
+	const float* bv[6] = { b.tx.data(), b.ty.data(), b.tz.data(), b.sx.data(), b.sy.data(), b.sz.data() };
+	float* ov[6] = { out.tx.data(), out.ty.data(), out.tz.data(), out.sx.data(), out.sy.data(), out.sz.data() };
+	for (size_t i = 0; i < n; i += 4) {
+		for (int c = 0; c < 6; c++) {
+			__m128 x = _mm_loadu_ps(av[c] + i);
+			__m128 y = _mm_loadu_ps(bv[c] + i);
+			_mm_storeu_ps(ov[c] + i, _mm_add_ps(x, _mm_mul_ps(_mm_sub_ps(y, x), w)));
+		}
+
+		__m128 ax = _mm_loadu_ps(&a.qx[i]), ay = _mm_loadu_ps(&a.qy[i]), az = _mm_loadu_ps(&a.qz[i]), aw = _mm_loadu_ps(&a.qw[i]);
+		__m128 bx = _mm_loadu_ps(&b.qx[i]), by = _mm_loadu_ps(&b.qy[i]), bz = _mm_loadu_ps(&b.qz[i]), bw = _mm_loadu_ps(&b.qw[i]);
+		// camino corto: se invierte b donde dot(a, b) < 0
+		__m128 dot = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_add_ps(_mm_mul_ps(az, bz), _mm_mul_ps(aw, bw)));
+		__m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, zero), signBit);
+		bx = _mm_xor_ps(bx, flip); by = _mm_xor_ps(by, flip); bz = _mm_xor_ps(bz, flip); bw = _mm_xor_ps(bw, flip);
+		__m128 x = _mm_add_ps(ax, _mm_mul_ps(_mm_sub_ps(bx, ax), w));
+		__m128 y = _mm_add_ps(ay, _mm_mul_ps(_mm_sub_ps(by, ay), w));
+		__m128 z = _mm_add_ps(az, _mm_mul_ps(_mm_sub_ps(bz, az), w));
+		__m128 s = _mm_add_ps(aw, _mm_mul_ps(_mm_sub_ps(bw, aw), w));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_add_ps(_mm_mul_ps(z, z), _mm_mul_ps(s, s))));
+		_mm_storeu_ps(&out.qx[i], _mm_div_ps(x, length));
+		_mm_storeu_ps(&out.qy[i], _mm_div_ps(y, length));
+		_mm_storeu_ps(&out.qz[i], _mm_div_ps(z, length));
+		_mm_storeu_ps(&out.qw[i], _mm_div_ps(s, length));
+	}
+#else
+	for (size_t i = 0; i < n; i++) {
+		out.tx[i] = a.tx[i] + (b.tx[i] - a.tx[i]) * weight;
+		out.ty[i] = a.ty[i] + (b.ty[i] - a.ty[i]) * weight;
+		out.tz[i] = a.tz[i] + (b.tz[i] - a.tz[i]) * weight;
+		out.sx[i] = a.sx[i] + (b.sx[i] - a.sx[i]) * weight;
+		out.sy[i] = a.sy[i] + (b.sy[i] - a.sy[i]) * weight;
+		out.sz[i] = a.sz[i] + (b.sz[i] - a.sz[i]) * weight;
+		float sign = a.qx[i] * b.qx[i] + a.qy[i] * b.qy[i] + a.qz[i] * b.qz[i] + a.qw[i] * b.qw[i] < 0.0f ? -1.0f : 1.0f;
+		float x = a.qx[i] + (sign * b.qx[i] - a.qx[i]) * weight;
+		float y = a.qy[i] + (sign * b.qy[i] - a.qy[i]) * weight;
+		float z = a.qz[i] + (sign * b.qz[i] - a.qz[i]) * weight;
+		float s = a.qw[i] + (sign * b.qw[i] - a.qw[i]) * weight;
+		float length = std::sqrt(x * x + y * y + z * z + s * s);
+		out.qx[i] = x / length; out.qy[i] = y / length; out.qz[i] = z / length; out.qw[i] = s / length;
+	}
+#endif
+}
+
+/**
+ * @brief Diferencia de una pose respecto a su pose de referencia, para capas aditivas
+ * delta = traslación - referencia, rotación * inversa(referencia), escala / referencia.
+ */
+inline void SubtractLocalPose(const LocalPose& pose, const LocalPose& reference, LocalPose& delta)
+{
+	delta.reset(pose.count);
+	for (size_t i = 0; i < pose.count; i++) {
+		glm::quat q = pose.rotation(i) * glm::inverse(reference.rotation(i));
+		glm::vec3 s = pose.scale(i) / reference.scale(i);
+		delta.set(i, pose.translation(i) - reference.translation(i), q, s);
+	}
+}
+
+/**
+ * @brief Aplica una diferencia (SubtractLocalPose) con peso weight encima de pose
+ * Traslación y escala se suman/multiplican escaladas por el peso; la rotación es
+ * nlerp(identidad, delta, weight) * rotación.
+ */
+inline void AddLocalPose(LocalPose& pose, const LocalPose& delta, float weight)
+{
+	size_t n = pose.padded();
+#ifdef LOCAL_POSE_SSE
+	const __m128 w = _mm_set1_ps(weight);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 signBit = _mm_set1_ps(-0.0f);
+	for (size_t i = 0; i < n; i += 4) {
+		_mm_storeu_ps(&pose.tx[i], _mm_add_ps(_mm_loadu_ps(&pose.tx[i]), _mm_mul_ps(_mm_loadu_ps(&delta.tx[i]), w)));
+		_mm_storeu_ps(&pose.ty[i], _mm_add_ps(_mm_loadu_ps(&pose.ty[i]), _mm_mul_ps(_mm_loadu_ps(&delta.ty[i]), w)));
+		_mm_storeu_ps(&pose.tz[i], _mm_add_ps(_mm_loadu_ps(&pose.tz[i]), _mm_mul_ps(_mm_loadu_ps(&delta.tz[i]), w)));
+		// escala: s * (1 + (d - 1) * w)
+		_mm_storeu_ps(&pose.sx[i], _mm_mul_ps(_mm_loadu_ps(&pose.sx[i]), _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&delta.sx[i]), one), w))));
+		_mm_storeu_ps(&pose.sy[i], _mm_mul_ps(_mm_loadu_ps(&pose.sy[i]), _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&delta.sy[i]), one), w))));
+		_mm_storeu_ps(&pose.sz[i], _mm_mul_ps(_mm_loadu_ps(&pose.sz[i]), _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&delta.sz[i]), one), w))));
+
+		// d = nlerp(identidad, delta, w), por el camino corto
+		__m128 dx = _mm_loadu_ps(&delta.qx[i]), dy = _mm_loadu_ps(&delta.qy[i]), dz = _mm_loadu_ps(&delta.qz[i]), dw = _mm_loadu_ps(&delta.qw[i]);
+		__m128 flip = _mm_and_ps(_mm_cmplt_ps(dw, zero), signBit);
+		dx = _mm_mul_ps(_mm_xor_ps(dx, flip), w);
+		dy = _mm_mul_ps(_mm_xor_ps(dy, flip), w);
+		dz = _mm_mul_ps(_mm_xor_ps(dz, flip), w);
+		dw = _mm_add_ps(one, _mm_mul_ps(_mm_sub_ps(_mm_xor_ps(dw, flip), one), w));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_add_ps(_mm_mul_ps(dz, dz), _mm_mul_ps(dw, dw))));
+		dx = _mm_div_ps(dx, length); dy = _mm_div_ps(dy, length); dz = _mm_div_ps(dz, length); dw = _mm_div_ps(dw, length);
+
+		// q = d * q
+		__m128 qx = _mm_loadu_ps(&pose.qx[i]), qy = _mm_loadu_ps(&pose.qy[i]), qz = _mm_loadu_ps(&pose.qz[i]), qw = _mm_loadu_ps(&pose.qw[i]);
+		__m128 rw = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(dw, qw), _mm_mul_ps(dx, qx)), _mm_add_ps(_mm_mul_ps(dy, qy), _mm_mul_ps(dz, qz)));
+		__m128 rx = _mm_sub_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dw, qx), _mm_mul_ps(dx, qw)), _mm_mul_ps(dy, qz)), _mm_mul_ps(dz, qy));
+		__m128 ry = _mm_add_ps(_mm_add_ps(_mm_sub_ps(_mm_mul_ps(dw, qy), _mm_mul_ps(dx, qz)), _mm_mul_ps(dy, qw)), _mm_mul_ps(dz, qx));
+		__m128 rz = _mm_add_ps(_mm_sub_ps(_mm_add_ps(_mm_mul_ps(dw, qz), _mm_mul_ps(dx, qy)), _mm_mul_ps(dy, qx)), _mm_mul_ps(dz, qw));
+		_mm_storeu_ps(&pose.qx[i], rx);
+		_mm_storeu_ps(&pose.qy[i], ry);
+		_mm_storeu_ps(&pose.qz[i], rz);
+		_mm_storeu_ps(&pose.qw[i], rw);
+	}
+#else
+	for (size_t i = 0; i < n; i++) {
+		pose.tx[i] += delta.tx[i] * weight;
+		pose.ty[i] += delta.ty[i] * weight;
+		pose.tz[i] += delta.tz[i] * weight;
+		pose.sx[i] *= 1.0f + (delta.sx[i] - 1.0f) * weight;
+		pose.sy[i] *= 1.0f + (delta.sy[i] - 1.0f) * weight;
+		pose.sz[i] *= 1.0f + (delta.sz[i] - 1.0f) * weight;
+		glm::quat d = delta.rotation(i);
+		if (d.w < 0.0f) d = -d;
+		d = glm::normalize(glm::quat(1.0f + (d.w - 1.0f) * weight, d.x * weight, d.y * weight, d.z * weight));
+		glm::quat q = d * pose.rotation(i);
+		pose.qx[i] = q.x; pose.qy[i] = q.y; pose.qz[i] = q.z; pose.qw[i] = q.w;
+	}
+#endif
+}
+
+#endif
@@ -7,6 +7,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <shader.h>
+#include <vertexformat.h>
+#include <geometrypool.h>
 
 #include <string>
 #include <fstream>
@@ -38,34 +40,216 @@ struct Vertex {
 	glm::vec4 Weights3;
 };
 
+// Vertex formats uploaded to the GPU. Vertex above is only the import-time representation;
+// each mesh is stored with the smallest format its shader needs:
+//   StaticVertex        20 bytes  position, normal, UV                (Model)
+//   StaticTangentVertex 24 bytes  + tangent, only with a normal map   (Model)
+//   SkinnedVertex       48 bytes  + tangent and 12 bone influences    (AnimatedModel)
+// Normals/tangents are snorm 10:10:10:2 (tangent.w carries the bitangent sign, the bitangent is
+// rebuilt in the shader), UVs are half floats, bone indices uint8 and weights unorm8.
+// Attribute locations are the same in every format so the shaders only declare what they read.
+enum VertexFormat {
+    VERTEX_FORMAT_STATIC = 0,
+    VERTEX_FORMAT_STATIC_TANGENT = 1,
+    VERTEX_FORMAT_SKINNED = 2
+};
+
+inline glm::vec3 SafeNormalize(const glm::vec3& v, const glm::vec3& fallback)
+{
+    return glm::length(v) > 0.0f ? glm::normalize(v) : fallback;
+}
+
+// tangent with the bitangent handedness in w
+inline uint32_t PackTangentFrame(const Vertex& v)
+{
+    glm::vec3 n = SafeNormalize(v.Normal, glm::vec3(0.0f, 0.0f, 1.0f));
+    glm::vec3 t = SafeNormalize(v.Tangent, glm::vec3(1.0f, 0.0f, 0.0f));
+    float handedness = glm::dot(glm::cross(n, t), v.Bitangent) < 0.0f ? -1.0f : 1.0f;
+    return PackSnorm1010102(t, handedness);
+}
+
+struct StaticVertex {
+    glm::vec3 Position;
+    uint32_t  Normal;
+    uint16_t  TexCoords[2];
+
+    static VertexFormat format() { return VERTEX_FORMAT_STATIC; }
+
+    static StaticVertex From(const Vertex& v)
+    {
+        StaticVertex p;
+        p.Position = v.Position;
+        p.Normal = PackSnorm1010102(SafeNormalize(v.Normal, glm::vec3(0.0f, 0.0f, 1.0f)), 0.0f);
+        p.TexCoords[0] = FloatToHalf(v.TexCoords.x);
+        p.TexCoords[1] = FloatToHalf(v.TexCoords.y);
+        return p;
+    }
+
+    static void setupAttributes()
+    {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StaticVertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(StaticVertex), (void*)offsetof(StaticVertex, TexCoords));
+    }
+};
+
+struct StaticTangentVertex {
+    glm::vec3 Position;
+    uint32_t  Normal;
+    uint32_t  Tangent;
+    uint16_t  TexCoords[2];
+
+    static VertexFormat format() { return VERTEX_FORMAT_STATIC_TANGENT; }
+
+    static StaticTangentVertex From(const Vertex& v)
+    {
+        StaticTangentVertex p;
+        p.Position = v.Position;
+        p.Normal = PackSnorm1010102(SafeNormalize(v.Normal, glm::vec3(0.0f, 0.0f, 1.0f)), 0.0f);
+        p.Tangent = PackTangentFrame(v);
+        p.TexCoords[0] = FloatToHalf(v.TexCoords.x);
+        p.TexCoords[1] = FloatToHalf(v.TexCoords.y);
+        return p;
+    }
+
+    static void setupAttributes()
+    {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(StaticTangentVertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(StaticTangentVertex), (void*)offsetof(StaticTangentVertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(StaticTangentVertex), (void*)offsetof(StaticTangentVertex, TexCoords));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(StaticTangentVertex), (void*)offsetof(StaticTangentVertex, Tangent));
+    }
+};
+
+struct SkinnedVertex {
+    glm::vec3 Position;
+    uint32_t  Normal;
+    uint32_t  Tangent;
+    uint16_t  TexCoords[2];
+    uint8_t   BoneIDs[3 * MAX_NUM_BONES];
+    uint8_t   BoneWeights[3 * MAX_NUM_BONES];
+
+    static VertexFormat format() { return VERTEX_FORMAT_SKINNED; }
+
+    static SkinnedVertex From(const Vertex& v)
+    {
+        SkinnedVertex p;
+        p.Position = v.Position;
+        p.Normal = PackSnorm1010102(SafeNormalize(v.Normal, glm::vec3(0.0f, 0.0f, 1.0f)), 0.0f);
+        p.Tangent = PackTangentFrame(v);
+        p.TexCoords[0] = FloatToHalf(v.TexCoords.x);
+        p.TexCoords[1] = FloatToHalf(v.TexCoords.y);
+
+        const glm::vec4* ids[3] = { &v.IDs1, &v.IDs2, &v.IDs3 };
+        const glm::vec4* ws[3] = { &v.Weights1, &v.Weights2, &v.Weights3 };
+        float weights[3 * MAX_NUM_BONES];
+        for (unsigned int i = 0; i < 3 * MAX_NUM_BONES; i++) {
+            p.BoneIDs[i] = (uint8_t)(*ids[i / MAX_NUM_BONES])[i % MAX_NUM_BONES];
+            weights[i] = (*ws[i / MAX_NUM_BONES])[i % MAX_NUM_BONES];
+        }
+        QuantizeWeightsUnorm8(weights, 3 * MAX_NUM_BONES, p.BoneWeights);
+        return p;
+    }
+
+    static void setupAttributes()
+    {
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(SkinnedVertex), (void*)offsetof(SkinnedVertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void*)offsetof(SkinnedVertex, TexCoords));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(SkinnedVertex), (void*)offsetof(SkinnedVertex, Tangent));
+        // bones: integer indices, normalized weights
+        for (unsigned int g = 0; g < 3; g++) {
+            glEnableVertexAttribArray(5 + g);
+            glVertexAttribIPointer(5 + g, 4, GL_UNSIGNED_BYTE, sizeof(SkinnedVertex), (void*)(offsetof(SkinnedVertex, BoneIDs) + g * MAX_NUM_BONES));
+            glEnableVertexAttribArray(8 + g);
+            glVertexAttribPointer(8 + g, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(SkinnedVertex), (void*)(offsetof(SkinnedVertex, BoneWeights) + g * MAX_NUM_BONES));
+        }
+    }
+};
+
+// converts imported vertices to a GPU format
+template <typename VertexT>
+vector<VertexT> ConvertVertices(const vector<Vertex>& vertices)
+{
+    vector<VertexT> out;
+    out.reserve(vertices.size());
+    for (const Vertex& v : vertices)
+        out.push_back(VertexT::From(v));
+    return out;
+}
+
 struct Texture {
     unsigned int id;
     string type;
     string path;
 };
 
+template <typename VertexT>
 class Mesh {
 public:
     /*  Mesh Data  */
-    vector<Vertex> vertices;
+    vector<VertexT> vertices;
     vector<unsigned int> indices;
     vector<Texture> textures;
-    unsigned int VAO;
+    GeometryRange geometry; // vertices and indices inside the shared GeometryPool buffers
+    unsigned int materialIndex;
+    vector<MeshLod> lods; // level 0 is the full mesh; all levels index the same vertices
+    glm::vec3 boundsMin, boundsMax; // model-space bounding box
 
     /*  Functions  */
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor; indices holds every LOD back to back as described by lods (empty lods: a single level)
+    Mesh(vector<VertexT> vertices, vector<unsigned int> indices, vector<Texture> textures, unsigned int materialIndex = 0, vector<MeshLod> lods = vector<MeshLod>())
     {
-        this->vertices = vertices;
-        this->indices = indices;
-        this->textures = textures;
+        this->vertices = std::move(vertices);
+        this->indices = std::move(indices);
+        this->textures = std::move(textures);
+        this->materialIndex = materialIndex;
+        setLods(std::move(lods), this->indices.size());
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setupMesh();
+        setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+    }
+
+    // constructor for externally owned data (e.g. a memory-mapped bake): the buffers are uploaded
+    // straight from the given pointers and no CPU-side copy is kept, so vertices/indices stay empty.
+    // indexData holds 16 or 32-bit indices as given by indexType.
+    Mesh(const VertexT* vertexData, size_t vertexCount, const void* indexData, size_t indexCount, GLenum indexType, vector<Texture> textures, unsigned int materialIndex = 0, vector<MeshLod> lods = vector<MeshLod>())
+    {
+        this->textures = std::move(textures);
+        this->materialIndex = materialIndex;
+        setLods(std::move(lods), indexCount);
+        computeBounds(vertexData, vertexCount);
+        geometry = GeometryPool::instance().allocate(vertexData, vertexCount, indexData, indexCount, indexType);
     }
 
-    // render the mesh
-    void Draw(Shader shader) 
+    // render the mesh at the given level of detail (clamped to the coarsest one available),
+    // instanceCount times in a single instanced draw
+    void Draw(Shader shader, unsigned int lod = 0, GLsizei instanceCount = 1)
+    {
+        BindTextures(shader);
+
+        // draw mesh: the pool only rebinds the VAO when the vertex format changes, callers
+        // drawing a batch of meshes call GeometryPool::unbind() once at the end
+        const MeshLod& level = getLod(lod);
+        GeometryPool::instance().draw(geometry, level.firstIndex, level.indexCount, instanceCount);
+
+        // always good practice to set everything back to defaults once configured.
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    // binds this mesh's textures to consecutive units and points the shader's samplers at them
+    void BindTextures(Shader& shader)
     {
         // bind appropriate textures
         unsigned int diffuseNr  = 1;
@@ -92,76 +276,59 @@ public:
             // and finally bind the texture
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
         }
-        
-        // draw mesh
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
-        glBindVertexArray(0);
+    }
 
-        // always good practice to set everything back to defaults once configured.
-        glActiveTexture(GL_TEXTURE0);
+    // the given level of detail, clamped to the coarsest one available
+    const MeshLod& getLod(unsigned int lod) const
+    {
+        return lods[lod < lods.size() ? lod : lods.size() - 1];
     }
 
-private:
-    /*  Render data  */
-    unsigned int VBO, EBO;
+    // bytes this mesh occupies in the pool buffers (load profiling)
+    size_t gpuVertexBytes() const { return (size_t)geometry.vertexCount * sizeof(VertexT); }
+    size_t gpuIndexBytes() const { return geometry.indexBytes(); }
 
+    // returns the vertex/index ranges to the pool (the Mesh can't be drawn afterwards)
+    void release()
+    {
+        GeometryPool::instance().free(geometry);
+    }
+
+private:
     /*  Functions    */
-    // initializes all the buffer objects/arrays
-    void setupMesh()
+    void computeBounds(const VertexT* vertexData, size_t vertexCount)
     {
+        boundsMin = glm::vec3(1e30f);
+        boundsMax = glm::vec3(-1e30f);
+        for (size_t i = 0; i < vertexCount; i++) {
+            boundsMin = glm::min(boundsMin, vertexData[i].Position);
+            boundsMax = glm::max(boundsMax, vertexData[i].Position);
+        }
+    }
 
-        // create buffers/arrays
-        glGenVertexArrays(1, &VAO);
-        glGenBuffers(1, &VBO);
-        glGenBuffers(1, &EBO);
-
-        glBindVertexArray(VAO);
-        // load data into vertex buffers
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        // A great thing about structs is that their memory layout is sequential for all its items.
-        // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
-        // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-		
-
-        // set the vertex attribute pointers
-        // vertex Positions
-        glEnableVertexAttribArray(0);	
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-        // vertex normals
-        glEnableVertexAttribArray(1);	
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
-        // vertex texture coords
-        glEnableVertexAttribArray(2);	
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
-        // vertex tangent
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Tangent));
-        // vertex bitangent
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Bitangent));
-		// vertex bones
-		glEnableVertexAttribArray(5);
-		glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs1));
-		glEnableVertexAttribArray(6);
-		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs2));
-		glEnableVertexAttribArray(7);
-		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, IDs3));
-		
-		glEnableVertexAttribArray(8);
-		glVertexAttribPointer(8, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights1));
-		glEnableVertexAttribArray(9);
-		glVertexAttribPointer(9, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights2));
-		glEnableVertexAttribArray(10);
-		glVertexAttribPointer(10, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Weights3));
-
-        glBindVertexArray(0);
+    void setLods(vector<MeshLod> levels, size_t indexCount)
+    {
+        lods = std::move(levels);
+        if (lods.empty())
+            lods.push_back(MeshLod{ 0, (unsigned int)indexCount, 0.0f });
     }
 
-	
+    // copies the vertex and index data into the shared buffers of this vertex format,
+    // narrowing the indices to 16 bits when every vertex fits
+    void setupMesh(const VertexT* vertexData, size_t vertexCount, const unsigned int* indexData, size_t numIndices)
+    {
+        computeBounds(vertexData, vertexCount);
+        if (SmallestIndexType(vertexCount) == GL_UNSIGNED_SHORT) {
+            vector<uint16_t> shortIndices(indexData, indexData + numIndices);
+            geometry = GeometryPool::instance().allocate(vertexData, vertexCount, shortIndices.data(), numIndices, GL_UNSIGNED_SHORT);
+        }
+        else
+            geometry = GeometryPool::instance().allocate(vertexData, vertexCount, indexData, numIndices, GL_UNSIGNED_INT);
+    }
 };
+
+// meshes of static geometry and of skinned characters
+typedef Mesh<StaticVertex>        StaticMesh;
+typedef Mesh<StaticTangentVertex> StaticTangentMesh;
+typedef Mesh<SkinnedVertex>       SkinnedMesh;
 #endif
\ No newline at end of file
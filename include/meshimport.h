@@ -0,0 +1,171 @@
+#ifndef MESHIMPORT_H
+#define MESHIMPORT_H
+
+#include <glm/glm.hpp>
+#include <assimp/scene.h>
+
+#include <mesh.h>
+#include <modelstructs.h>
+#include <jobsystem.h>
+#include <boneinfluence.h>
+#include <meshoptimize.h>
+#include <meshsimplify.h>
+
+#include <vector>
+using namespace std;
+
+/**
+ * @brief Resultado de la etapa de CPU de la importación de una malla
+ * Contiene todo lo que se necesita para crear el Mesh sin volver a tocar el aiMesh;
+ * se llena en un hilo de trabajo y se sube a GL después en el hilo del contexto.
+ */
+struct MeshData {
+	vector<Vertex>       vertices;
+	vector<unsigned int> indices;
+	vector<Bone>         bones;
+	BoneInfluenceStats   boneStats;
+	MeshOptimizeStats    optimizeStats;
+	vector<MeshLod>      lods;          // vacío si no se generaron LODs
+	unsigned int         materialIndex;
+	const aiMesh*        source;
+
+	MeshData() : materialIndex(0), source(nullptr) {}
+};
+
+inline glm::mat4 AiToGlm(const aiMatrix4x4& from)
+{
+	glm::mat4 to;
+
+	to[0][0] = (GLfloat)from.a1; to[0][1] = (GLfloat)from.b1;  to[0][2] = (GLfloat)from.c1; to[0][3] = (GLfloat)from.d1;
+	to[1][0] = (GLfloat)from.a2; to[1][1] = (GLfloat)from.b2;  to[1][2] = (GLfloat)from.c2; to[1][3] = (GLfloat)from.d2;
+	to[2][0] = (GLfloat)from.a3; to[2][1] = (GLfloat)from.b3;  to[2][2] = (GLfloat)from.c3; to[2][3] = (GLfloat)from.d3;
+	to[3][0] = (GLfloat)from.a4; to[3][1] = (GLfloat)from.b4;  to[3][2] = (GLfloat)from.c4; to[3][3] = (GLfloat)from.d4;
+
+	return to;
+}
+
+// collects the meshes referenced by the node tree in the same depth-first order processNode used to visit them
+inline void CollectSceneMeshes(const aiNode* node, const aiScene* scene, vector<const aiMesh*>& out)
+{
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		out.push_back(scene->mMeshes[node->mMeshes[i]]);
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
+		CollectSceneMeshes(node->mChildren[i], scene, out);
+}
+
+// converts one aiMesh into vertex/index/bone arrays. Pure CPU work, safe to run on any thread.
+// With generateLods the simplified levels are appended to the indices (see GenerateLodChain).
+inline void ConvertMesh(const aiMesh* mesh, MeshData& out, bool generateLods = false)
+{
+	out.source = mesh;
+	out.materialIndex = mesh->mMaterialIndex;
+	out.vertices.reserve(mesh->mNumVertices);
+
+	// Gather bone weights once per bone (scatter) instead of scanning every bone for every vertex
+	BoneInfluenceBuilder influences(mesh->mNumBones > 0 ? mesh->mNumVertices : 0);
+	influences.addMesh(mesh);
+	influences.finalize();
+	out.boneStats = influences.getStats();
+
+	// Walk through each of the mesh's vertices
+	for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+	{
+		Vertex vertex;
+		glm::vec3 vector; // assimp uses its own vector class that doesn't directly convert to glm's vec3 class
+
+		// positions
+		vector.x = mesh->mVertices[i].x;
+		vector.y = mesh->mVertices[i].y;
+		vector.z = mesh->mVertices[i].z;
+		vertex.Position = vector;
+
+		// normals
+		vector.x = mesh->mNormals[i].x;
+		vector.y = mesh->mNormals[i].y;
+		vector.z = mesh->mNormals[i].z;
+		vertex.Normal = vector;
+
+		// texture coordinates (only the first set is used)
+		if (mesh->mTextureCoords[0])
+		{
+			glm::vec2 vec;
+			vec.x = mesh->mTextureCoords[0][i].x;
+			vec.y = mesh->mTextureCoords[0][i].y;
+			vertex.TexCoords = vec;
+		}
+		else
+			vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+
+		// tangent
+		vector.x = mesh->mTangents[i].x;
+		vector.y = mesh->mTangents[i].y;
+		vector.z = mesh->mTangents[i].z;
+		vertex.Tangent = vector;
+
+		// bitangent
+		vector.x = mesh->mBitangents[i].x;
+		vector.y = mesh->mBitangents[i].y;
+		vector.z = mesh->mBitangents[i].z;
+		vertex.Bitangent = vector;
+
+		// Bones
+		influences.pack(i, vertex);
+
+		out.vertices.push_back(vertex);
+	}
+
+	// Process Bones
+	out.bones.reserve(mesh->mNumBones);
+	for (unsigned int i = 0; i < mesh->mNumBones; i++) {
+		Bone  newBone;
+		newBone.name = mesh->mBones[i]->mName;
+		newBone.offsetMatrix = AiToGlm(mesh->mBones[i]->mOffsetMatrix);
+		newBone.transformation = glm::mat4(1.0f);
+
+		for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++) {
+			unsigned int VertexID = mesh->mBones[i]->mWeights[j].mVertexId;
+			float Weight = mesh->mBones[i]->mWeights[j].mWeight;
+			newBone.push(VertexID, Weight);
+		}
+
+		out.bones.push_back(newBone);
+	}
+
+	// Process faces: a face is a triangle (aiProcess_Triangulate)
+	out.indices.reserve((size_t)mesh->mNumFaces * 3);
+	for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+	{
+		const aiFace& face = mesh->mFaces[i];
+		for (unsigned int j = 0; j < face.mNumIndices; j++)
+			out.indices.push_back(face.mIndices[j]);
+	}
+
+	// Weld, reorder for the vertex cache/overdraw/fetch; vertex ids held by the bones follow the new numbering
+	vector<unsigned int> remap;
+	out.optimizeStats = OptimizeMesh(out.vertices, out.indices, remap);
+	for (Bone& bone : out.bones) {
+		for (unsigned int& id : bone.IDs)
+			if (id < remap.size()) id = remap[id];
+	}
+
+	if (generateLods)
+		GenerateLodChain(out.vertices, out.indices, out.lods);
+}
+
+/**
+ * @brief Etapa de CPU: convierte todas las mallas de la escena en paralelo
+ * El orden del resultado es el mismo recorrido en profundidad del árbol de nodos.
+ */
+inline vector<MeshData> ConvertSceneMeshes(const aiNode* root, const aiScene* scene, bool generateLods = false)
+{
+	vector<const aiMesh*> sceneMeshes;
+	CollectSceneMeshes(root, scene, sceneMeshes);
+
+	vector<MeshData> result(sceneMeshes.size());
+	JobSystem::instance().parallelFor(sceneMeshes.size(), [&](size_t i) {
+		ConvertMesh(sceneMeshes[i], result[i], generateLods);
+	});
+	return result;
+}
+
+#endif
@@ -0,0 +1,328 @@
+#ifndef MESHOPTIMIZE_H
+#define MESHOPTIMIZE_H
+
+#include <glm/glm.hpp>
+
+#include <mesh.h>
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+using namespace std;
+
+/**
+ * @brief Optimización de mallas al importar
+ * 1. Soldadura de vértices idénticos (Assimp entrega un vértice por esquina de cara).
+ * 2. Orden de triángulos para la caché post-transformación (Forsyth, LRU de 32).
+ * 3. Orden de clusters para reducir overdraw (los que miran hacia afuera primero).
+ * 4. Orden de vértices por primer uso para la localidad de lectura.
+ * Todo es trabajo de CPU y corre en los hilos de ConvertSceneMeshes.
+ */
+
+#define VERTEX_CACHE_SIZE 32 // caché que se modela al ordenar
+#define ACMR_FIFO_SIZE    16 // caché FIFO con la que se mide el ACMR (hardware conservador)
+
+struct MeshOptimizeStats {
+	unsigned int verticesBefore;
+	unsigned int verticesAfter;
+	unsigned int triangles;
+	unsigned int clusters;
+	float        acmrBefore; // vértices transformados por triángulo
+	float        acmrAfter;
+
+	MeshOptimizeStats() : verticesBefore(0), verticesAfter(0), triangles(0), clusters(0),
+		acmrBefore(0.0f), acmrAfter(0.0f) {}
+};
+
+inline ostream& operator<<(ostream& os, const MeshOptimizeStats& s) {
+	std::ios::fmtflags flags = os.flags();
+	os << s.triangles << " triangles, vertices " << s.verticesBefore << " -> " << s.verticesAfter
+		<< ", ACMR " << std::fixed << std::setprecision(3) << s.acmrBefore << " -> " << s.acmrAfter
+		<< " (FIFO " << ACMR_FIFO_SIZE << "), " << s.clusters << " overdraw clusters";
+	os.flags(flags);
+	return os;
+}
+
+/**
+ * @brief ACMR con una caché FIFO simulada
+ */
+inline float ComputeACMR(const vector<unsigned int>& indices, size_t vertexCount, unsigned int cacheSize = ACMR_FIFO_SIZE)
+{
+	if (indices.size() < 3) return 0.0f;
+	vector<unsigned int> timestamp(vertexCount, 0);
+	unsigned int time = cacheSize + 1;
+	unsigned int misses = 0;
+	for (unsigned int index : indices) {
+		// está en la caché si entró hace menos de cacheSize fallos
+		if (time - timestamp[index] > cacheSize) {
+			timestamp[index] = time++;
+			misses++;
+		}
+	}
+	return (float)misses / (float)(indices.size() / 3);
+}
+
+struct VertexBytesHash {
+	size_t operator()(const Vertex& v) const {
+		// FNV-1a sobre los bytes del vértice
+		const unsigned char* p = (const unsigned char*)&v;
+		size_t h = 2166136261u;
+		for (size_t i = 0; i < sizeof(Vertex); i++) { h ^= p[i]; h *= 16777619u; }
+		return h;
+	}
+};
+
+struct VertexBytesEqual {
+	bool operator()(const Vertex& a, const Vertex& b) const {
+		return memcmp(&a, &b, sizeof(Vertex)) == 0;
+	}
+};
+
+/**
+ * @brief Une vértices idénticos byte a byte
+ * @param remap Para cada vértice original, su índice en el arreglo soldado
+ */
+inline void WeldVertices(vector<Vertex>& vertices, vector<unsigned int>& indices, vector<unsigned int>& remap)
+{
+	unordered_map<Vertex, unsigned int, VertexBytesHash, VertexBytesEqual> unique;
+	unique.reserve(vertices.size());
+	remap.resize(vertices.size());
+
+	vector<Vertex> welded;
+	welded.reserve(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++) {
+		auto it = unique.find(vertices[i]);
+		if (it == unique.end()) {
+			it = unique.emplace(vertices[i], (unsigned int)welded.size()).first;
+			welded.push_back(vertices[i]);
+		}
+		remap[i] = it->second;
+	}
+	for (unsigned int& index : indices) index = remap[index];
+	vertices.swap(welded);
+}
+
+inline float ForsythVertexScore(int cachePosition, unsigned int remainingTriangles)
+{
+	if (remainingTriangles == 0) return -1.0f;
+	float score = 0.0f;
+	if (cachePosition >= 0) {
+		if (cachePosition < 3)
+			score = 0.75f; // el último triángulo: no conviene reusarlo de inmediato
+		else
+			score = powf(1.0f - (float)(cachePosition - 3) / (VERTEX_CACHE_SIZE - 3), 1.5f);
+	}
+	// favorece vértices con pocos triángulos pendientes para no dejar huecos
+	return score + 2.0f / sqrtf((float)remainingTriangles);
+}
+
+/**
+ * @brief Reordena los triángulos para la caché de vértices (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation")
+ */
+inline void OptimizeVertexCache(vector<unsigned int>& indices, size_t vertexCount)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	// adyacencia vértice -> triángulos
+	vector<unsigned int> remaining(vertexCount, 0);
+	for (unsigned int index : indices) remaining[index]++;
+	vector<unsigned int> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++) offsets[v + 1] = offsets[v] + remaining[v];
+	vector<unsigned int> adjacency(indices.size());
+	{
+		vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t t = 0; t < triangleCount; t++)
+			for (int k = 0; k < 3; k++) adjacency[fill[indices[t * 3 + k]]++] = (unsigned int)t;
+	}
+
+	vector<int> cachePosition(vertexCount, -1);
+	vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) vertexScore[v] = ForsythVertexScore(-1, remaining[v]);
+
+	vector<char> emitted(triangleCount, 0);
+
+	vector<unsigned int> cache, nextCache;
+	cache.reserve(VERTEX_CACHE_SIZE + 3);
+	nextCache.reserve(VERTEX_CACHE_SIZE + 3);
+
+	vector<unsigned int> output;
+	output.reserve(indices.size());
+	size_t scanCursor = 0;
+	long bestTriangle = -1;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+		if (bestTriangle < 0) {
+			// ningún candidato en la caché: el siguiente triángulo pendiente en orden
+			while (emitted[scanCursor]) scanCursor++;
+			bestTriangle = (long)scanCursor;
+		}
+
+		size_t t = (size_t)bestTriangle;
+		emitted[t] = 1;
+		unsigned int tri[3] = { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] };
+		output.insert(output.end(), tri, tri + 3);
+
+		// LRU: los vértices del triángulo pasan al frente
+		nextCache.assign(tri, tri + 3);
+		for (unsigned int v : cache)
+			if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+
+		for (int k = 0; k < 3; k++) {
+			unsigned int v = tri[k];
+			// quitar t de la lista de pendientes del vértice
+			unsigned int begin = offsets[v], end = begin + remaining[v];
+			for (unsigned int a = begin; a < end; a++) {
+				if (adjacency[a] == t) { adjacency[a] = adjacency[end - 1]; break; }
+			}
+			remaining[v]--;
+		}
+
+		// actualizar puntajes de lo que está (o estuvo) en la caché
+		for (size_t i = 0; i < nextCache.size(); i++) {
+			unsigned int v = nextCache[i];
+			cachePosition[v] = i < VERTEX_CACHE_SIZE ? (int)i : -1;
+			vertexScore[v] = ForsythVertexScore(cachePosition[v], remaining[v]);
+		}
+
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t i = 0; i < nextCache.size(); i++) {
+			unsigned int v = nextCache[i];
+			for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+				unsigned int n = adjacency[a];
+				float score = vertexScore[indices[n * 3]] + vertexScore[indices[n * 3 + 1]] + vertexScore[indices[n * 3 + 2]];
+				if (score > bestScore) { bestScore = score; bestTriangle = (long)n; }
+			}
+		}
+
+		if (nextCache.size() > VERTEX_CACHE_SIZE) nextCache.resize(VERTEX_CACHE_SIZE);
+		cache.swap(nextCache);
+	}
+
+	indices.swap(output);
+}
+
+/**
+ * @brief Reordena clusters de triángulos para reducir overdraw sin perder la localidad de caché
+ * Un cluster termina donde la caché FIFO falla en los tres vértices (no hay reuso que perder);
+ * los clusters se dibujan primero los que miran hacia afuera del centro de la malla, que son
+ * los que con mayor probabilidad ocultan a los demás.
+ * @return número de clusters
+ */
+inline unsigned int OptimizeOverdraw(vector<unsigned int>& indices, const vector<Vertex>& vertices)
+{
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0) return 0;
+
+	// límites de cluster
+	vector<size_t> clusterStart;
+	{
+		vector<unsigned int> timestamp(vertices.size(), 0);
+		unsigned int time = ACMR_FIFO_SIZE + 1;
+		for (size_t t = 0; t < triangleCount; t++) {
+			int misses = 0;
+			for (int k = 0; k < 3; k++) {
+				unsigned int v = indices[t * 3 + k];
+				if (time - timestamp[v] > ACMR_FIFO_SIZE) { timestamp[v] = time++; misses++; }
+			}
+			if (t == 0 || misses == 3) clusterStart.push_back(t);
+		}
+	}
+	size_t clusterCount = clusterStart.size();
+	if (clusterCount < 2) return (unsigned int)clusterCount;
+	clusterStart.push_back(triangleCount);
+
+	// centroide de la malla ponderado por área
+	glm::vec3 meshCenter(0.0f);
+	float meshArea = 0.0f;
+	vector<glm::vec3> clusterCenter(clusterCount, glm::vec3(0.0f));
+	vector<glm::vec3> clusterNormal(clusterCount, glm::vec3(0.0f));
+	vector<float> clusterArea(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; c++) {
+		for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+			const glm::vec3& a = vertices[indices[t * 3]].Position;
+			const glm::vec3& b = vertices[indices[t * 3 + 1]].Position;
+			const glm::vec3& d = vertices[indices[t * 3 + 2]].Position;
+			glm::vec3 n = glm::cross(b - a, d - a);
+			float area = glm::length(n);
+			clusterNormal[c] += n;
+			clusterCenter[c] += (a + b + d) * (area / 3.0f);
+			clusterArea[c] += area;
+		}
+		meshCenter += clusterCenter[c];
+		meshArea += clusterArea[c];
+	}
+	if (meshArea <= 0.0f) return (unsigned int)clusterCount;
+	meshCenter /= meshArea;
+
+	vector<float> sortKey(clusterCount, 0.0f);
+	for (size_t c = 0; c < clusterCount; c++) {
+		if (clusterArea[c] <= 0.0f) continue;
+		glm::vec3 center = clusterCenter[c] / clusterArea[c];
+		float len = glm::length(clusterNormal[c]);
+		glm::vec3 normal = len > 0.0f ? clusterNormal[c] / len : glm::vec3(0.0f);
+		sortKey[c] = glm::dot(center - meshCenter, normal);
+	}
+
+	vector<size_t> order(clusterCount);
+	for (size_t c = 0; c < clusterCount; c++) order[c] = c;
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	vector<unsigned int> output;
+	output.reserve(indices.size());
+	for (size_t c : order)
+		output.insert(output.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+	indices.swap(output);
+	return (unsigned int)clusterCount;
+}
+
+/**
+ * @brief Renumera los vértices en el orden en que los usa el índice
+ * @param remap Para cada vértice de entrada, su nuevo índice (0xFFFFFFFF si ningún triángulo lo usa)
+ */
+inline void OptimizeVertexFetch(vector<Vertex>& vertices, vector<unsigned int>& indices, vector<unsigned int>& remap)
+{
+	remap.assign(vertices.size(), 0xFFFFFFFFu);
+	vector<Vertex> ordered;
+	ordered.reserve(vertices.size());
+	for (unsigned int& index : indices) {
+		if (remap[index] == 0xFFFFFFFFu) {
+			remap[index] = (unsigned int)ordered.size();
+			ordered.push_back(vertices[index]);
+		}
+		index = remap[index];
+	}
+	vertices.swap(ordered);
+}
+
+/**
+ * @brief Corre toda la etapa de optimización sobre una malla triangulada
+ * @param remap Para cada vértice original, su índice final (0xFFFFFFFF si se descartó)
+ */
+inline MeshOptimizeStats OptimizeMesh(vector<Vertex>& vertices, vector<unsigned int>& indices, vector<unsigned int>& remap)
+{
+	MeshOptimizeStats stats;
+	stats.verticesBefore = (unsigned int)vertices.size();
+	stats.triangles = (unsigned int)(indices.size() / 3);
+	stats.acmrBefore = ComputeACMR(indices, vertices.size());
+
+	vector<unsigned int> weldRemap, fetchRemap;
+	WeldVertices(vertices, indices, weldRemap);
+	OptimizeVertexCache(indices, vertices.size());
+	stats.clusters = OptimizeOverdraw(indices, vertices);
+	OptimizeVertexFetch(vertices, indices, fetchRemap);
+
+	remap.resize(weldRemap.size());
+	for (size_t i = 0; i < weldRemap.size(); i++) remap[i] = fetchRemap[weldRemap[i]];
+
+	stats.verticesAfter = (unsigned int)vertices.size();
+	stats.acmrAfter = ComputeACMR(indices, vertices.size());
+	return stats;
+}
+
+#endif
@@ -0,0 +1,287 @@
+#ifndef MESHSIMPLIFY_H
+#define MESHSIMPLIFY_H
+
+#include <glm/glm.hpp>
+
+#include <mesh.h>
+#include <meshoptimize.h>
+
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+using namespace std;
+
+/**
+ * @brief Generación de LODs por simplificación con cuádricas de error (Garland-Heckbert)
+ * Se usan colapsos de media arista: un vértice se mueve sobre uno de sus vecinos, así que todos
+ * los LODs son sólo otra lista de índices sobre el mismo buffer de vértices.
+ * La topología se calcula sobre posiciones (las costuras de normales/UV no bloquean el colapso);
+ * al final cada esquina toma la variante del vértice destino con atributos más parecidos.
+ */
+
+#define MAX_MESH_LODS 4 // LOD0 + 3 simplificados
+
+struct Quadric {
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+	Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0) {}
+
+	// plano n·p + d = 0 con n unitaria
+	static Quadric plane(const glm::dvec3& n, double d, double weight) {
+		Quadric q;
+		q.a2 = n.x * n.x * weight; q.ab = n.x * n.y * weight; q.ac = n.x * n.z * weight; q.ad = n.x * d * weight;
+		q.b2 = n.y * n.y * weight; q.bc = n.y * n.z * weight; q.bd = n.y * d * weight;
+		q.c2 = n.z * n.z * weight; q.cd = n.z * d * weight;
+		q.d2 = d * d * weight;
+		return q;
+	}
+
+	Quadric& operator+=(const Quadric& o) {
+		a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+		bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+		return *this;
+	}
+
+	// suma de distancias al cuadrado a los planos acumulados
+	double error(const glm::dvec3& p) const {
+		double e = a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+			+ b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+			+ c2 * p.z * p.z + 2 * cd * p.z + d2;
+		return e > 0.0 ? e : 0.0;
+	}
+};
+
+struct Vec3BytesHash {
+	size_t operator()(const glm::vec3& v) const {
+		uint32_t b[3];
+		memcpy(b, &v, sizeof(b));
+		return (size_t)b[0] * 73856093u ^ (size_t)b[1] * 19349663u ^ (size_t)b[2] * 83492791u;
+	}
+};
+
+struct Vec3BytesEqual {
+	bool operator()(const glm::vec3& a, const glm::vec3& b) const { return memcmp(&a, &b, sizeof(glm::vec3)) == 0; }
+};
+
+/**
+ * @brief Simplifica una lista de triángulos hasta targetIndexCount o hasta superar maxError
+ * @param resultError Error máximo de los colapsos aplicados
+ * @return Índices simplificados sobre el mismo arreglo de vértices
+ */
+inline vector<unsigned int> SimplifyMesh(const vector<Vertex>& vertices, const vector<unsigned int>& indices,
+	size_t targetIndexCount, float maxError, float& resultError)
+{
+	resultError = 0.0f;
+	size_t triangleCount = indices.size() / 3;
+
+	// grupos por posición
+	unordered_map<glm::vec3, unsigned int, Vec3BytesHash, Vec3BytesEqual> positionIds;
+	vector<unsigned int> vertexGroup(vertices.size(), 0);
+	vector<glm::dvec3> groupPos;
+	vector<vector<unsigned int>> groupWedges;
+	for (size_t v = 0; v < vertices.size(); v++) {
+		auto it = positionIds.find(vertices[v].Position);
+		if (it == positionIds.end()) {
+			it = positionIds.emplace(vertices[v].Position, (unsigned int)groupPos.size()).first;
+			groupPos.push_back(glm::dvec3(vertices[v].Position));
+			groupWedges.push_back(vector<unsigned int>());
+		}
+		vertexGroup[v] = it->second;
+		groupWedges[it->second].push_back((unsigned int)v);
+	}
+	size_t groupCount = groupPos.size();
+
+	vector<unsigned int> corners(indices.size());
+	vector<char> triangleAlive(triangleCount, 1);
+	size_t aliveTriangles = 0;
+	vector<vector<unsigned int>> groupTriangles(groupCount);
+	for (size_t t = 0; t < triangleCount; t++) {
+		for (int k = 0; k < 3; k++) corners[t * 3 + k] = vertexGroup[indices[t * 3 + k]];
+		if (corners[t * 3] == corners[t * 3 + 1] || corners[t * 3 + 1] == corners[t * 3 + 2] || corners[t * 3] == corners[t * 3 + 2]) {
+			triangleAlive[t] = 0;
+			continue;
+		}
+		aliveTriangles++;
+		for (int k = 0; k < 3; k++) groupTriangles[corners[t * 3 + k]].push_back((unsigned int)t);
+	}
+
+	// cuádricas: plano de cada cara + planos perpendiculares en los bordes abiertos
+	vector<Quadric> quadrics(groupCount);
+	unordered_map<uint64_t, unsigned int> edgeUse;
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (!triangleAlive[t]) continue;
+		const glm::dvec3& a = groupPos[corners[t * 3]];
+		const glm::dvec3& b = groupPos[corners[t * 3 + 1]];
+		const glm::dvec3& c = groupPos[corners[t * 3 + 2]];
+		glm::dvec3 n = glm::cross(b - a, c - a);
+		double len = glm::length(n);
+		if (len <= 0.0) continue;
+		n /= len;
+		Quadric q = Quadric::plane(n, -glm::dot(n, a), 1.0);
+		for (int k = 0; k < 3; k++) {
+			quadrics[corners[t * 3 + k]] += q;
+			unsigned int u = corners[t * 3 + k], v = corners[t * 3 + (k + 1) % 3];
+			uint64_t key = u < v ? ((uint64_t)u << 32 | v) : ((uint64_t)v << 32 | u);
+			edgeUse[key]++;
+		}
+	}
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (!triangleAlive[t]) continue;
+		const glm::dvec3& a = groupPos[corners[t * 3]];
+		glm::dvec3 n = glm::cross(groupPos[corners[t * 3 + 1]] - a, groupPos[corners[t * 3 + 2]] - a);
+		if (glm::length(n) <= 0.0) continue;
+		n = glm::normalize(n);
+		for (int k = 0; k < 3; k++) {
+			unsigned int u = corners[t * 3 + k], v = corners[t * 3 + (k + 1) % 3];
+			uint64_t key = u < v ? ((uint64_t)u << 32 | v) : ((uint64_t)v << 32 | u);
+			if (edgeUse[key] != 1) continue;
+			glm::dvec3 edge = groupPos[v] - groupPos[u];
+			glm::dvec3 bn = glm::cross(edge, n);
+			double bl = glm::length(bn);
+			if (bl <= 0.0) continue;
+			bn /= bl;
+			// el peso alto mantiene la silueta de los bordes abiertos
+			Quadric q = Quadric::plane(bn, -glm::dot(bn, groupPos[u]), 10.0);
+			quadrics[u] += q;
+			quadrics[v] += q;
+		}
+	}
+
+	struct Collapse {
+		double cost;
+		unsigned int from, to;
+		unsigned int fromVersion, toVersion;
+		bool operator<(const Collapse& o) const { return cost > o.cost; } // min-heap
+	};
+	priority_queue<Collapse> heap;
+	vector<unsigned int> version(groupCount, 0);
+	vector<char> groupAlive(groupCount, 1);
+
+	auto pushEdges = [&](unsigned int g) {
+		for (unsigned int t : groupTriangles[g]) {
+			if (!triangleAlive[t]) continue;
+			for (int k = 0; k < 3; k++) {
+				unsigned int h = corners[t * 3 + k];
+				if (h == g) continue;
+				Quadric q = quadrics[g];
+				q += quadrics[h];
+				heap.push(Collapse{ q.error(groupPos[h]), g, h, version[g], version[h] });
+				heap.push(Collapse{ q.error(groupPos[g]), h, g, version[h], version[g] });
+			}
+		}
+	};
+	for (unsigned int g = 0; g < groupCount; g++) pushEdges(g);
+
+	double maxCost = (double)maxError * (double)maxError;
+	vector<unsigned int> scratch;
+	while (aliveTriangles * 3 > targetIndexCount && !heap.empty()) {
+		Collapse c = heap.top();
+		heap.pop();
+		if (!groupAlive[c.from] || !groupAlive[c.to] || c.fromVersion != version[c.from] || c.toVersion != version[c.to])
+			continue;
+		if (c.cost > maxCost) break;
+
+		// validar: arista manifold y ningún triángulo restante se voltea o degenera
+		unsigned int shared = 0;
+		bool valid = true;
+		const glm::dvec3& target = groupPos[c.to];
+		for (unsigned int t : groupTriangles[c.from]) {
+			if (!triangleAlive[t]) continue;
+			unsigned int* tri = &corners[t * 3];
+			if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) { shared++; continue; }
+			glm::dvec3 p[3], q[3];
+			for (int k = 0; k < 3; k++) {
+				p[k] = groupPos[tri[k]];
+				q[k] = tri[k] == c.from ? target : p[k];
+			}
+			glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			double lb = glm::length(before), la = glm::length(after);
+			if (la <= 1e-12 || (lb > 0.0 && glm::dot(before, after) < 0.2 * lb * la)) { valid = false; break; }
+		}
+		if (!valid || shared == 0 || shared > 2) continue;
+
+		// aplicar
+		groupAlive[c.from] = 0;
+		quadrics[c.to] += quadrics[c.from];
+		scratch.clear();
+		for (unsigned int t : groupTriangles[c.to])
+			if (triangleAlive[t]) scratch.push_back(t);
+		for (unsigned int t : groupTriangles[c.from]) {
+			if (!triangleAlive[t]) continue;
+			unsigned int* tri = &corners[t * 3];
+			if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+				triangleAlive[t] = 0;
+				aliveTriangles--;
+				continue;
+			}
+			for (int k = 0; k < 3; k++)
+				if (tri[k] == c.from) tri[k] = c.to;
+			scratch.push_back(t);
+		}
+		groupTriangles[c.to].swap(scratch);
+		groupTriangles[c.from].clear();
+		version[c.to]++;
+		resultError = std::max(resultError, (float)sqrt(c.cost));
+		pushEdges(c.to);
+	}
+
+	// de grupos a vértices: se conserva la variante original o la más parecida del grupo destino
+	vector<unsigned int> result;
+	result.reserve(aliveTriangles * 3);
+	for (size_t t = 0; t < triangleCount; t++) {
+		if (!triangleAlive[t]) continue;
+		for (int k = 0; k < 3; k++) {
+			unsigned int original = indices[t * 3 + k];
+			unsigned int group = corners[t * 3 + k];
+			if (vertexGroup[original] == group) { result.push_back(original); continue; }
+			const Vertex& ref = vertices[original];
+			unsigned int best = groupWedges[group][0];
+			float bestDistance = 1e30f;
+			for (unsigned int w : groupWedges[group]) {
+				glm::vec3 dn = vertices[w].Normal - ref.Normal;
+				glm::vec2 duv = vertices[w].TexCoords - ref.TexCoords;
+				float d = glm::dot(dn, dn) + glm::dot(duv, duv);
+				if (d < bestDistance) { bestDistance = d; best = w; }
+			}
+			result.push_back(best);
+		}
+	}
+	return result;
+}
+
+/**
+ * @brief Agrega a indices la cadena de LODs de la malla (cada nivel con la mitad de triángulos)
+ * indices debe contener sólo LOD0 al entrar; al salir contiene todos los niveles concatenados.
+ */
+inline void GenerateLodChain(const vector<Vertex>& vertices, vector<unsigned int>& indices, vector<MeshLod>& lods)
+{
+	lods.clear();
+	lods.push_back(MeshLod{ 0, (unsigned int)indices.size(), 0.0f });
+	if (indices.size() < 3 * 64) return; // mallas pequeñas: no vale la pena
+
+	glm::vec3 minP(1e30f), maxP(-1e30f);
+	for (const Vertex& v : vertices) { minP = glm::min(minP, v.Position); maxP = glm::max(maxP, v.Position); }
+	float radius = 0.5f * glm::length(maxP - minP);
+	float maxError = 0.25f * radius; // más allá la forma ya no se reconoce
+
+	vector<unsigned int> previous(indices.begin(), indices.end());
+	float accumulatedError = 0.0f;
+	for (unsigned int level = 1; level < MAX_MESH_LODS; level++) {
+		float error;
+		vector<unsigned int> simplified = SimplifyMesh(vertices, previous, previous.size() / 2, maxError - accumulatedError, error);
+		// si ya no se reduce lo suficiente se corta la cadena
+		if (simplified.empty() || simplified.size() > previous.size() * 85 / 100) break;
+		OptimizeVertexCache(simplified, vertices.size());
+
+		accumulatedError += error;
+		lods.push_back(MeshLod{ (unsigned int)indices.size(), (unsigned int)simplified.size(), accumulatedError });
+		indices.insert(indices.end(), simplified.begin(), simplified.end());
+		previous.swap(simplified);
+	}
+}
+
+#endif
@@ -4,24 +4,44 @@
 #include <glm/gtx/string_cast.hpp>
 
 #include <modelstructs.h>
+#include <meshimport.h>
+#include <modelbake.h>
+#include <texturecache.h>
+#include <loadprofiler.h>
+
+#include <memory>
+
+// NUEVO: MODEL_LOAD_DEFERRED deja la carga a importModel()/uploadModel() (ver TaskGraph)
+enum ModelLoadMode {
+	MODEL_LOAD_NOW,
+	MODEL_LOAD_DEFERRED
+};
 
 class Model
 {
 public:
 	/*  Model Data */
-	vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
-	vector<Mesh> meshes;
+	vector<Texture> textures_loaded;	// one entry per reference taken from TextureCache; released in the destructor
+	vector<StaticMesh> meshes;                     // posición, normal y UV
+	vector<StaticTangentMesh> normalMappedMeshes;  // + tangente, sólo mallas con mapa de normales
 	string directory;
 	bool gammaCorrection;
 
+	/* LOD data */
+	glm::vec3 boundingCenter;    // esfera envolvente en espacio del modelo
+	float boundingRadius;
+	vector<float> lodErrors;     // error de cada nivel de detalle del modelo completo (peor malla)
+
 	string filename;
 
 	/* Bones data */
 	vector<Bone> bones;
 
-	/* Scene data */
-	Assimp::Importer importer;
-	const aiScene* scene;
+	/* Animation data: copia propia, la escena de Assimp se libera al terminar la importación */
+	NodeHierarchy nodes;
+	vector<AnimationClip> animations;
+	vector<int32_t> boneNodes;     // nodo de cada hueso en la jerarquía (-1 si no está)
+	vector<glm::mat4> nodeGlobals; // transformaciones globales de la última pose
 
 	map<string, unsigned int> m_BoneMapping; // maps a bone name to its index
 	unsigned int m_NumBones;
@@ -42,24 +62,156 @@ public:
 
 	/*  Functions   */
 	// constructor, expects a filepath to a 3D model.
-	Model(string const& path, bool gamma = false) : gammaCorrection(gamma)
+	Model(string const& path, bool gamma = false, ModelLoadMode mode = MODEL_LOAD_NOW) : gammaCorrection(gamma), boundingCenter(0.0f), boundingRadius(0.0f), m_NumBones(0)
 	{
-		loadModel(path);
+		filename = path;
+		// retrieve the directory path of the filepath
+		directory = path.substr(0, path.find_last_of('/'));
+
+		if (mode == MODEL_LOAD_NOW) {
+			importModel();
+			uploadModel();
+		}
 	}
 
-	// draws the model, and thus all its meshes
-	void Draw(Shader shader)
+	/**
+	 * @brief Etapa de CPU de la carga: lee el bake o importa con Assimp y convierte las mallas
+	 * No toca GL, así que puede correr en un hilo de trabajo. Después hay que llamar uploadModel().
+	 */
+	bool importModel()
+	{
+		pending.reset(new PendingImport());
+		pending->scene = nullptr;
+
+		// NUEVO: si hay un bake al día se evita Assimp por completo
+		{
+			ScopedLoadTimer timer(filename, "bake read");
+			pending->fromBake = LoadModelBake(filename, pending->baked);
+			if (pending->fromBake) timer.addBytes(LOAD_BYTES_FILE, pending->baked.file.size());
+		}
+		if (pending->fromBake && !BakeHasMeshesFor(pending->baked, false)) {
+			cout << "BAKE:: " << GetBakePath(filename) << " only has skinned meshes, reimporting" << endl;
+			pending->fromBake = false;
+		}
+		if (pending->fromBake)
+			return true;
+
+		// read file via ASSIMP; the importer (and the whole aiScene) is freed at the end of uploadModel()
+		pending->importer.reset(new Assimp::Importer());
+		const aiScene* scene;
+		{
+			ScopedLoadTimer timer(filename, "assimp parse");
+			scene = pending->importer->ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+		}
+		// check for errors
+		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
+		{
+			cout << "ERROR::ASSIMP:: " << pending->importer->GetErrorString() << endl;
+			pending.reset();
+			return false;
+		}
+		pending->scene = scene;
+
+		aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
+		inverseTransform.Inverse();
+		m_GlobalInverseTransform = aiMatrix4x4ToGlm(inverseTransform);
+
+		// CPU stage of every mesh, concurrently on the job system
+		{
+			ScopedLoadTimer timer(filename, "mesh convert");
+			pending->meshData = ConvertSceneMeshes(scene->mRootNode, scene, true);
+		}
+
+		// NUEVO: Cargar materiales
+		loadMaterials(scene);
+
+		// NUEVO: Jerarquía y animaciones propias para no depender del aiScene después de cargar
+		BuildNodeHierarchy(scene->mRootNode, -1, nodes);
+		animations = BuildAnimationClips(scene, nodes);
+		return true;
+	}
+
+	/**
+	 * @brief Etapa de GL de la carga: pide las texturas y sube los buffers de las mallas
+	 * Sólo en el hilo del contexto y después de importModel(); si la importación falló no hace nada.
+	 */
+	void uploadModel()
+	{
+		if (!pending) return;
+
+		{
+			ScopedLoadTimer timer(filename, "mesh upload");
+			if (pending->fromBake) {
+				uploadBakedModel(pending->baked);
+			}
+			else {
+				// the GL stage loads the textures and uploads the converted buffers in one pass
+				for (MeshData& data : pending->meshData)
+					processMesh(data, pending->scene);
+				boneNodes = MapBonesToNodes(bones, nodes);
+			}
+			for (const StaticMesh& m : meshes) {
+				timer.addBytes(LOAD_BYTES_VERTEX, m.gpuVertexBytes());
+				timer.addBytes(LOAD_BYTES_INDEX, m.gpuIndexBytes());
+			}
+			for (const StaticTangentMesh& m : normalMappedMeshes) {
+				timer.addBytes(LOAD_BYTES_VERTEX, m.gpuVertexBytes());
+				timer.addBytes(LOAD_BYTES_INDEX, m.gpuIndexBytes());
+			}
+		}
+
+		if (!pending->fromBake) {
+			ScopedLoadTimer timer(filename, "bake write");
+
+			// NUEVO: Guardar el bake para el siguiente arranque
+			vector<BakedMaterial> bakedMaterials;
+			for (const MaterialProperties& m : materials)
+				bakedMaterials.push_back({ m.ambient, m.diffuse, m.specular, m.metallic, m.roughness, m.ior, m.alpha });
+			vector<BakeMeshSource> bakeMeshes;
+			AddBakeMeshes(bakeMeshes, meshes);
+			AddBakeMeshes(bakeMeshes, normalMappedMeshes);
+			WriteModelBake(filename, nodes, animations, bakeMeshes, bakedMaterials, bones, m_GlobalInverseTransform);
+		}
+
+		// libera el aiScene o el mapeo del bake
+		pending.reset();
+		computeLodInfo();
+	}
+
+	// draws the model, and thus all its meshes, at the given level of detail
+	void Draw(Shader shader, unsigned int lod = 0)
 	{
 		for (unsigned int i = 0; i < meshes.size(); i++)
-			meshes[i].Draw(shader);
+			meshes[i].Draw(shader, lod);
+		for (unsigned int i = 0; i < normalMappedMeshes.size(); i++)
+			normalMappedMeshes[i].Draw(shader, lod);
+		GeometryPool::instance().unbind();
+	}
+
+	unsigned int getLodCount() const { return (unsigned int)lodErrors.size(); }
+
+	float getLodError(unsigned int lod) const {
+		if (lodErrors.empty()) return 0.0f;
+		return lodErrors[lod < lodErrors.size() ? lod : lodErrors.size() - 1];
+	}
+
+	// returns the geometry of every mesh to the pool
+	~Model()
+	{
+		for (StaticMesh& mesh : meshes) mesh.release();
+		for (StaticTangentMesh& mesh : normalMappedMeshes) mesh.release();
+		for (const Texture& texture : textures_loaded) TextureCache::instance().release(texture.id);
 	}
 
 	// update transformations in time 
 	void SetPose(float time, glm::mat4* gBones) {
 
-		// processNode(scene->mRootNode, time);
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, scene->mRootNode, n_matrix);
+		if (animations.empty()) return;
+		EvaluateNodeGlobals(nodes, animations[0], time, nodeGlobals);
+		for (unsigned int b = 0; b < bones.size(); b++) {
+			if (boneNodes[b] >= 0)
+				bones[b].transformation = m_GlobalInverseTransform * nodeGlobals[boneNodes[b]] * bones[b].offsetMatrix;
+		}
 
 		for (unsigned int i = 0; i < bones.size(); i++) {
 			if (i < 100) {
@@ -73,23 +225,21 @@ public:
 	// Return the duration of the animation in ticks (frames)
 	double getNumFrames() {
 
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-		if (pAnimation == nullptr) return -1.0;
+		if (animations.empty()) return -1.0;
 
-		cout << "Animation total frames:" << pAnimation->mDuration << endl;
+		cout << "Animation total frames:" << animations[0].duration << endl;
 
-		return pAnimation->mDuration;
+		return animations[0].duration;
 
 	}
 
 	// return the number of ticks per second
 	double getFramerate() {
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-		if (pAnimation == nullptr) return -1.0;
+		if (animations.empty()) return -1.0;
 
-		cout << "Animation framerate:" << pAnimation->mTicksPerSecond << " fps" << endl;
+		cout << "Animation framerate:" << animations[0].ticksPerSecond << " fps" << endl;
 
-		return  pAnimation->mTicksPerSecond;
+		return  animations[0].ticksPerSecond;
 	}
 
 	// NUEVO: Obtener material por índice
@@ -125,511 +275,152 @@ private:
 		return to;
 	}
 
-	// loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
-	void loadModel(string const& path)
-	{
-		// read file via ASSIMP
-		scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
-		// check for errors
-		if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
-		{
-			cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl;
-			return;
-		}
-		filename = path;
-		// retrieve the directory path of the filepath
-		directory = path.substr(0, path.find_last_of('/'));
-
-		aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
-		inverseTransform.Inverse();
-		m_GlobalInverseTransform = aiMatrix4x4ToGlm(inverseTransform);
-
-		// process ASSIMP's root node recursively
-		processNode(scene->mRootNode, scene);
-
-		// NUEVO: Cargar materiales
-		loadMaterials(scene);
-	}
-
-	// NUEVO: Cargar propiedades de materiales desde Assimp
-	void loadMaterials(const aiScene* scene) {
-		materials.clear();
-
-		for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
-			aiMaterial* mat = scene->mMaterials[i];
-			MaterialProperties matProps;
-
-			// Cargar colores
-			aiColor3D color;
-			if (mat->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS) {
-				matProps.ambient = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
-			}
-
-			if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
-				matProps.diffuse = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
-			}
-
-			if (mat->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS) {
-				matProps.specular = glm::vec4(color.r, color.g, color.b, 1.0f);
-			}
-			else {
-				matProps.specular = glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
-			}
-
-			// Cargar propiedades PBR
-			float value;
-			if (mat->Get(AI_MATKEY_METALLIC_FACTOR, value) == AI_SUCCESS) {
-				matProps.metallic = value;
-			}
-			else {
-				matProps.metallic = 0.0f;
-			}
-
-			if (mat->Get(AI_MATKEY_ROUGHNESS_FACTOR, value) == AI_SUCCESS) {
-				matProps.roughness = value;
-			}
-			else {
-				matProps.roughness = 0.5f;
-			}
-
-			if (mat->Get(AI_MATKEY_REFRACTI, value) == AI_SUCCESS) {
-				matProps.ior = value;
-			}
-			else {
-				matProps.ior = 1.45f;
-			}
-
-			// Cargar transparencia (Alpha)
-			if (mat->Get(AI_MATKEY_OPACITY, value) == AI_SUCCESS) {
-				matProps.alpha = value;
-			}
-			else {
-				matProps.alpha = 1.0f;
-			}
-
-			materials.push_back(matProps);
-		}
-	}
-
-	void processNode(aiNode* node, float time) {
-
-		if (node == nullptr) return;
-
-		glm::mat4 n_matrix(1.0f);
-		ReadNodeHierarchy(time, node, n_matrix);
-
-	}
-
-	// processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-	void processNode(aiNode* node, const aiScene* scene)
-	{
-		// cout << node->mName.data << endl;
-		// cout << "Meshes: " << node->mNumMeshes << endl;
-		// process each mesh located at the current node
-		for (unsigned int i = 0; i < node->mNumMeshes; i++)
-		{
-			// the node object only contains indices to index the actual objects in the scene. 
-			// the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
-			aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-			// cout << "Mesh: " << mesh->mName.data << endl;
-			meshes.push_back(processMesh(mesh, scene));
-		}
-		// after we've processed all of the meshes (if any) we then recursively process each of the children nodes
-		for (unsigned int i = 0; i < node->mNumChildren; i++)
-		{
-			processNode(node->mChildren[i], scene);
-		}
-
-	}
+	// NUEVO: estado entre importModel() y uploadModel()
+	struct PendingImport {
+		bool                         fromBake;
+		BakedModel                   baked;
+		unique_ptr<Assimp::Importer> importer;
+		const aiScene*               scene;
+		vector<MeshData>             meshData; // mallas convertidas, listas para subir
+	};
+	unique_ptr<PendingImport> pending;
 
-	Mesh processMesh(aiMesh* mesh, const aiScene* scene)
+	// NUEVO: Carga desde el formato binario (.mhbake); los vértices se suben directo desde el mmap
+	void uploadBakedModel(BakedModel& baked)
 	{
-		// data to fill
-		vector<Vertex> vertices;
-		vector<unsigned int> indices;
-		vector<Texture> textures;
-
-		// Walk through each of the mesh's vertices
-		for (unsigned int i = 0; i < mesh->mNumVertices; i++)
-		{
-			Vertex vertex;
-			glm::vec3 vector;
-
-			// positions
-			vector.x = mesh->mVertices[i].x;
-			vector.y = mesh->mVertices[i].y;
-			vector.z = mesh->mVertices[i].z;
-			vertex.Position = vector;
-
-			// normals
-			vector.x = mesh->mNormals[i].x;
-			vector.y = mesh->mNormals[i].y;
-			vector.z = mesh->mNormals[i].z;
-			vertex.Normal = vector;
-
-			// texture coordinates
-			if (mesh->mTextureCoords[0])
-			{
-				glm::vec2 vec;
-				vec.x = mesh->mTextureCoords[0][i].x;
-				vec.y = mesh->mTextureCoords[0][i].y;
-				vertex.TexCoords = vec;
-			}
-			else
-				vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-
-			// tangent
-			vector.x = mesh->mTangents[i].x;
-			vector.y = mesh->mTangents[i].y;
-			vector.z = mesh->mTangents[i].z;
-			vertex.Tangent = vector;
-
-			// bitangent
-			vector.x = mesh->mBitangents[i].x;
-			vector.y = mesh->mBitangents[i].y;
-			vector.z = mesh->mBitangents[i].z;
-			vertex.Bitangent = vector;
-
-			// Bones
-			int bcount = 0;
-			for (unsigned int pb = 0; pb < MAX_NUM_BONES; pb++) {
-				vertex.IDs1[pb] = 0.0f;
-				vertex.IDs2[pb] = 0.0f;
-				vertex.IDs3[pb] = 0.0f;
-				vertex.Weights1[pb] = 0.0f;
-				vertex.Weights2[pb] = 0.0f;
-				vertex.Weights3[pb] = 0.0f;
-			}
-			m_NumBones = mesh->mNumBones;
-			for (unsigned int j = 0; j < mesh->mNumBones; j++) {
-
-				for (unsigned int k = 0; k < mesh->mBones[j]->mNumWeights; k++) {
-					unsigned int VertexID = mesh->mBones[j]->mWeights[k].mVertexId;
-					float Weight = (float)(mesh->mBones[j]->mWeights[k].mWeight);
-					if (VertexID == i && bcount < MAX_NUM_BONES) {
-						vertex.IDs1[bcount] = (float)j;
-						vertex.Weights1[bcount] = Weight;
-						bcount++;
-					}
-					if (VertexID == i && bcount >= MAX_NUM_BONES && bcount < 2 * MAX_NUM_BONES) {
-						vertex.IDs2[bcount - MAX_NUM_BONES] = (float)j;
-						vertex.Weights2[bcount - MAX_NUM_BONES] = Weight;
-						bcount++;
-					}
-					if (VertexID == i && bcount >= 2 * MAX_NUM_BONES && bcount < 3 * MAX_NUM_BONES) {
-						vertex.IDs3[bcount - 2 * MAX_NUM_BONES] = (float)j;
-						vertex.Weights3[bcount - 2 * MAX_NUM_BONES] = Weight;
-						bcount++;
-					}
-				}
-			}
-			vertices.push_back(vertex);
+		materials.clear();
+		for (const BakedMaterial& m : baked.materials)
+			materials.push_back({ m.ambient, m.diffuse, m.specular, m.metallic, m.roughness, m.ior, m.alpha });
+
+		for (const BakedMesh& bm : baked.meshes) {
+			vector<Texture> textures = loadTextures(bm.textures, bm.materialIndex);
+			if (bm.vertexFormat == VERTEX_FORMAT_STATIC_TANGENT)
+				normalMappedMeshes.push_back(StaticTangentMesh((const StaticTangentVertex*)bm.vertices, bm.vertexCount, bm.indices, bm.indexCount, bm.indexType, textures, bm.materialIndex, bm.lods));
+			else if (bm.vertexFormat == VERTEX_FORMAT_STATIC)
+				meshes.push_back(StaticMesh((const StaticVertex*)bm.vertices, bm.vertexCount, bm.indices, bm.indexCount, bm.indexType, textures, bm.materialIndex, bm.lods));
 		}
 
-		// Process Bones
 		bones.clear();
-		for (unsigned int i = 0; i < mesh->mNumBones; i++) {
-			Bone  newBone;
-			newBone.name = mesh->mBones[i]->mName;
-			newBone.offsetMatrix = aiMatrix4x4ToGlm(mesh->mBones[i]->mOffsetMatrix);
-			newBone.transformation = glm::mat4(1.0f);
-
-			for (unsigned int j = 0; j < mesh->mBones[i]->mNumWeights; j++) {
-				unsigned int VertexID = mesh->mBones[i]->mWeights[j].mVertexId;
-				float Weight = mesh->mBones[i]->mWeights[j].mWeight;
-				newBone.push(VertexID, Weight);
-			}
-
-			bones.push_back(newBone);
+		for (const BakedBone& bb : baked.bones) {
+			Bone bone;
+			bone.name = bb.name;
+			bone.offsetMatrix = bb.offsetMatrix;
+			bones.push_back(bone);
 		}
+		m_NumBones = (unsigned int)bones.size();
+		m_GlobalInverseTransform = baked.globalInverseTransform;
 
-		// Process faces
-		for (unsigned int i = 0; i < mesh->mNumFaces; i++)
-		{
-			aiFace face = mesh->mFaces[i];
-			for (unsigned int j = 0; j < face.mNumIndices; j++)
-				indices.push_back(face.mIndices[j]);
-		}
-
-		// process materials
-		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-		// 1. diffuse maps
-		vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse");
-		textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-
-		// 2. specular maps
-		vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular");
-		textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
-
-		// 3. normal maps
-		std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal");
-		textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
-
-		// 4. height maps
-		std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height");
-		textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
-
-		return Mesh(vertices, indices, textures);
+		nodes = std::move(baked.nodes);
+		animations = std::move(baked.animations);
+		boneNodes = MapBonesToNodes(bones, nodes);
+		cout << "Model loaded from bake: " << GetBakePath(filename) << endl;
 	}
 
-	void ReadNodeHierarchy(float AnimationTime, const aiNode* pNode, const glm::mat4& ParentTransform)
+	// NUEVO: Esfera envolvente y error por nivel de detalle; un nivel del modelo usa ese nivel en cada malla
+	// (o el más burdo que tenga), así que su error es el peor de sus mallas.
+	void computeLodInfo()
 	{
-		if (pNode == nullptr || scene == nullptr) return;
-
-		string NodeName(pNode->mName.data);
-
-		const aiAnimation* pAnimation = scene->mAnimations[0];
-
-		//cout << NodeName << endl;
-
-		if (pAnimation == nullptr) return;
-
-		//cout << "valid animation" << endl;
-
-		//aiMatrix4x4 NodeTransformation(pNode->mTransformation);
-		aiMatrix4x4 NodeTransformation;
-
-		const aiNodeAnim* pNodeAnim = FindNodeAnim(pAnimation, NodeName);
-
-		if (pNodeAnim != nullptr) {
-			aiVector3D Scaling;
-			CalcInterpolatedScaling(Scaling, AnimationTime, pNodeAnim);
-			aiMatrix4x4 ScalingM;
-			if (ScalingM.IsIdentity())
-				aiMatrix4x4::Scaling(Scaling, ScalingM);
-
-			aiQuaternion RotationQ;
-			CalcInterpolatedRotation(RotationQ, AnimationTime, pNodeAnim);
-			aiMatrix4x4 RotationM(RotationQ.GetMatrix());
-
-			aiVector3D Translation;
-			CalcInterpolatedPosition(Translation, AnimationTime, pNodeAnim);
-			aiMatrix4x4 TranslationM;
-			if (ScalingM.IsIdentity())
-				aiMatrix4x4::Translation(Translation, TranslationM);
-
-			// Combine the above transformations
-			NodeTransformation = TranslationM * RotationM * ScalingM;
-
-			// cout << "Compute Node Transformation: " << pNodeAnim->mNodeName.data << endl;
-		}
-
-		glm::mat4 GlobalTransformation = ParentTransform * aiMatrix4x4ToGlm(NodeTransformation);
-
-		//cout << "GT=" << glm::to_string(GlobalTransformation) << endl;
-
-		// cout << "Parent: " << NodeName << endl;
-
-		// Modify bones transformation
-		for (unsigned int b = 0; b < bones.size(); b++) {
-			if (bones[b].name == pNode->mName) {
-				bones[b].transformation = m_GlobalInverseTransform * GlobalTransformation * bones[b].offsetMatrix;
-				//cout << "bone: " << b << " : " << bones[b].name.data << " T= " << glm::to_string(bones[b].transformation) << endl;
-			}
-		}
-
-		for (unsigned int i = 0; i < pNode->mNumChildren; i++) {
-			// cout << "Child: " << pNode->mChildren[i]->mName.data << ": " << i << endl;
-			ReadNodeHierarchy(AnimationTime, pNode->mChildren[i], GlobalTransformation);
-		}
-	}
-
-	const aiNodeAnim* FindNodeAnim(const aiAnimation* pAnimation, const string NodeName)
-	{
-		for (unsigned int i = 0; i < pAnimation->mNumChannels; i++) {
-			const aiNodeAnim* pNodeAnim = pAnimation->mChannels[i];
-
-			if (string(pNodeAnim->mNodeName.data) == NodeName) {
-				return pNodeAnim;
-			}
-		}
-
-		return nullptr;
-	}
-
-
-	void CalcInterpolatedScaling(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		if (pNodeAnim->mNumScalingKeys == 1) {
-			Out = pNodeAnim->mScalingKeys[0].mValue;
-			return;
-		}
-
-		unsigned int ScalingIndex = FindScaling(AnimationTime, pNodeAnim);
-		unsigned int NextScalingIndex = (ScalingIndex + 1);
-		assert(NextScalingIndex < pNodeAnim->mNumScalingKeys);
-		float DeltaTime = (float)(pNodeAnim->mScalingKeys[NextScalingIndex].mTime - pNodeAnim->mScalingKeys[ScalingIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mScalingKeys[ScalingIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mScalingKeys[ScalingIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mScalingKeys[NextScalingIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
-	}
-
-	unsigned int FindScaling(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		assert(pNodeAnim->mNumScalingKeys > 0);
-
-		for (unsigned int i = 0; i < pNodeAnim->mNumScalingKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mScalingKeys[i + 1].mTime) {
-				return i;
-			}
-		}
-
-		assert(0);
-
-		return 0;
-	}
+		glm::vec3 minP(1e30f), maxP(-1e30f);
+		unsigned int levels = 1;
+		auto visit = [&](const vector<MeshLod>& lods, const glm::vec3& meshMin, const glm::vec3& meshMax) {
+			minP = glm::min(minP, meshMin);
+			maxP = glm::max(maxP, meshMax);
+			levels = std::max(levels, (unsigned int)lods.size());
+		};
+		for (const StaticMesh& m : meshes) visit(m.lods, m.boundsMin, m.boundsMax);
+		for (const StaticTangentMesh& m : normalMappedMeshes) visit(m.lods, m.boundsMin, m.boundsMax);
+		if (minP.x > maxP.x) return;
 
-	void CalcInterpolatedRotation(aiQuaternion& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		// we need at least two values to interpolate...
-		if (pNodeAnim->mNumRotationKeys == 1) {
-			Out = pNodeAnim->mRotationKeys[0].mValue;
-			return;
-		}
+		boundingCenter = 0.5f * (minP + maxP);
+		boundingRadius = 0.5f * glm::length(maxP - minP);
 
-		unsigned int RotationIndex = FindRotation(AnimationTime, pNodeAnim);
-		unsigned int NextRotationIndex = (RotationIndex + 1);
-		assert(NextRotationIndex < pNodeAnim->mNumRotationKeys);
-		float DeltaTime = (float)(pNodeAnim->mRotationKeys[NextRotationIndex].mTime - pNodeAnim->mRotationKeys[RotationIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mRotationKeys[RotationIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiQuaternion& StartRotationQ = pNodeAnim->mRotationKeys[RotationIndex].mValue;
-		const aiQuaternion& EndRotationQ = pNodeAnim->mRotationKeys[NextRotationIndex].mValue;
-		aiQuaternion::Interpolate(Out, StartRotationQ, EndRotationQ, Factor);
-		Out = Out.Normalize();
+		lodErrors.assign(levels, 0.0f);
+		auto accumulate = [&](const vector<MeshLod>& lods) {
+			for (unsigned int l = 0; l < levels; l++)
+				lodErrors[l] = std::max(lodErrors[l], lods[std::min<size_t>(l, lods.size() - 1)].error);
+		};
+		for (const StaticMesh& m : meshes) accumulate(m.lods);
+		for (const StaticTangentMesh& m : normalMappedMeshes) accumulate(m.lods);
 	}
 
-	unsigned int FindRotation(float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		assert(pNodeAnim->mNumRotationKeys > 0);
+	// NUEVO: Cargar propiedades de materiales desde Assimp (ver ReadBakedMaterial)
+	void loadMaterials(const aiScene* scene) {
+		materials.clear();
 
-		for (unsigned int i = 0; i < pNodeAnim->mNumRotationKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mRotationKeys[i + 1].mTime) {
-				return i;
-			}
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++) {
+			BakedMaterial m = ReadBakedMaterial(scene->mMaterials[i]);
+			materials.push_back({ m.ambient, m.diffuse, m.specular, m.metallic, m.roughness, m.ior, m.alpha });
 		}
-
-		assert(0);
-
-		return 0;
 	}
 
-	unsigned int FindPosition(float AnimationTime, const aiNodeAnim* pNodeAnim)
+	// GL stage for one converted mesh (must run on the thread that owns the context).
+	// Static geometry drops the bone data; the tangent is kept only when there is a normal map to use it.
+	void processMesh(MeshData& data, const aiScene* scene)
 	{
-		for (unsigned int i = 0; i < pNodeAnim->mNumPositionKeys - 1; i++) {
-			if (AnimationTime < (float)pNodeAnim->mPositionKeys[i + 1].mTime) {
-				return i;
-			}
-		}
+		// bones of the last processed mesh are kept, as before
+		m_NumBones = (unsigned int)data.bones.size();
+		bones = std::move(data.bones);
+		if (m_NumBones > 0)
+			cout << "Mesh " << data.source->mName.C_Str() << ": " << data.boneStats << endl;
+		cout << "Mesh " << data.source->mName.C_Str() << ": " << data.optimizeStats << endl;
 
-		assert(0);
+		const aiMesh* mesh = data.source;
 
-		return 0;
-	}
-
-	void CalcInterpolatedPosition(aiVector3D& Out, float AnimationTime, const aiNodeAnim* pNodeAnim)
-	{
-		if (pNodeAnim->mNumPositionKeys == 1) {
-			Out = pNodeAnim->mPositionKeys[0].mValue;
-			return;
+		// process materials: diffuse (or a solid color), specular, normal and height maps
+		aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+		vector<BakedTextureRef> refs = CollectMaterialTextureRefs(material, true);
+		vector<Texture> textures = loadTextures(refs, data.materialIndex);
+		bool hasNormalMap = false;
+		for (const Texture& texture : textures)
+			hasNormalMap = hasNormalMap || texture.type == "texture_normal";
+
+		if (data.lods.size() > 1) {
+			cout << "Mesh " << mesh->mName.C_Str() << ": LOD triangles";
+			for (const MeshLod& lod : data.lods) cout << " " << lod.indexCount / 3 << " (err " << lod.error << ")";
+			cout << endl;
 		}
 
-		unsigned int PositionIndex = FindPosition(AnimationTime, pNodeAnim);
-		unsigned int NextPositionIndex = (PositionIndex + 1);
-		assert(NextPositionIndex < pNodeAnim->mNumPositionKeys);
-		float DeltaTime = (float)(pNodeAnim->mPositionKeys[NextPositionIndex].mTime - pNodeAnim->mPositionKeys[PositionIndex].mTime);
-		float Factor = (AnimationTime - (float)pNodeAnim->mPositionKeys[PositionIndex].mTime) / DeltaTime;
-		assert(Factor >= 0.0f && Factor <= 1.0f);
-		const aiVector3D& Start = pNodeAnim->mPositionKeys[PositionIndex].mValue;
-		const aiVector3D& End = pNodeAnim->mPositionKeys[NextPositionIndex].mValue;
-		aiVector3D Delta = End - Start;
-		Out = Start + Factor * Delta;
+		if (hasNormalMap)
+			normalMappedMeshes.push_back(StaticTangentMesh(ConvertVertices<StaticTangentVertex>(data.vertices), std::move(data.indices), textures, data.materialIndex, std::move(data.lods)));
+		else
+			meshes.push_back(StaticMesh(ConvertVertices<StaticVertex>(data.vertices), std::move(data.indices), textures, data.materialIndex, std::move(data.lods)));
 	}
 
-	// checks all material textures of a given type and loads the textures if they're not loaded yet.
-	// the required info is returned as a Texture struct.
-	vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
+	// loads the textures a mesh refers to; "procedural_color" becomes a 1x1 texture with the material's diffuse color
+	vector<Texture> loadTextures(const vector<BakedTextureRef>& refs, unsigned int materialIndex)
 	{
 		vector<Texture> textures;
-		unsigned int textureCount = mat->GetTextureCount(type);
-
-		// Si no hay texturas de este tipo, intentar usar color del material
-		if (textureCount == 0 && typeName == "texture_diffuse") {
-			aiColor3D color;
-			if (mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
+		for (const BakedTextureRef& ref : refs) {
+			if (ref.path == "procedural_color") {
+				glm::vec4 d = getMaterial(materialIndex).diffuse;
 				Texture colorTexture;
-				colorTexture.id = createSolidColorTexture(color);
-				colorTexture.type = typeName;
-				colorTexture.path = "procedural_color";
-
+				colorTexture.id = createSolidColorTexture(aiColor3D(d.r, d.g, d.b));
+				colorTexture.type = ref.type;
+				colorTexture.path = ref.path;
 				textures.push_back(colorTexture);
 				textures_loaded.push_back(colorTexture);
-
-				return textures;
 			}
-		}
-
-		for (unsigned int i = 0; i < textureCount; i++)
-		{
-			aiString str;
-			mat->GetTexture(type, i, &str);
-
-			bool skip = false;
-			for (unsigned int j = 0; j < textures_loaded.size(); j++)
-			{
-				if (std::strcmp(textures_loaded[j].path.data(), str.C_Str()) == 0)
-				{
-					textures.push_back(textures_loaded[j]);
-					skip = true;
-					break;
-				}
-			}
-			if (!skip)
-			{
-				Texture texture;
-				texture.id = TextureFromFile(str.C_Str(), this->directory);
-				texture.type = typeName;
-				texture.path = str.C_Str();
-				textures.push_back(texture);
-				textures_loaded.push_back(texture);
+			else {
+				textures.push_back(loadTexture(ref.path.c_str(), ref.type));
 			}
 		}
-
 		return textures;
 	}
 
-	// NUEVO: Crear textura de 1x1 píxel con color sólido
-	unsigned int createSolidColorTexture(const aiColor3D& color) {
-		unsigned int textureID;
-		glGenTextures(1, &textureID);
-
-		// Convertir color a bytes (0-255)
-		unsigned char data[4] = {
-			static_cast<unsigned char>(color.r * 255.0f),
-			static_cast<unsigned char>(color.g * 255.0f),
-			static_cast<unsigned char>(color.b * 255.0f),
-			255 // Alpha
-		};
-
-		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	// takes a reference to the texture in the process-wide cache; it's only loaded the first time any model asks for it
+	Texture loadTexture(const char* path, const string& typeName)
+	{
+		Texture texture;
+		texture.id = TextureCache::instance().acquire(this->directory + '/' + path, false, TextureUsageForType(typeName));
+		texture.type = typeName;
+		texture.path = path;
+		textures_loaded.push_back(texture);
+		return texture;
+	}
 
-		return textureID;
+	// NUEVO: Crear textura de 1x1 píxel con color sólido (compartida entre modelos con el mismo color)
+	unsigned int createSolidColorTexture(const aiColor3D& color) {
+		return TextureCache::instance().acquireSolidColor(color.r, color.g, color.b);
 	}
 };
 
@@ -0,0 +1,648 @@
+#ifndef MODELBAKE_H
+#define MODELBAKE_H
+
+#include <glm/glm.hpp>
+#include <assimp/scene.h>
+
+#include <mesh.h>
+#include <geometrypool.h>
+#include <animationdata.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+using namespace std;
+
+// Formato binario "horneado" de un modelo (.mhbake junto al .fbx original).
+// Guarda exactamente lo que Model/AnimatedModel extraen de Assimp para que el
+// arranque sea un mmap y unos cuantos glBufferData en lugar de parsear el FBX.
+#define MODEL_BAKE_MAGIC     0x4B42484Du // "MHBK"
+#define MODEL_BAKE_VERSION   5u
+#define MODEL_BAKE_EXTENSION ".mhbake"
+
+/**
+ * @brief Archivo de solo lectura mapeado en memoria
+ */
+class MappedFile {
+public:
+	MappedFile() : ptr(nullptr), length(0) {
+#ifdef _WIN32
+		fileHandle = INVALID_HANDLE_VALUE;
+		mapHandle = NULL;
+#else
+		fd = -1;
+#endif
+	}
+
+	~MappedFile() { close(); }
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const string& path) {
+		close();
+#ifdef _WIN32
+		fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (fileHandle == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) { close(); return false; }
+		mapHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapHandle == NULL) { close(); return false; }
+		ptr = (const unsigned char*)MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+		if (ptr == nullptr) { close(); return false; }
+		length = (size_t)fileSize.QuadPart;
+#else
+		fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) { close(); return false; }
+		void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED) { close(); return false; }
+		ptr = (const unsigned char*)p;
+		length = (size_t)st.st_size;
+#endif
+		return true;
+	}
+
+	void close() {
+#ifdef _WIN32
+		if (ptr) UnmapViewOfFile(ptr);
+		if (mapHandle != NULL) CloseHandle(mapHandle);
+		if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+		mapHandle = NULL;
+		fileHandle = INVALID_HANDLE_VALUE;
+#else
+		if (ptr) munmap((void*)ptr, length);
+		if (fd >= 0) ::close(fd);
+		fd = -1;
+#endif
+		ptr = nullptr;
+		length = 0;
+	}
+
+	const unsigned char* data() const { return ptr; }
+	size_t size() const { return length; }
+
+private:
+	const unsigned char* ptr;
+	size_t length;
+#ifdef _WIN32
+	HANDLE fileHandle;
+	HANDLE mapHandle;
+#else
+	int fd;
+#endif
+};
+
+/**
+ * @brief Tamaño y fecha de modificación del archivo fuente (para detectar bakes obsoletos)
+ */
+struct BakeSourceStamp {
+	uint64_t size;
+	int64_t  mtime;
+};
+
+inline bool GetBakeSourceStamp(const string& path, BakeSourceStamp& stamp) {
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_stat64(path.c_str(), &st) != 0) return false;
+#else
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) return false;
+#endif
+	stamp.size = (uint64_t)st.st_size;
+	stamp.mtime = (int64_t)st.st_mtime;
+	return true;
+}
+
+// fopen está marcado como inseguro con /sdl
+inline FILE* OpenBakeFile(const string& path, const char* mode) {
+#ifdef _MSC_VER
+	FILE* f = nullptr;
+	if (fopen_s(&f, path.c_str(), mode) != 0) return nullptr;
+	return f;
+#else
+	return fopen(path.c_str(), mode);
+#endif
+}
+
+inline string GetBakePath(const string& sourcePath) {
+	return sourcePath + MODEL_BAKE_EXTENSION;
+}
+
+// Tamaños de los formatos de vértice: si cambia alguno, los bakes existentes quedan obsoletos
+inline uint32_t BakeVertexFormatSizes() {
+	return (uint32_t)sizeof(StaticVertex) | ((uint32_t)sizeof(StaticTangentVertex) << 8) |
+		((uint32_t)sizeof(SkinnedVertex) << 16);
+}
+
+inline size_t VertexFormatStride(uint32_t format) {
+	switch (format) {
+	case VERTEX_FORMAT_STATIC:         return sizeof(StaticVertex);
+	case VERTEX_FORMAT_STATIC_TANGENT: return sizeof(StaticTangentVertex);
+	case VERTEX_FORMAT_SKINNED:        return sizeof(SkinnedVertex);
+	default:                           return 0;
+	}
+}
+
+struct BakeHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vertexFormatSizes;
+	uint32_t reserved;
+	uint64_t sourceSize;
+	int64_t  sourceMTime;
+};
+
+// Mismo layout que Model::MaterialProperties
+struct BakedMaterial {
+	glm::vec4 ambient;
+	glm::vec4 diffuse;
+	glm::vec4 specular;
+	float metallic;
+	float roughness;
+	float ior;
+	float alpha;
+};
+
+struct BakedTextureRef {
+	string type;
+	string path;
+};
+
+// Vista de una malla dentro del archivo mapeado (no copia los datos)
+struct BakedMesh {
+	uint32_t            vertexFormat; // VertexFormat
+	const void*         vertices;     // en el formato nativo de la malla
+	unsigned int        vertexCount;
+	const void*         indices;      // de 16 o 32 bits según indexType, todos los LODs seguidos
+	unsigned int        indexCount;
+	GLenum              indexType;
+	vector<MeshLod>     lods;
+	unsigned int        materialIndex;
+	vector<BakedTextureRef> textures;
+};
+
+// Malla ya subida que se va a escribir (sus datos de CPU deben seguir presentes)
+struct BakeMeshSource {
+	uint32_t                    vertexFormat;
+	const void*                 vertices;
+	size_t                      vertexCount;
+	const vector<unsigned int>* indices;
+	unsigned int                materialIndex;
+	const vector<Texture>*      textures;
+	const vector<MeshLod>*      lods;
+};
+
+template <typename VertexT>
+void AddBakeMeshes(vector<BakeMeshSource>& out, const vector<Mesh<VertexT>>& meshes) {
+	for (const Mesh<VertexT>& mesh : meshes)
+		out.push_back({ (uint32_t)VertexT::format(), mesh.vertices.data(), mesh.vertices.size(),
+			&mesh.indices, mesh.materialIndex, &mesh.textures, &mesh.lods });
+}
+
+// Propiedades de un material de Assimp con los valores por omisión de Model
+inline BakedMaterial ReadBakedMaterial(const aiMaterial* mat)
+{
+	BakedMaterial m;
+	aiColor3D color;
+	m.ambient = mat->Get(AI_MATKEY_COLOR_AMBIENT, color) == AI_SUCCESS ? glm::vec4(color.r, color.g, color.b, 1.0f) : glm::vec4(0.2f, 0.2f, 0.2f, 1.0f);
+	m.diffuse = mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS ? glm::vec4(color.r, color.g, color.b, 1.0f) : glm::vec4(0.7f, 0.7f, 0.7f, 1.0f);
+	m.specular = mat->Get(AI_MATKEY_COLOR_SPECULAR, color) == AI_SUCCESS ? glm::vec4(color.r, color.g, color.b, 1.0f) : glm::vec4(0.3f, 0.3f, 0.3f, 1.0f);
+	float value;
+	m.metallic = mat->Get(AI_MATKEY_METALLIC_FACTOR, value) == AI_SUCCESS ? value : 0.0f;
+	m.roughness = mat->Get(AI_MATKEY_ROUGHNESS_FACTOR, value) == AI_SUCCESS ? value : 0.5f;
+	m.ior = mat->Get(AI_MATKEY_REFRACTI, value) == AI_SUCCESS ? value : 1.45f;
+	m.alpha = mat->Get(AI_MATKEY_OPACITY, value) == AI_SUCCESS ? value : 1.0f;
+	return m;
+}
+
+/**
+ * @brief Texturas de un material en el orden que esperan los shaders: difusa, especular, normal y altura
+ * Con solidColorDiffuse, un material sin mapa difuso pero con color difuso da la referencia
+ * "procedural_color" (Model la resuelve con una textura de 1x1). No toca GL.
+ */
+inline vector<BakedTextureRef> CollectMaterialTextureRefs(const aiMaterial* mat, bool solidColorDiffuse)
+{
+	static const struct { aiTextureType type; const char* name; } slots[] = {
+		{ aiTextureType_DIFFUSE,  "texture_diffuse" },
+		{ aiTextureType_SPECULAR, "texture_specular" },
+		{ aiTextureType_HEIGHT,   "texture_normal" },
+		{ aiTextureType_AMBIENT,  "texture_height" }
+	};
+	vector<BakedTextureRef> refs;
+	for (const auto& slot : slots) {
+		unsigned int count = mat->GetTextureCount(slot.type);
+		aiColor3D color;
+		if (count == 0 && solidColorDiffuse && slot.type == aiTextureType_DIFFUSE && mat->Get(AI_MATKEY_COLOR_DIFFUSE, color) == AI_SUCCESS) {
+			refs.push_back({ slot.name, "procedural_color" });
+			continue;
+		}
+		for (unsigned int i = 0; i < count; i++) {
+			aiString path;
+			mat->GetTexture(slot.type, i, &path);
+			refs.push_back({ slot.name, path.C_Str() });
+		}
+	}
+	return refs;
+}
+
+struct BakedBone {
+	aiString  name;
+	glm::mat4 offsetMatrix;
+};
+
+/**
+ * @brief Contenido de un .mhbake ya validado
+ * Las mallas apuntan directamente a la memoria mapeada; la jerarquía de nodos y las
+ * animaciones se copian a sus estructuras propias (ver animationdata.h).
+ */
+struct BakedModel {
+	MappedFile              file;
+	vector<BakedMesh>       meshes;
+	vector<BakedMaterial>   materials;
+	vector<BakedBone>       bones;
+	glm::mat4               globalInverseTransform;
+	NodeHierarchy           nodes;
+	vector<AnimationClip>   animations;
+};
+
+// ---------------------------------------------------------------------------
+// Escritura
+// ---------------------------------------------------------------------------
+
+class BakeWriter {
+public:
+	explicit BakeWriter(FILE* f) : file(f), offset(0), ok(true) {}
+
+	void bytes(const void* data, size_t size) {
+		if (size == 0) return;
+		if (fwrite(data, 1, size, file) != size) ok = false;
+		offset += size;
+	}
+	template <typename T> void value(const T& v) { bytes(&v, sizeof(T)); }
+	void u32(uint32_t v) { value(v); }
+	void str(const string& s) { u32((uint32_t)s.size()); bytes(s.data(), s.size()); }
+	template <typename T> void array(const vector<T>& v) { u32((uint32_t)v.size()); bytes(v.data(), v.size() * sizeof(T)); }
+	void align(size_t alignment) {
+		static const unsigned char zeros[16] = { 0 };
+		size_t pad = (alignment - (offset % alignment)) % alignment;
+		bytes(zeros, pad);
+	}
+	bool good() const { return ok; }
+
+private:
+	FILE*  file;
+	size_t offset;
+	bool   ok;
+};
+
+/**
+ * @brief Escribe el bake de un modelo recién importado con Assimp
+ * @param sourcePath Ruta del FBX original (el bake se guarda junto a él)
+ * @param nodes Jerarquía de nodos
+ * @param animations Animaciones ya convertidas
+ * @param meshes Mallas en su formato de vértice nativo (ver AddBakeMeshes)
+ * @param materials Materiales ya resueltos (puede ir vacío)
+ * @param bones Huesos con su matriz offset
+ */
+template <typename BoneT>
+bool WriteModelBake(const string& sourcePath, const NodeHierarchy& nodes, const vector<AnimationClip>& animations,
+	const vector<BakeMeshSource>& meshes,
+	const vector<BakedMaterial>& materials, const vector<BoneT>& bones,
+	const glm::mat4& globalInverseTransform)
+{
+	BakeSourceStamp stamp;
+	if (!GetBakeSourceStamp(sourcePath, stamp)) return false;
+
+	string bakePath = GetBakePath(sourcePath);
+	string tmpPath = bakePath + ".tmp";
+	FILE* f = OpenBakeFile(tmpPath, "wb");
+	if (!f) {
+		cout << "BAKE:: could not write " << tmpPath << endl;
+		return false;
+	}
+
+	BakeWriter w(f);
+	BakeHeader header;
+	header.magic = MODEL_BAKE_MAGIC;
+	header.version = MODEL_BAKE_VERSION;
+	header.vertexFormatSizes = BakeVertexFormatSizes();
+	header.reserved = 0;
+	header.sourceSize = stamp.size;
+	header.sourceMTime = stamp.mtime;
+	w.value(header);
+
+	// Mallas
+	w.u32((uint32_t)meshes.size());
+	for (size_t m = 0; m < meshes.size(); m++) {
+		const BakeMeshSource& mesh = meshes[m];
+		w.u32(mesh.vertexFormat);
+		w.u32((uint32_t)mesh.vertexCount);
+		w.u32((uint32_t)mesh.indices->size());
+		w.u32(mesh.materialIndex);
+		w.u32((uint32_t)mesh.textures->size());
+		for (const Texture& t : *mesh.textures) {
+			w.str(t.type);
+			w.str(t.path);
+		}
+		w.u32((uint32_t)mesh.lods->size());
+		if (!mesh.lods->empty())
+			w.bytes(mesh.lods->data(), mesh.lods->size() * sizeof(MeshLod));
+		w.align(16);
+		w.bytes(mesh.vertices, mesh.vertexCount * VertexFormatStride(mesh.vertexFormat));
+		// los índices se guardan ya reducidos, tal como se suben
+		if (SmallestIndexType(mesh.vertexCount) == GL_UNSIGNED_SHORT) {
+			vector<uint16_t> shortIndices(mesh.indices->begin(), mesh.indices->end());
+			w.bytes(shortIndices.data(), shortIndices.size() * sizeof(uint16_t));
+		}
+		else
+			w.bytes(mesh.indices->data(), mesh.indices->size() * sizeof(unsigned int));
+		w.align(16);
+	}
+
+	// Materiales
+	w.u32((uint32_t)materials.size());
+	if (!materials.empty())
+		w.bytes(materials.data(), materials.size() * sizeof(BakedMaterial));
+
+	// Huesos
+	w.u32((uint32_t)bones.size());
+	for (const BoneT& b : bones) {
+		w.str(b.name.C_Str());
+		w.value(b.offsetMatrix);
+	}
+	w.value(globalInverseTransform);
+
+	// Jerarquía de nodos (preorden)
+	w.u32((uint32_t)nodes.size());
+	for (size_t n = 0; n < nodes.size(); n++) {
+		w.str(nodes.names[n]);
+		w.value(nodes.parents[n]);
+		w.value(nodes.localTransforms[n]);
+	}
+
+	// Animaciones: cada pista se escribe como arreglo de tiempos y arreglo de valores
+	w.u32((uint32_t)animations.size());
+	for (const AnimationClip& clip : animations) {
+		w.str(clip.name);
+		w.value(clip.duration);
+		w.value(clip.ticksPerSecond);
+		w.u32((uint32_t)clip.channels.size());
+		for (const AnimationChannel& ch : clip.channels) {
+			w.value(ch.node);
+			w.array(ch.positionTimes);
+			w.array(ch.positions);
+			w.array(ch.rotationTimes);
+			w.array(ch.rotations);
+			w.array(ch.scaleTimes);
+			w.array(ch.scales);
+		}
+	}
+
+	bool ok = w.good();
+	fclose(f);
+	if (!ok) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	// Reemplazo atómico para no dejar nunca un bake a medio escribir
+	remove(bakePath.c_str());
+	if (rename(tmpPath.c_str(), bakePath.c_str()) != 0) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	cout << "BAKE:: wrote " << bakePath << endl;
+	return true;
+}
+
+// ---------------------------------------------------------------------------
+// Lectura
+// ---------------------------------------------------------------------------
+
+class BakeReader {
+public:
+	BakeReader(const unsigned char* data, size_t size) : base(data), end(data + size), cur(data), ok(true) {}
+
+	const void* bytes(size_t size) {
+		if (!ok || (size_t)(end - cur) < size) { ok = false; return nullptr; }
+		const void* p = cur;
+		cur += size;
+		return p;
+	}
+	template <typename T> T value() {
+		T v;
+		const void* p = bytes(sizeof(T));
+		if (p) memcpy(&v, p, sizeof(T));
+		else memset(&v, 0, sizeof(T));
+		return v;
+	}
+	uint32_t u32() { return value<uint32_t>(); }
+	template <typename T> void array(vector<T>& out, size_t limit) {
+		uint32_t n = u32();
+		const void* p = n <= limit ? bytes((size_t)n * sizeof(T)) : nullptr;
+		if (!p) { ok = false; out.clear(); return; }
+		out.resize(n);
+		if (n) memcpy(out.data(), p, (size_t)n * sizeof(T));
+	}
+	string str() {
+		uint32_t n = u32();
+		const char* p = (const char*)bytes(n);
+		return p ? string(p, n) : string();
+	}
+	void align(size_t alignment) {
+		size_t offset = (size_t)(cur - base);
+		bytes((alignment - (offset % alignment)) % alignment);
+	}
+	bool good() const { return ok; }
+
+private:
+	const unsigned char* base;
+	const unsigned char* end;
+	const unsigned char* cur;
+	bool ok;
+};
+
+/**
+ * @brief Actualiza el sello de un bake válido cuya fuente cambió de fecha pero no de contenido
+ * (el baker compara el hash del contenido; así el juego no reimporta por un checkout o una copia)
+ */
+inline bool RestampModelBake(const string& sourcePath)
+{
+	BakeSourceStamp stamp;
+	if (!GetBakeSourceStamp(sourcePath, stamp)) return false;
+	FILE* f = OpenBakeFile(GetBakePath(sourcePath), "r+b");
+	if (!f) return false;
+	BakeHeader header;
+	bool ok = fread(&header, sizeof(header), 1, f) == 1 && header.magic == MODEL_BAKE_MAGIC &&
+		header.version == MODEL_BAKE_VERSION && header.vertexFormatSizes == BakeVertexFormatSizes();
+	if (ok && (header.sourceSize != stamp.size || header.sourceMTime != stamp.mtime)) {
+		header.sourceSize = stamp.size;
+		header.sourceMTime = stamp.mtime;
+		ok = fseek(f, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, f) == 1;
+	}
+	ok = fclose(f) == 0 && ok;
+	return ok;
+}
+
+/**
+ * @brief true si el bake sirve a Model (skinned = false) o a AnimatedModel (skinned = true)
+ * Cada uno sólo usa las mallas de sus formatos de vértice; el asset-baker decide por los huesos del
+ * FBX y puede suponer lo contrario de la clase con que el juego lo carga.
+ */
+inline bool BakeHasMeshesFor(const BakedModel& baked, bool skinned)
+{
+	bool usable = baked.meshes.empty();
+	for (const BakedMesh& mesh : baked.meshes)
+		usable = usable || (mesh.vertexFormat == VERTEX_FORMAT_SKINNED) == skinned;
+	return usable;
+}
+
+/**
+ * @brief Abre y valida el bake de un modelo
+ * @return false si no existe, es de otra versión o el FBX es más reciente (hay que reimportar)
+ */
+inline bool LoadModelBake(const string& sourcePath, BakedModel& out)
+{
+	BakeSourceStamp stamp;
+	if (!GetBakeSourceStamp(sourcePath, stamp)) return false;
+	if (!out.file.open(GetBakePath(sourcePath))) return false;
+
+	BakeReader r(out.file.data(), out.file.size());
+	BakeHeader header = r.value<BakeHeader>();
+	if (!r.good() || header.magic != MODEL_BAKE_MAGIC || header.version != MODEL_BAKE_VERSION ||
+		header.vertexFormatSizes != BakeVertexFormatSizes() ||
+		header.sourceSize != stamp.size || header.sourceMTime != stamp.mtime) {
+		cout << "BAKE:: stale or incompatible bake for " << sourcePath << ", reimporting" << endl;
+		out.file.close();
+		return false;
+	}
+
+	uint32_t meshCount = r.u32();
+	if (meshCount > out.file.size()) { out.file.close(); return false; }
+	out.meshes.resize(meshCount);
+	for (uint32_t m = 0; m < meshCount && r.good(); m++) {
+		BakedMesh& mesh = out.meshes[m];
+		mesh.vertexFormat = r.u32();
+		size_t stride = VertexFormatStride(mesh.vertexFormat);
+		if (stride == 0) { out.meshes.clear(); out.file.close(); return false; }
+		mesh.vertexCount = r.u32();
+		mesh.indexCount = r.u32();
+		mesh.materialIndex = r.u32();
+		uint32_t textureCount = r.u32();
+		if (textureCount > out.file.size()) { out.meshes.clear(); out.file.close(); return false; }
+		mesh.textures.resize(textureCount);
+		for (uint32_t t = 0; t < textureCount; t++) {
+			mesh.textures[t].type = r.str();
+			mesh.textures[t].path = r.str();
+		}
+		uint32_t lodCount = r.u32();
+		const MeshLod* lods = (const MeshLod*)r.bytes((size_t)lodCount * sizeof(MeshLod));
+		if (lods) mesh.lods.assign(lods, lods + lodCount);
+		for (const MeshLod& lod : mesh.lods) {
+			if ((size_t)lod.firstIndex + lod.indexCount > mesh.indexCount) { mesh.lods.clear(); break; }
+		}
+		r.align(16);
+		mesh.vertices = r.bytes((size_t)mesh.vertexCount * stride);
+		mesh.indexType = SmallestIndexType(mesh.vertexCount);
+		mesh.indices = r.bytes((size_t)mesh.indexCount * IndexTypeSize(mesh.indexType));
+		r.align(16);
+	}
+	// una malla truncada deja conteos sin datos: el bake no sirve
+	for (const BakedMesh& mesh : out.meshes) {
+		if ((mesh.vertexCount > 0 && !mesh.vertices) || (mesh.indexCount > 0 && !mesh.indices)) {
+			out.meshes.clear();
+			out.file.close();
+			return false;
+		}
+	}
+
+	uint32_t materialCount = r.u32();
+	const BakedMaterial* mats = (const BakedMaterial*)r.bytes((size_t)materialCount * sizeof(BakedMaterial));
+	if (mats) out.materials.assign(mats, mats + materialCount);
+
+	uint32_t boneCount = r.u32();
+	if (!r.good() || boneCount > out.file.size()) { out.meshes.clear(); out.file.close(); return false; }
+	out.bones.resize(boneCount);
+	for (uint32_t b = 0; b < boneCount && r.good(); b++) {
+		out.bones[b].name = aiString(r.str());
+		out.bones[b].offsetMatrix = r.value<glm::mat4>();
+	}
+	out.globalInverseTransform = r.value<glm::mat4>();
+
+	// Jerarquía
+	uint32_t nodeCount = r.u32();
+	if (!r.good() || nodeCount == 0 || nodeCount > out.file.size()) { out.file.close(); return false; }
+	for (uint32_t n = 0; n < nodeCount && r.good(); n++) {
+		string name = r.str();
+		int32_t parent = r.value<int32_t>();
+		glm::mat4 local = r.value<glm::mat4>();
+		if (parent >= (int32_t)n) parent = -1; // el padre siempre va antes (preorden)
+		out.nodes.add(name, parent, local);
+	}
+
+	// Animaciones
+	uint32_t animationCount = r.u32();
+	if (animationCount > out.file.size()) animationCount = 0;
+	for (uint32_t a = 0; a < animationCount && r.good(); a++) {
+		AnimationClip clip;
+		clip.name = r.str();
+		clip.duration = r.value<double>();
+		clip.ticksPerSecond = r.value<double>();
+		uint32_t channelCount = r.u32();
+		if (!r.good() || channelCount > out.file.size()) break;
+		clip.channels.resize(channelCount);
+		for (uint32_t c = 0; c < channelCount && r.good(); c++) {
+			AnimationChannel& ch = clip.channels[c];
+			ch.node = r.value<int32_t>();
+			r.array(ch.positionTimes, out.file.size());
+			r.array(ch.positions, ch.positionTimes.size());
+			r.array(ch.rotationTimes, out.file.size());
+			r.array(ch.rotations, ch.rotationTimes.size());
+			r.array(ch.scaleTimes, out.file.size());
+			r.array(ch.scales, ch.scaleTimes.size());
+			if (ch.node < 0 || (uint32_t)ch.node >= nodeCount) ch.node = -1;
+			if (ch.positions.size() != ch.positionTimes.size() || ch.rotations.size() != ch.rotationTimes.size() ||
+				ch.scales.size() != ch.scaleTimes.size()) {
+				ch = AnimationChannel();
+				ch.node = -1;
+			}
+		}
+		clip.linkNodes(out.nodes.size());
+		out.animations.push_back(std::move(clip));
+	}
+
+	if (!r.good()) {
+		cout << "BAKE:: truncated bake for " << sourcePath << ", reimporting" << endl;
+		out.meshes.clear();
+		out.nodes = NodeHierarchy();
+		out.animations.clear();
+		out.file.close();
+		return false;
+	}
+	return true;
+}
+
+#endif
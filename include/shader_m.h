@@ -9,6 +9,8 @@
 #include <sstream>
 #include <iostream>
 
+#include <loadprofiler.h>
+
 class Shader
 {
 public:
@@ -19,6 +21,7 @@ public:
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
     {
+        ScopedLoadTimer timer(vertexPath, "shader compile");
         // 1. retrieve the vertex/fragment source code from filePath
         std::string vertexCode;
         std::string fragmentCode;
@@ -0,0 +1,112 @@
+#ifndef SKELETON_H
+#define SKELETON_H
+
+#include <glm/glm.hpp>
+#include <assimp/types.h>
+
+#include <animationdata.h>
+#include <animationsampler.h>
+#include <localpose.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+// Max number of bones
+#ifndef MAX_RIGGING_BONES
+#define MAX_RIGGING_BONES 100
+#endif
+
+// Un hueso del esqueleto: sólo lo que hace falta para la paleta (los pesos viven en los vértices)
+struct SkeletonBone {
+	aiString  name;
+	glm::mat4 offsetMatrix;
+};
+
+/**
+ * @brief Datos inmutables de un esqueleto animado
+ * Lo llena AnimatedModel al cargar y lo comparten todas las AnimationInstance del modelo;
+ * nada de aquí cambia mientras se reproduce una animación.
+ */
+class Skeleton {
+public:
+	NodeHierarchy        nodes;
+	vector<SkeletonBone> bones;
+	vector<int32_t>      boneNodes; // nodo de cada hueso en la jerarquía (-1 si no está)
+	glm::mat4            globalInverseTransform;
+
+	// Pose compilada: sólo los nodos que mueven algún hueso (los huesos y sus ancestros), en el
+	// mismo preorden de la jerarquía, así que el padre siempre va antes que el hijo
+	vector<int32_t>      poseNodes;   // nodo de la jerarquía de cada posición
+	vector<int32_t>      poseParents; // posición del padre; -1 en la raíz
+	vector<int32_t>      boneSlots;   // posición del nodo de cada hueso; -1 si no está
+
+	Skeleton() : globalInverseTransform(1.0f) {}
+
+	size_t boneCount() const { return bones.size(); }
+
+	// se llama después de llenar nodes y bones
+	void linkBones() {
+		boneNodes = MapBonesToNodes(bones, nodes);
+
+		vector<bool> used(nodes.size(), false);
+		for (int32_t node : boneNodes)
+			for (int32_t n = node; n >= 0 && !used[n]; n = nodes.parents[n])
+				used[n] = true;
+
+		vector<int32_t> slotOfNode(nodes.size(), -1);
+		poseNodes.clear();
+		poseParents.clear();
+		for (size_t n = 0; n < nodes.size(); n++) {
+			if (!used[n]) continue;
+			int32_t parent = nodes.parents[n];
+			slotOfNode[n] = (int32_t)poseNodes.size();
+			poseNodes.push_back((int32_t)n);
+			poseParents.push_back(parent >= 0 ? slotOfNode[parent] : -1);
+		}
+		boneSlots.resize(boneNodes.size());
+		for (size_t b = 0; b < boneNodes.size(); b++)
+			boneSlots[b] = boneNodes[b] >= 0 ? slotOfNode[boneNodes[b]] : -1;
+	}
+
+	/**
+	 * @brief Paleta de huesos en el instante time (ticks) del clip ligado a sampler
+	 * Un recorrido por los nodos de pose y uno por los huesos; el costo depende del número de huesos,
+	 * no del de canales ni de llaves.
+	 * @param poseGlobals Memoria de trabajo del que llama (una por instancia)
+	 * @param palette     Arreglo de al menos paletteSize matrices; los huesos sin nodo no se tocan
+	 */
+	void computePalette(PoseSampler& sampler, float time, vector<glm::mat4>& poseGlobals,
+		glm::mat4* palette, size_t paletteSize) const {
+		poseGlobals.resize(poseNodes.size());
+		for (size_t slot = 0; slot < poseNodes.size(); slot++) {
+			glm::mat4 local = sampler.sample(slot, time);
+			int32_t parent = poseParents[slot];
+			poseGlobals[slot] = parent >= 0 ? poseGlobals[parent] * local : local;
+		}
+		writePalette(poseGlobals, palette, paletteSize);
+	}
+
+	// lo mismo a partir de una pose local ya mezclada (AnimationGraph): una sola pasada por la jerarquía
+	void computePalette(const LocalPose& pose, vector<glm::mat4>& poseGlobals, glm::mat4* palette, size_t paletteSize) const {
+		poseGlobals.resize(poseNodes.size());
+		for (size_t slot = 0; slot < poseNodes.size() && slot < pose.count; slot++) {
+			glm::mat4 local = ComposeKeyTransform(pose.translation(slot), pose.rotation(slot), pose.scale(slot));
+			int32_t parent = poseParents[slot];
+			poseGlobals[slot] = parent >= 0 ? poseGlobals[parent] * local : local;
+		}
+		writePalette(poseGlobals, palette, paletteSize);
+	}
+
+private:
+	void writePalette(const vector<glm::mat4>& poseGlobals, glm::mat4* palette, size_t paletteSize) const {
+		size_t count = std::min(bones.size(), paletteSize);
+		for (size_t b = 0; b < count; b++) {
+			if (boneSlots[b] >= 0)
+				palette[b] = globalInverseTransform * poseGlobals[boneSlots[b]] * bones[b].offsetMatrix;
+		}
+	}
+};
+
+#endif
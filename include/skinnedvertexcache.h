@@ -0,0 +1,177 @@
+#ifndef SKINNEDVERTEXCACHE_H
+#define SKINNEDVERTEXCACHE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <animatedmodel.h>
+#include <bonepalette.h>
+#include <geometrypool.h>
+#include <shader_m.h>
+
+#include <cstddef>
+#include <vector>
+#include <iostream>
+using namespace std;
+
+// Vértice ya deformado, como lo escribe 10_vertex_skinning-feedback.vs (salidas intercaladas en este orden)
+struct PostSkinnedVertex {
+	glm::vec3 Position;  // espacio del modelo, con la pose aplicada
+	glm::vec3 Normal;
+	glm::vec2 TexCoords;
+};
+
+// salidas del shader de skinning que captura el transform feedback
+static const char* const SKINNING_FEEDBACK_VARYINGS[] = { "skinnedPosition", "skinnedNormal", "skinnedTexCoords" };
+#define SKINNING_FEEDBACK_VARYING_COUNT 3
+
+/**
+ * @brief Prepara el programa de skinning para capturar PostSkinnedVertex; una vez por shader, al cargarlo
+ * Sólo usa el ID del programa: shader.h y shader_m.h comparten guarda y cualquiera de los dos puede ser el Shader visible.
+ */
+inline bool SetupSkinningFeedbackShader(const Shader& feedbackShader) {
+	glTransformFeedbackVaryings(feedbackShader.ID, SKINNING_FEEDBACK_VARYING_COUNT, SKINNING_FEEDBACK_VARYINGS, GL_INTERLEAVED_ATTRIBS);
+	// los shaders siguen adjuntos al programa: basta con volver a enlazarlo
+	glLinkProgram(feedbackShader.ID);
+	GLint linked = 0;
+	glGetProgramiv(feedbackShader.ID, GL_LINK_STATUS, &linked);
+	if (!linked) {
+		GLchar infoLog[1024];
+		glGetProgramInfoLog(feedbackShader.ID, 1024, NULL, infoLog);
+		cout << "ERROR::SKINNING_FEEDBACK::PROGRAM_LINKING_ERROR\n" << infoLog << endl;
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Vértices de un personaje ya deformados por su pose, en un buffer de la GPU
+ * skin() pasa todos los vértices de las mallas del modelo por 10_vertex_skinning-feedback.vs con transform
+ * feedback (GL 3.3 no tiene compute shaders) y sin rasterizar; la mezcla de los 12 huesos por vértice
+ * se hace una vez por pose y no una vez por pasada. Después cualquier pasada (color, profundidad,
+ * selección, contorno) dibuja el buffer con draw() y un vertex shader estático, usando los mismos
+ * índices de GeometryPool. Si la versión de la pose no cambió, skin() no hace nada.
+ */
+class SkinnedVertexCache {
+public:
+	SkinnedVertexCache() : buffer(0), vao(0), vaoGeneration(0), vertexCount(0), skinnedVersion(0), hasSkin(false) {}
+	~SkinnedVertexCache() { release(); }
+
+	SkinnedVertexCache(const SkinnedVertexCache&) = delete;
+	SkinnedVertexCache& operator=(const SkinnedVertexCache&) = delete;
+
+	/**
+	 * @brief Deforma todas las mallas con la paleta ya subida a palette
+	 * @return true si hubo que volver a deformar (la pose cambió desde el último skin)
+	 */
+	bool skin(const AnimatedModel& model, Shader& feedbackShader, const BonePaletteBuffer& palette, unsigned int poseVersion) {
+		allocate(model);
+		if (vertexCount == 0) return false;
+		if (hasSkin && poseVersion == skinnedVersion) return false;
+
+		feedbackShader.use();
+		palette.bind(feedbackShader);
+		glEnable(GL_RASTERIZER_DISCARD);
+		GeometryPool& pool = GeometryPool::instance();
+		for (size_t i = 0; i < model.meshes.size(); i++) {
+			const GeometryRange& range = model.meshes[i].geometry;
+			if (!range.valid()) continue;
+			pool.bind(range.format);
+			glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer, (GLintptr)(meshBase[i] * sizeof(PostSkinnedVertex)),
+				(GLsizeiptr)(range.vertexCount * sizeof(PostSkinnedVertex)));
+			glBeginTransformFeedback(GL_POINTS);
+			glDrawArrays(GL_POINTS, range.baseVertex, (GLsizei)range.vertexCount);
+			glEndTransformFeedback();
+		}
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+		glDisable(GL_RASTERIZER_DISCARD);
+		pool.unbind();
+		glUseProgram(0);
+
+		skinnedVersion = poseVersion;
+		hasSkin = true;
+		return true;
+	}
+
+	bool valid() const { return hasSkin; }
+
+	/**
+	 * @brief Dibuja los vértices deformados con el shader ya activo y sus uniforms puestos
+	 * El shader lee aPos (0), aNormal (1) y aTexCoords (2), como un modelo estático.
+	 */
+	void draw(AnimatedModel& model, Shader& shader, unsigned int lod = 0) {
+		if (!hasSkin) return;
+		GeometryPool& pool = GeometryPool::instance();
+		unsigned int generation = pool.bufferGeneration(VERTEX_FORMAT_SKINNED);
+		if (generation != vaoGeneration) setupVertexArray(pool.indexBuffer(VERTEX_FORMAT_SKINNED), generation);
+
+		// el VAO propio se enlaza fuera del pool: primero se le avisa que ya no tiene el suyo enlazado
+		pool.unbind();
+		glBindVertexArray(vao);
+		for (size_t i = 0; i < model.meshes.size(); i++) {
+			SkinnedMesh& mesh = model.meshes[i];
+			const GeometryRange& range = mesh.geometry;
+			if (!range.valid()) continue;
+			mesh.BindTextures(shader);
+			const MeshLod& level = mesh.getLod(lod);
+			void* offset = (void*)(range.indexOffset + (size_t)level.firstIndex * IndexTypeSize(range.indexType));
+			glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)level.indexCount, range.indexType, offset, (GLint)meshBase[i]);
+		}
+		glBindVertexArray(0);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	void release() {
+		if (vao) glDeleteVertexArrays(1, &vao);
+		if (buffer) glDeleteBuffers(1, &buffer);
+		vao = 0;
+		buffer = 0;
+		vaoGeneration = 0;
+		vertexCount = 0;
+		meshBase.clear();
+		hasSkin = false;
+	}
+
+private:
+	GLuint         buffer;
+	GLuint         vao;
+	unsigned int   vaoGeneration;  // GeometryPool::bufferGeneration con la que se armó vao (0: sin armar)
+	size_t         vertexCount;
+	vector<size_t> meshBase;       // primer vértice de cada malla dentro de buffer
+	unsigned int   skinnedVersion;
+	bool           hasSkin;
+
+	// un tramo del buffer por malla, en el orden de model.meshes
+	void allocate(const AnimatedModel& model) {
+		if (buffer || model.meshes.empty()) return;
+		meshBase.resize(model.meshes.size());
+		for (size_t i = 0; i < model.meshes.size(); i++) {
+			meshBase[i] = vertexCount;
+			vertexCount += model.meshes[i].geometry.vertexCount;
+		}
+		if (vertexCount == 0) return;
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(vertexCount * sizeof(PostSkinnedVertex)), nullptr, GL_DYNAMIC_COPY);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	void setupVertexArray(GLuint indices, unsigned int generation) {
+		if (!vao) glGenVertexArrays(1, &vao);
+		GeometryPool::instance().unbind();
+		glBindVertexArray(vao);
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PostSkinnedVertex), (void*)offsetof(PostSkinnedVertex, Position));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(PostSkinnedVertex), (void*)offsetof(PostSkinnedVertex, Normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(PostSkinnedVertex), (void*)offsetof(PostSkinnedVertex, TexCoords));
+		glBindVertexArray(0);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		vaoGeneration = generation;
+	}
+};
+
+#endif
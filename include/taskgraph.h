@@ -0,0 +1,227 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <jobsystem.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief Grafo de tareas con dependencias para la carga inicial
+ * Las tareas WORKER corren en el JobSystem (disco, Assimp, audio), las MAIN en el hilo de GL dentro
+ * de pump() (compilar shaders, subir buffers) y las WAIT son condiciones que pump() revisa cada vez
+ * (p. ej. que el TextureStreamer termine). Una tarea se lanza en cuanto terminan todas sus dependencias,
+ * así que el trabajo independiente avanza en paralelo mientras el hilo principal dibuja la pantalla de carga.
+ */
+class TaskGraph {
+public:
+	enum TaskKind {
+		TASK_WORKER,
+		TASK_MAIN,
+		TASK_WAIT
+	};
+
+	typedef size_t TaskId;
+
+	TaskGraph() : started(false), finishedCount(0), finishedWeight(0.0f), totalWeight(0.0f), running(0) {}
+	TaskGraph(const TaskGraph&) = delete;
+	TaskGraph& operator=(const TaskGraph&) = delete;
+
+	// espera a que terminen las tareas de trabajo que sigan corriendo (capturan estado del grafo)
+	~TaskGraph() {
+		unique_lock<mutex> lock(completedMutex);
+		completedChanged.wait(lock, [this]() { return running == 0; });
+	}
+
+	TaskId addWorker(const string& name, function<void()> fn, const vector<TaskId>& deps = vector<TaskId>(), float weight = 1.0f) {
+		return add(TASK_WORKER, name, std::move(fn), function<bool()>(), deps, weight);
+	}
+
+	TaskId addMain(const string& name, function<void()> fn, const vector<TaskId>& deps = vector<TaskId>(), float weight = 1.0f) {
+		return add(TASK_MAIN, name, std::move(fn), function<bool()>(), deps, weight);
+	}
+
+	TaskId addWait(const string& name, function<bool()> ready, const vector<TaskId>& deps = vector<TaskId>(), float weight = 1.0f) {
+		return add(TASK_WAIT, name, function<void()>(), std::move(ready), deps, weight);
+	}
+
+	// lanza las tareas sin dependencias; después sólo falta llamar pump() hasta que finished()
+	void start() {
+		if (started) return;
+		started = true;
+		startTime = chrono::steady_clock::now();
+		for (TaskId id = 0; id < tasks.size(); id++)
+			if (tasks[id].pendingDeps == 0) dispatch(id);
+	}
+
+	/**
+	 * @brief Avance en el hilo de GL
+	 * Recoge lo que terminó en los hilos de trabajo, revisa las esperas y ejecuta tareas MAIN listas
+	 * hasta agotar timeBudget segundos (al menos una, para que el grafo siempre avance).
+	 */
+	void pump(double timeBudget = 0.008) {
+		auto begin = chrono::steady_clock::now();
+		collectCompleted();
+
+		for (size_t i = 0; i < waiting.size();) {
+			TaskId id = waiting[i];
+			if (tasks[id].ready()) {
+				waiting.erase(waiting.begin() + i);
+				complete(id);
+			}
+			else i++;
+		}
+
+		bool ranOne = false;
+		while (!mainReady.empty()) {
+			if (ranOne && chrono::duration<double>(chrono::steady_clock::now() - begin).count() >= timeBudget) break;
+			TaskId id = mainReady.front();
+			mainReady.pop_front();
+			runTimed(id);
+			complete(id);
+			ranOne = true;
+			collectCompleted();
+		}
+	}
+
+	bool finished() const { return finishedCount == tasks.size(); }
+
+	// fracción terminada, ponderada por el peso de cada tarea
+	float progress() const {
+		return totalWeight > 0.0f ? finishedWeight / totalWeight : 1.0f;
+	}
+
+	// nombre de alguna tarea en curso para mostrarlo en la pantalla de carga
+	string currentTask() const {
+		for (const Task& task : tasks)
+			if (task.state == STATE_RUNNING) return task.name;
+		return finished() ? "Listo" : "";
+	}
+
+	// tiempo de cada tarea, en el orden en que se agregaron
+	void printTimings() const {
+		for (const Task& task : tasks)
+			cout << "TASKGRAPH:: " << task.name << ": " << task.seconds * 1000.0 << " ms" << endl;
+		cout << "TASKGRAPH:: total " << chrono::duration<double>(chrono::steady_clock::now() - startTime).count() * 1000.0 << " ms" << endl;
+	}
+
+private:
+	enum TaskState {
+		STATE_BLOCKED,
+		STATE_RUNNING, // en un hilo de trabajo, esperando turno en el hilo principal o condición pendiente
+		STATE_DONE
+	};
+
+	struct Task {
+		TaskKind       kind;
+		string         name;
+		function<void()> fn;
+		function<bool()> ready;
+		vector<TaskId> dependents;
+		size_t         pendingDeps;
+		float          weight;
+		TaskState      state;
+		double         seconds;
+	};
+
+	vector<Task> tasks;
+	deque<TaskId> mainReady;
+	vector<TaskId> waiting;
+	bool started;
+	size_t finishedCount;
+	float finishedWeight;
+	float totalWeight;
+	chrono::steady_clock::time_point startTime;
+
+	mutex completedMutex;
+	condition_variable completedChanged;
+	vector<pair<TaskId, double>> completed; // terminadas en hilos de trabajo (con su duración), se procesan en pump()
+	size_t running;                         // tareas WORKER en vuelo (protegido por completedMutex)
+
+	TaskId add(TaskKind kind, const string& name, function<void()> fn, function<bool()> ready, const vector<TaskId>& deps, float weight) {
+		TaskId id = tasks.size();
+		Task task;
+		task.kind = kind;
+		task.name = name;
+		task.fn = std::move(fn);
+		task.ready = std::move(ready);
+		task.pendingDeps = 0;
+		task.weight = weight;
+		task.state = STATE_BLOCKED;
+		task.seconds = 0.0;
+		for (TaskId dep : deps) {
+			if (dep >= tasks.size()) continue; // sólo se puede depender de tareas ya agregadas
+			tasks[dep].dependents.push_back(id);
+			if (tasks[dep].state != STATE_DONE) task.pendingDeps++;
+		}
+		tasks.push_back(std::move(task));
+		totalWeight += weight;
+		if (started && tasks[id].pendingDeps == 0) dispatch(id);
+		return id;
+	}
+
+	void runTimed(TaskId id) {
+		auto begin = chrono::steady_clock::now();
+		tasks[id].fn();
+		tasks[id].seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+	}
+
+	void dispatch(TaskId id) {
+		Task& task = tasks[id];
+		task.state = STATE_RUNNING;
+		if (task.kind == TASK_MAIN) {
+			mainReady.push_back(id);
+		}
+		else if (task.kind == TASK_WAIT) {
+			waiting.push_back(id);
+		}
+		else {
+			{
+				lock_guard<mutex> lock(completedMutex);
+				running++;
+			}
+			// el trabajo no toca tasks: el vector puede crecer mientras corre
+			function<void()> fn = task.fn;
+			JobSystem::instance().submit([this, id, fn]() {
+				auto begin = chrono::steady_clock::now();
+				fn();
+				double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+				lock_guard<mutex> lock(completedMutex);
+				completed.push_back(make_pair(id, seconds));
+				running--;
+				completedChanged.notify_all();
+			});
+		}
+	}
+
+	void collectCompleted() {
+		vector<pair<TaskId, double>> done;
+		{
+			lock_guard<mutex> lock(completedMutex);
+			done.swap(completed);
+		}
+		for (const pair<TaskId, double>& d : done) {
+			tasks[d.first].seconds = d.second;
+			complete(d.first);
+		}
+	}
+
+	void complete(TaskId id) {
+		Task& task = tasks[id];
+		task.state = STATE_DONE;
+		finishedCount++;
+		finishedWeight += task.weight;
+		for (TaskId next : task.dependents)
+			if (--tasks[next].pendingDeps == 0) dispatch(next);
+	}
+};
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include <glad/glad.h>
+
+#include <texturestreamer.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cctype>
+#include <cstdio>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief Normaliza una ruta para usarla como llave del caché
+ * Separadores a '/', sin "." ni segmentos vacíos, ".." resuelto de forma léxica y en minúsculas
+ * (el sistema de archivos de Windows no distingue mayúsculas).
+ */
+inline string CanonicalTexturePath(const string& path)
+{
+	vector<string> parts;
+	string current;
+	bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+
+	for (size_t i = 0; i <= path.size(); i++) {
+		char c = i < path.size() ? path[i] : '/';
+		if (c != '/' && c != '\\') {
+			current += (char)tolower((unsigned char)c);
+			continue;
+		}
+		if (current.empty() || current == ".") {
+			// nada
+		}
+		else if (current == ".." && !parts.empty() && parts.back() != "..") {
+			parts.pop_back();
+		}
+		else {
+			parts.push_back(current);
+		}
+		current.clear();
+	}
+
+	string result = absolute ? "/" : "";
+	for (size_t i = 0; i < parts.size(); i++) {
+		if (i > 0) result += '/';
+		result += parts[i];
+	}
+	return result;
+}
+
+// el tipo de textura de los materiales decide la compresión (ver TextureUsage)
+inline TextureUsage TextureUsageForType(const string& typeName)
+{
+	return typeName == "texture_normal" ? TEXTURE_USAGE_NORMAL : TEXTURE_USAGE_COLOR;
+}
+
+/**
+ * @brief Registro global de texturas con conteo de referencias
+ * Cada acquire* suma una referencia y cada release resta una; con la última se borra la textura
+ * de la GPU. Dos modelos que usan la misma imagen comparten un solo id. Sólo desde el hilo de GL.
+ */
+class TextureCache {
+public:
+	static TextureCache& instance() {
+		static TextureCache cache;
+		return cache;
+	}
+
+	// textura 2D desde archivo; la decodificación es asíncrona (ver TextureStreamer) y los mips grandes
+	// sólo se suben cuando algún objeto los necesita (ver TextureResidency)
+	unsigned int acquire(const string& path, bool gamma = false, TextureUsage usage = TEXTURE_USAGE_COLOR) {
+		string key = CanonicalTexturePath(path) + (gamma ? "#srgb" : "") + (usage == TEXTURE_USAGE_NORMAL ? "#normal" : "");
+		unsigned int id = addReference(key);
+		if (id != 0) return id;
+		return insert(key, TextureStreamer::instance().requestTexture(path, gamma, usage, true));
+	}
+
+	unsigned int acquireCubemap(const vector<string>& faces) {
+		string key = "cubemap:";
+		for (const string& face : faces) key += CanonicalTexturePath(face) + "|";
+		unsigned int id = addReference(key);
+		if (id != 0) return id;
+		return insert(key, TextureStreamer::instance().requestCubemap(faces));
+	}
+
+	// textura de 1x1 con un color sólido (materiales sin mapa difuso)
+	unsigned int acquireSolidColor(float r, float g, float b) {
+		unsigned char data[4] = { toByte(r), toByte(g), toByte(b), 255 };
+		char key[32];
+		snprintf(key, sizeof(key), "color:%02x%02x%02x", data[0], data[1], data[2]);
+		unsigned int id = addReference(key);
+		if (id != 0) return id;
+
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return insert(key, id);
+	}
+
+	// suelta una referencia; ids que no son del caché se ignoran
+	void release(unsigned int id) {
+		auto it = keysById.find(id);
+		if (it == keysById.end()) return;
+		auto entry = entries.find(it->second);
+		if (--entry->second.refCount > 0) return;
+
+		TextureStreamer::instance().cancel(id);
+		TextureResidency::instance().untrack(id);
+		GLuint texture = id;
+		glDeleteTextures(1, &texture);
+		entries.erase(entry);
+		keysById.erase(it);
+	}
+
+	size_t size() const { return entries.size(); }
+
+	unsigned int refCount(unsigned int id) const {
+		auto it = keysById.find(id);
+		return it == keysById.end() ? 0 : entries.at(it->second).refCount;
+	}
+
+private:
+	struct Entry {
+		unsigned int id;
+		unsigned int refCount;
+	};
+	unordered_map<string, Entry> entries;         // llave canónica -> textura
+	unordered_map<unsigned int, string> keysById; // para release(id)
+
+	TextureCache() {}
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	static unsigned char toByte(float v) {
+		return (unsigned char)(v <= 0.0f ? 0 : v >= 1.0f ? 255 : (int)(v * 255.0f));
+	}
+
+	// 0 si la llave no está
+	unsigned int addReference(const string& key) {
+		auto it = entries.find(key);
+		if (it == entries.end()) return 0;
+		it->second.refCount++;
+		return it->second.id;
+	}
+
+	unsigned int insert(const string& key, unsigned int id) {
+		entries[key] = Entry{ id, 1 };
+		keysById[id] = key;
+		return id;
+	}
+};
+
+#endif
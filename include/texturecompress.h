@@ -0,0 +1,750 @@
+#ifndef TEXTURECOMPRESS_H
+#define TEXTURECOMPRESS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <modelbake.h>
+#include <jobsystem.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iostream>
+using namespace std;
+
+// S3TC no es parte del núcleo de GL, así que glad no trae sus constantes
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// Textura comprimida "horneada" (.dds junto a la imagen original, p. ej. OccupyGuy_diffuse.jpg.dds).
+// Es un DDS normal con cabecera DX10; en reserved1 va el sello de la fuente para detectar bakes obsoletos.
+#define TEXTURE_BAKE_EXTENSION ".dds"
+#define TEXTURE_BAKE_TAG       0x5854484Du // "MHTX"
+#define TEXTURE_BAKE_VERSION   1u
+
+// Para qué se usa la textura: decide el formato de bloque
+enum TextureUsage {
+	TEXTURE_USAGE_COLOR = 0,  // difuso/especular: BC1 si es opaca, BC7 (o BC3) si tiene alfa
+	TEXTURE_USAGE_NORMAL = 1  // mapa de normales: BC5 con X,Y; el shader reconstruye Z = sqrt(1 - x² - y²)
+};
+
+enum BlockFormat {
+	BLOCK_FORMAT_NONE = 0,
+	BLOCK_FORMAT_BC1,
+	BLOCK_FORMAT_BC3,
+	BLOCK_FORMAT_BC4,
+	BLOCK_FORMAT_BC5,
+	BLOCK_FORMAT_BC7
+};
+
+inline const char* BlockFormatName(BlockFormat format) {
+	switch (format) {
+	case BLOCK_FORMAT_BC1: return "BC1";
+	case BLOCK_FORMAT_BC3: return "BC3";
+	case BLOCK_FORMAT_BC4: return "BC4";
+	case BLOCK_FORMAT_BC5: return "BC5";
+	case BLOCK_FORMAT_BC7: return "BC7";
+	default: return "none";
+	}
+}
+
+inline size_t BlockBytes(BlockFormat format) {
+	return (format == BLOCK_FORMAT_BC1 || format == BLOCK_FORMAT_BC4) ? 8 : 16;
+}
+
+inline size_t CompressedLevelSize(BlockFormat format, int width, int height) {
+	return (size_t)((width + 3) / 4) * (size_t)((height + 3) / 4) * BlockBytes(format);
+}
+
+inline GLenum BlockFormatGL(BlockFormat format, bool srgb) {
+	switch (format) {
+	case BLOCK_FORMAT_BC1: return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BLOCK_FORMAT_BC3: return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case BLOCK_FORMAT_BC4: return GL_COMPRESSED_RED_RGTC1;
+	case BLOCK_FORMAT_BC5: return GL_COMPRESSED_RG_RGTC2;
+	case BLOCK_FORMAT_BC7: return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default: return 0;
+	}
+}
+
+/**
+ * @brief Formatos de bloque que acepta el driver
+ * Se consulta una vez en el hilo de GL; los hilos de trabajo sólo leen el resultado.
+ */
+struct BlockFormatSupport {
+	bool bc1, bc3, bc4, bc5, bc7;
+
+	BlockFormatSupport() : bc1(false), bc3(false), bc4(false), bc5(false), bc7(false) {}
+
+	static BlockFormatSupport query() {
+		BlockFormatSupport s;
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+		vector<GLint> formats((size_t)glm::max(count, 0));
+		if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+		for (GLint f : formats) {
+			if (f == GL_COMPRESSED_RGB_S3TC_DXT1_EXT) s.bc1 = true;
+			if (f == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) s.bc3 = true;
+			if (f == GL_COMPRESSED_RGBA_BPTC_UNORM) s.bc7 = true;
+		}
+		// RGTC es núcleo desde GL 3.0 y BPTC desde 4.2 (algunos drivers no los enumeran)
+		s.bc4 = s.bc5 = true;
+		if (GLAD_GL_VERSION_4_2) s.bc7 = true;
+		return s;
+	}
+
+	// todos los formatos, para hornear sin contexto de GL (ver tools/asset-baker)
+	static BlockFormatSupport all() {
+		BlockFormatSupport s;
+		s.bc1 = s.bc3 = s.bc4 = s.bc5 = s.bc7 = true;
+		return s;
+	}
+
+	bool supports(BlockFormat format) const {
+		switch (format) {
+		case BLOCK_FORMAT_BC1: return bc1;
+		case BLOCK_FORMAT_BC3: return bc3;
+		case BLOCK_FORMAT_BC4: return bc4;
+		case BLOCK_FORMAT_BC5: return bc5;
+		case BLOCK_FORMAT_BC7: return bc7;
+		default: return false;
+		}
+	}
+};
+
+struct CompressedLevel {
+	size_t offset; // en bytes dentro de data
+	size_t size;
+	int    width, height;
+};
+
+/**
+ * @brief Textura 2D comprimida por bloques con su cadena de mips completa
+ */
+struct CompressedTexture {
+	BlockFormat             format;
+	int                     width, height;
+	vector<CompressedLevel> levels; // 0 = tamaño completo
+	vector<unsigned char>   data;
+
+	CompressedTexture() : format(BLOCK_FORMAT_NONE), width(0), height(0) {}
+
+	bool valid() const { return format != BLOCK_FORMAT_NONE && !levels.empty(); }
+};
+
+/*  ------------------------------------------------------------------
+ *  Codificadores de bloque (4x4 píxeles RGBA8)
+ *  ------------------------------------------------------------------ */
+
+// copia un bloque 4x4 repitiendo el borde cuando la imagen no es múltiplo de 4
+inline void ExtractBlock(const unsigned char* rgba, int width, int height, int bx, int by, uint8_t block[16][4])
+{
+	for (int y = 0; y < 4; y++) {
+		int sy = glm::min(by * 4 + y, height - 1);
+		for (int x = 0; x < 4; x++) {
+			int sx = glm::min(bx * 4 + x, width - 1);
+			memcpy(block[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+		}
+	}
+}
+
+// eje principal de la nube de puntos (iteración de potencias sobre la covarianza)
+template <int N>
+inline glm::vec<N, float> PrincipalAxis(const glm::vec<N, float>* points, int count, const glm::vec<N, float>& mean)
+{
+	float cov[N][N] = {};
+	for (int i = 0; i < count; i++) {
+		glm::vec<N, float> d = points[i] - mean;
+		for (int r = 0; r < N; r++)
+			for (int c = 0; c < N; c++) cov[r][c] += d[r] * d[c];
+	}
+	glm::vec<N, float> axis(1.0f);
+	for (int iteration = 0; iteration < 8; iteration++) {
+		glm::vec<N, float> next(0.0f);
+		for (int r = 0; r < N; r++)
+			for (int c = 0; c < N; c++) next[r] += cov[r][c] * axis[c];
+		float len = glm::length(next);
+		if (len < 1e-6f) break;
+		axis = next / len;
+	}
+	float len = glm::length(axis);
+	return len > 0.0f ? axis / len : axis;
+}
+
+inline uint16_t PackRgb565(const glm::vec3& c)
+{
+	int r = glm::clamp((int)std::lround(c.r * 31.0f / 255.0f), 0, 31);
+	int g = glm::clamp((int)std::lround(c.g * 63.0f / 255.0f), 0, 63);
+	int b = glm::clamp((int)std::lround(c.b * 31.0f / 255.0f), 0, 31);
+	return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+inline glm::vec3 UnpackRgb565(uint16_t c)
+{
+	int r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+	return glm::vec3((float)((r << 3) | (r >> 2)), (float)((g << 2) | (g >> 4)), (float)((b << 3) | (b >> 2)));
+}
+
+// BC1 en modo de 4 colores: extremos sobre el eje principal y dos refinamientos por mínimos cuadrados
+inline void EncodeBC1Block(const uint8_t block[16][4], uint8_t out[8])
+{
+	glm::vec3 colors[16];
+	glm::vec3 mean(0.0f);
+	for (int i = 0; i < 16; i++) {
+		colors[i] = glm::vec3(block[i][0], block[i][1], block[i][2]);
+		mean += colors[i];
+	}
+	mean /= 16.0f;
+	glm::vec3 axis = PrincipalAxis<3>(colors, 16, mean);
+
+	float minT = 1e30f, maxT = -1e30f;
+	for (int i = 0; i < 16; i++) {
+		float t = glm::dot(colors[i] - mean, axis);
+		minT = glm::min(minT, t);
+		maxT = glm::max(maxT, t);
+	}
+	glm::vec3 e0 = mean + axis * maxT;
+	glm::vec3 e1 = mean + axis * minT;
+	glm::vec3 inset = (e0 - e1) / 16.0f; // los extremos quedan un poco adentro: menos error promedio
+	e0 -= inset;
+	e1 += inset;
+
+	static const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f }; // peso de e0 por índice
+	uint16_t c0 = 0, c1 = 0;
+	uint8_t indices[16] = {};
+	for (int pass = 0; pass < 3; pass++) {
+		c0 = PackRgb565(e0);
+		c1 = PackRgb565(e1);
+		glm::vec3 p0 = UnpackRgb565(c0), p1 = UnpackRgb565(c1);
+		glm::vec3 palette[4] = { p0, p1, (2.0f * p0 + p1) / 3.0f, (p0 + 2.0f * p1) / 3.0f };
+		for (int i = 0; i < 16; i++) {
+			float best = 1e30f;
+			for (int k = 0; k < 4; k++) {
+				glm::vec3 d = colors[i] - palette[k];
+				float err = glm::dot(d, d);
+				if (err < best) { best = err; indices[i] = (uint8_t)k; }
+			}
+		}
+		if (pass == 2) break;
+
+		// extremos que minimizan el error con los índices actuales
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		glm::vec3 ax(0.0f), bx(0.0f);
+		for (int i = 0; i < 16; i++) {
+			float a = weights[indices[i]], b = 1.0f - a;
+			aa += a * a; ab += a * b; bb += b * b;
+			ax += a * colors[i]; bx += b * colors[i];
+		}
+		float det = aa * bb - ab * ab;
+		if (std::fabs(det) < 1e-6f) break;
+		e0 = glm::clamp((ax * bb - bx * ab) / det, glm::vec3(0.0f), glm::vec3(255.0f));
+		e1 = glm::clamp((bx * aa - ax * ab) / det, glm::vec3(0.0f), glm::vec3(255.0f));
+	}
+
+	if (c0 < c1) {
+		std::swap(c0, c1);
+		static const uint8_t swapped[4] = { 1, 0, 3, 2 };
+		for (int i = 0; i < 16; i++) indices[i] = swapped[indices[i]];
+	}
+	else if (c0 == c1) {
+		for (int i = 0; i < 16; i++) indices[i] = 0;
+	}
+
+	uint32_t bits = 0;
+	for (int i = 0; i < 16; i++) bits |= (uint32_t)indices[i] << (2 * i);
+	out[0] = (uint8_t)(c0 & 0xFF); out[1] = (uint8_t)(c0 >> 8);
+	out[2] = (uint8_t)(c1 & 0xFF); out[3] = (uint8_t)(c1 >> 8);
+	for (int i = 0; i < 4; i++) out[4 + i] = (uint8_t)(bits >> (8 * i));
+}
+
+// un canal, modo de 8 valores (a0 > a1); también es el bloque de alfa de BC3
+inline void EncodeBC4Block(const uint8_t values[16], uint8_t out[8])
+{
+	int lo = 255, hi = 0;
+	for (int i = 0; i < 16; i++) {
+		lo = glm::min(lo, (int)values[i]);
+		hi = glm::max(hi, (int)values[i]);
+	}
+	memset(out, 0, 8);
+	out[0] = (uint8_t)hi;
+	out[1] = (uint8_t)lo;
+	if (hi == lo) return;
+
+	int palette[8] = { hi, lo };
+	for (int k = 2; k < 8; k++) palette[k] = ((8 - k) * hi + (k - 1) * lo + 3) / 7;
+
+	uint64_t bits = 0;
+	for (int i = 0; i < 16; i++) {
+		int best = 1 << 30;
+		uint64_t index = 0;
+		for (int k = 0; k < 8; k++) {
+			int err = std::abs(palette[k] - (int)values[i]);
+			if (err < best) { best = err; index = (uint64_t)k; }
+		}
+		bits |= index << (3 * i);
+	}
+	for (int i = 0; i < 6; i++) out[2 + i] = (uint8_t)(bits >> (8 * i));
+}
+
+inline void EncodeBC3Block(const uint8_t block[16][4], uint8_t out[16])
+{
+	uint8_t alpha[16];
+	for (int i = 0; i < 16; i++) alpha[i] = block[i][3];
+	EncodeBC4Block(alpha, out);
+	EncodeBC1Block(block, out + 8); // en BC3 el bloque de color siempre se lee en modo de 4 colores
+}
+
+inline void EncodeBC5Block(const uint8_t block[16][4], uint8_t out[16])
+{
+	uint8_t red[16], green[16];
+	for (int i = 0; i < 16; i++) {
+		red[i] = block[i][0];
+		green[i] = block[i][1];
+	}
+	EncodeBC4Block(red, out);
+	EncodeBC4Block(green, out + 8);
+}
+
+// escritor de bits LSB primero para los bloques de 128 bits de BC7
+struct BlockBitWriter {
+	uint8_t* out;
+	unsigned int pos;
+
+	explicit BlockBitWriter(uint8_t* block) : out(block), pos(0) { memset(out, 0, 16); }
+
+	void put(uint32_t value, unsigned int bits) {
+		for (unsigned int i = 0; i < bits; i++, pos++)
+			if ((value >> i) & 1u) out[pos >> 3] |= (uint8_t)(1u << (pos & 7));
+	}
+};
+
+/**
+ * @brief BC7 modo 6: un subconjunto RGBA, extremos de 7 bits + p-bit e índices de 4 bits
+ * Es el modo más sencillo de BC7 y ya da mejor calidad que BC3 para texturas con alfa.
+ */
+inline void EncodeBC7Block(const uint8_t block[16][4], uint8_t out[16])
+{
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	glm::vec4 colors[16];
+	glm::vec4 mean(0.0f);
+	for (int i = 0; i < 16; i++) {
+		colors[i] = glm::vec4(block[i][0], block[i][1], block[i][2], block[i][3]);
+		mean += colors[i];
+	}
+	mean /= 16.0f;
+	glm::vec4 axis = PrincipalAxis<4>(colors, 16, mean);
+
+	float minT = 1e30f, maxT = -1e30f;
+	for (int i = 0; i < 16; i++) {
+		float t = glm::dot(colors[i] - mean, axis);
+		minT = glm::min(minT, t);
+		maxT = glm::max(maxT, t);
+	}
+	glm::vec4 ends[2] = { mean + axis * minT, mean + axis * maxT };
+
+	// cuantiza cada extremo a 7 bits + p-bit compartido por sus cuatro canales
+	int q[2][4], p[2], value[2][4];
+	for (int e = 0; e < 2; e++) {
+		int bestError = 1 << 30;
+		for (int pbit = 0; pbit < 2; pbit++) {
+			int qc[4], err = 0;
+			for (int c = 0; c < 4; c++) {
+				float v = glm::clamp(ends[e][c], 0.0f, 255.0f);
+				qc[c] = glm::clamp((int)std::lround((v - pbit) / 2.0f), 0, 127);
+				int d = ((qc[c] << 1) | pbit) - (int)std::lround(v);
+				err += d * d;
+			}
+			if (err < bestError) {
+				bestError = err;
+				p[e] = pbit;
+				for (int c = 0; c < 4; c++) q[e][c] = qc[c];
+			}
+		}
+		for (int c = 0; c < 4; c++) value[e][c] = (q[e][c] << 1) | p[e];
+	}
+
+	int palette[16][4];
+	for (int k = 0; k < 16; k++)
+		for (int c = 0; c < 4; c++)
+			palette[k][c] = ((64 - weights[k]) * value[0][c] + weights[k] * value[1][c] + 32) >> 6;
+
+	int indices[16];
+	for (int i = 0; i < 16; i++) {
+		int best = 1 << 30;
+		for (int k = 0; k < 16; k++) {
+			int err = 0;
+			for (int c = 0; c < 4; c++) {
+				int d = palette[k][c] - (int)block[i][c];
+				err += d * d;
+			}
+			if (err < best) { best = err; indices[i] = k; }
+		}
+	}
+
+	// el índice del píxel 0 se guarda con 3 bits: su bit alto tiene que ser 0
+	if (indices[0] >= 8) {
+		for (int c = 0; c < 4; c++) std::swap(q[0][c], q[1][c]);
+		std::swap(p[0], p[1]);
+		for (int i = 0; i < 16; i++) indices[i] = 15 - indices[i];
+	}
+
+	BlockBitWriter w(out);
+	w.put(1u << 6, 7); // modo 6
+	for (int c = 0; c < 4; c++) {
+		w.put((uint32_t)q[0][c], 7);
+		w.put((uint32_t)q[1][c], 7);
+	}
+	w.put((uint32_t)p[0], 1);
+	w.put((uint32_t)p[1], 1);
+	w.put((uint32_t)indices[0], 3);
+	for (int i = 1; i < 16; i++) w.put((uint32_t)indices[i], 4);
+}
+
+inline void EncodeBlock(BlockFormat format, const uint8_t block[16][4], uint8_t* out)
+{
+	switch (format) {
+	case BLOCK_FORMAT_BC1: EncodeBC1Block(block, out); break;
+	case BLOCK_FORMAT_BC3: EncodeBC3Block(block, out); break;
+	case BLOCK_FORMAT_BC5: EncodeBC5Block(block, out); break;
+	case BLOCK_FORMAT_BC7: EncodeBC7Block(block, out); break;
+	case BLOCK_FORMAT_BC4: {
+		uint8_t red[16];
+		for (int i = 0; i < 16; i++) red[i] = block[i][0];
+		EncodeBC4Block(red, out);
+		break;
+	}
+	default: break;
+	}
+}
+
+/*  ------------------------------------------------------------------
+ *  Imágenes completas
+ *  ------------------------------------------------------------------ */
+
+// siguiente nivel de mip con filtro de caja 2x2; en mapas de normales se promedia el vector y se renormaliza
+inline vector<unsigned char> DownsampleRGBA8(const vector<unsigned char>& src, int width, int height, bool normalMap)
+{
+	int w = glm::max(width / 2, 1), h = glm::max(height / 2, 1);
+	vector<unsigned char> dst((size_t)w * h * 4);
+	for (int y = 0; y < h; y++) {
+		for (int x = 0; x < w; x++) {
+			glm::vec4 sum(0.0f);
+			for (int dy = 0; dy < 2; dy++) {
+				for (int dx = 0; dx < 2; dx++) {
+					int sx = glm::min(x * 2 + dx, width - 1), sy = glm::min(y * 2 + dy, height - 1);
+					const unsigned char* s = &src[((size_t)sy * width + sx) * 4];
+					sum += glm::vec4(s[0], s[1], s[2], s[3]);
+				}
+			}
+			glm::vec4 c = sum * 0.25f;
+			if (normalMap) {
+				glm::vec3 n = glm::vec3(c) / 127.5f - 1.0f;
+				float len = glm::length(n);
+				n = len > 1e-6f ? n / len : glm::vec3(0.0f, 0.0f, 1.0f);
+				c = glm::vec4((n + 1.0f) * 127.5f, c.a);
+			}
+			unsigned char* d = &dst[((size_t)y * w + x) * 4];
+			for (int k = 0; k < 4; k++) d[k] = (unsigned char)glm::clamp((int)std::lround(c[k]), 0, 255);
+		}
+	}
+	return dst;
+}
+
+// BC5 para normales; BC1 si todos los píxeles son opacos; si no BC7 (o BC3 si el driver no tiene BPTC)
+inline BlockFormat ChooseBlockFormat(TextureUsage usage, const unsigned char* rgba, size_t pixelCount, const BlockFormatSupport& support)
+{
+	if (usage == TEXTURE_USAGE_NORMAL) return support.bc5 ? BLOCK_FORMAT_BC5 : BLOCK_FORMAT_NONE;
+	bool opaque = true;
+	for (size_t i = 0; i < pixelCount && opaque; i++) opaque = rgba[i * 4 + 3] == 255;
+	if (opaque) return support.bc1 ? BLOCK_FORMAT_BC1 : BLOCK_FORMAT_NONE;
+	if (support.bc7) return BLOCK_FORMAT_BC7;
+	return support.bc3 ? BLOCK_FORMAT_BC3 : BLOCK_FORMAT_NONE;
+}
+
+/**
+ * @brief Comprime una imagen RGBA8 y, si se pide, toda su cadena de mips
+ * Las filas de bloques de cada nivel se reparten en el JobSystem.
+ */
+inline void CompressTexture(const unsigned char* rgba, int width, int height, BlockFormat format,
+	bool mipmaps, bool normalMap, CompressedTexture& out)
+{
+	out.format = format;
+	out.width = width;
+	out.height = height;
+	out.levels.clear();
+	out.data.clear();
+
+	vector<unsigned char> level(rgba, rgba + (size_t)width * height * 4);
+	int w = width, h = height;
+	for (;;) {
+		CompressedLevel info;
+		info.offset = out.data.size();
+		info.size = CompressedLevelSize(format, w, h);
+		info.width = w;
+		info.height = h;
+		out.levels.push_back(info);
+		out.data.resize(info.offset + info.size);
+
+		int blocksX = (w + 3) / 4, blocksY = (h + 3) / 4;
+		size_t blockBytes = BlockBytes(format);
+		unsigned char* dst = out.data.data() + info.offset;
+		const unsigned char* src = level.data();
+		JobSystem::instance().parallelFor((size_t)blocksY, [&](size_t by) {
+			uint8_t block[16][4];
+			for (int bx = 0; bx < blocksX; bx++) {
+				ExtractBlock(src, w, h, bx, (int)by, block);
+				EncodeBlock(format, block, dst + (by * blocksX + bx) * blockBytes);
+			}
+		});
+
+		if (!mipmaps || (w == 1 && h == 1)) break;
+		level = DownsampleRGBA8(level, w, h, normalMap);
+		w = glm::max(w / 2, 1);
+		h = glm::max(h / 2, 1);
+	}
+}
+
+/*  ------------------------------------------------------------------
+ *  Contenedor DDS
+ *  ------------------------------------------------------------------ */
+
+#define DDS_MAGIC           0x20534444u // "DDS "
+#define DDS_FOURCC(a,b,c,d) ((uint32_t)(uint8_t)(a) | ((uint32_t)(uint8_t)(b) << 8) | ((uint32_t)(uint8_t)(c) << 16) | ((uint32_t)(uint8_t)(d) << 24))
+
+struct DDSPixelFormat {
+	uint32_t size, flags, fourCC, rgbBitCount, rMask, gMask, bMask, aMask;
+};
+
+struct DDSHeader {
+	uint32_t       size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+	uint32_t       reserved1[11];
+	DDSPixelFormat pixelFormat;
+	uint32_t       caps, caps2, caps3, caps4, reserved2;
+};
+
+struct DDSHeaderDX10 {
+	uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+};
+
+static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+static_assert(sizeof(DDSHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+
+inline uint32_t BlockFormatDXGI(BlockFormat format) {
+	switch (format) {
+	case BLOCK_FORMAT_BC1: return 71; // DXGI_FORMAT_BC1_UNORM
+	case BLOCK_FORMAT_BC3: return 77;
+	case BLOCK_FORMAT_BC4: return 80;
+	case BLOCK_FORMAT_BC5: return 83;
+	case BLOCK_FORMAT_BC7: return 98;
+	default: return 0;
+	}
+}
+
+// las variantes _SRGB se cargan igual: el espacio de color lo decide quien sube la textura
+inline BlockFormat BlockFormatFromDXGI(uint32_t dxgi) {
+	switch (dxgi) {
+	case 71: case 72: return BLOCK_FORMAT_BC1;
+	case 77: case 78: return BLOCK_FORMAT_BC3;
+	case 80: return BLOCK_FORMAT_BC4;
+	case 83: return BLOCK_FORMAT_BC5;
+	case 98: case 99: return BLOCK_FORMAT_BC7;
+	default: return BLOCK_FORMAT_NONE;
+	}
+}
+
+inline BlockFormat BlockFormatFromFourCC(uint32_t fourCC) {
+	if (fourCC == DDS_FOURCC('D', 'X', 'T', '1')) return BLOCK_FORMAT_BC1;
+	if (fourCC == DDS_FOURCC('D', 'X', 'T', '5')) return BLOCK_FORMAT_BC3;
+	if (fourCC == DDS_FOURCC('A', 'T', 'I', '1') || fourCC == DDS_FOURCC('B', 'C', '4', 'U')) return BLOCK_FORMAT_BC4;
+	if (fourCC == DDS_FOURCC('A', 'T', 'I', '2') || fourCC == DDS_FOURCC('B', 'C', '5', 'U')) return BLOCK_FORMAT_BC5;
+	return BLOCK_FORMAT_NONE;
+}
+
+inline string GetTextureBakePath(const string& sourcePath) {
+	return sourcePath + TEXTURE_BAKE_EXTENSION;
+}
+
+inline bool EndsWithDDS(const string& path) {
+	if (path.size() < 4) return false;
+	string ext = path.substr(path.size() - 4);
+	for (char& c : ext) c = (char)tolower((unsigned char)c);
+	return ext == TEXTURE_BAKE_EXTENSION;
+}
+
+/**
+ * @brief Lee un .dds 2D comprimido por bloques (FourCC DXT1/DXT5/ATI1/ATI2 o cabecera DX10)
+ * @param header Si no es nulo recibe la cabecera (para validar el sello del bake)
+ */
+inline bool LoadDDS(const string& path, CompressedTexture& out, DDSHeader* header = nullptr)
+{
+	MappedFile file;
+	if (!file.open(path)) return false;
+	const unsigned char* p = file.data();
+	size_t size = file.size();
+
+	DDSHeader h;
+	uint32_t magic;
+	if (size < 4 + sizeof(DDSHeader)) return false;
+	memcpy(&magic, p, 4);
+	memcpy(&h, p + 4, sizeof(h));
+	if (magic != DDS_MAGIC || h.size != sizeof(DDSHeader)) return false;
+	size_t offset = 4 + sizeof(DDSHeader);
+
+	BlockFormat format = BlockFormatFromFourCC(h.pixelFormat.fourCC);
+	if (h.pixelFormat.fourCC == DDS_FOURCC('D', 'X', '1', '0')) {
+		DDSHeaderDX10 dx10;
+		if (size < offset + sizeof(dx10)) return false;
+		memcpy(&dx10, p + offset, sizeof(dx10));
+		offset += sizeof(dx10);
+		if (dx10.resourceDimension != 3 || dx10.arraySize > 1 || (dx10.miscFlag & 0x4u)) {
+			cout << "DDS:: only single 2D textures are supported: " << path << endl;
+			return false;
+		}
+		format = BlockFormatFromDXGI(dx10.dxgiFormat);
+	}
+	if (format == BLOCK_FORMAT_NONE || (h.caps2 & 0x200u) || h.width == 0 || h.height == 0) {
+		cout << "DDS:: unsupported format in " << path << endl;
+		return false;
+	}
+
+	out.format = format;
+	out.width = (int)h.width;
+	out.height = (int)h.height;
+	out.levels.clear();
+	unsigned int levelCount = glm::max(h.mipMapCount, 1u);
+	int w = out.width, hgt = out.height;
+	size_t dataSize = 0;
+	for (unsigned int i = 0; i < levelCount; i++) {
+		CompressedLevel level;
+		level.offset = dataSize;
+		level.size = CompressedLevelSize(format, w, hgt);
+		level.width = w;
+		level.height = hgt;
+		out.levels.push_back(level);
+		dataSize += level.size;
+		w = glm::max(w / 2, 1);
+		hgt = glm::max(hgt / 2, 1);
+	}
+	if (size < offset + dataSize) {
+		cout << "DDS:: truncated file " << path << endl;
+		return false;
+	}
+	out.data.assign(p + offset, p + offset + dataSize);
+	if (header) *header = h;
+	return true;
+}
+
+inline bool WriteDDS(const string& path, const CompressedTexture& texture, const uint32_t reserved[11])
+{
+	DDSHeader h;
+	memset(&h, 0, sizeof(h));
+	h.size = sizeof(DDSHeader);
+	h.flags = 0x1u | 0x2u | 0x4u | 0x1000u | 0x80000u | (texture.levels.size() > 1 ? 0x20000u : 0u); // CAPS|HEIGHT|WIDTH|PIXELFORMAT|LINEARSIZE|MIPMAPCOUNT
+	h.height = (uint32_t)texture.height;
+	h.width = (uint32_t)texture.width;
+	h.pitchOrLinearSize = (uint32_t)texture.levels[0].size;
+	h.mipMapCount = (uint32_t)texture.levels.size();
+	memcpy(h.reserved1, reserved, sizeof(h.reserved1));
+	h.pixelFormat.size = sizeof(DDSPixelFormat);
+	h.pixelFormat.flags = 0x4u; // FOURCC
+	h.pixelFormat.fourCC = DDS_FOURCC('D', 'X', '1', '0');
+	h.caps = 0x1000u | (texture.levels.size() > 1 ? 0x400008u : 0u); // TEXTURE (| MIPMAP | COMPLEX)
+
+	DDSHeaderDX10 dx10;
+	dx10.dxgiFormat = BlockFormatDXGI(texture.format);
+	dx10.resourceDimension = 3; // TEXTURE2D
+	dx10.miscFlag = 0;
+	dx10.arraySize = 1;
+	dx10.miscFlags2 = 0;
+
+	string tmpPath = path + ".tmp";
+	FILE* f = OpenBakeFile(tmpPath, "wb");
+	if (!f) {
+		cout << "DDS:: could not write " << tmpPath << endl;
+		return false;
+	}
+	uint32_t magic = DDS_MAGIC;
+	bool ok = fwrite(&magic, 4, 1, f) == 1 && fwrite(&h, sizeof(h), 1, f) == 1 && fwrite(&dx10, sizeof(dx10), 1, f) == 1 &&
+		fwrite(texture.data.data(), 1, texture.data.size(), f) == texture.data.size();
+	ok = fclose(f) == 0 && ok;
+	if (!ok) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	remove(path.c_str());
+	if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+		remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Carga el bake comprimido de una imagen si existe y corresponde a la fuente y al uso actuales
+ */
+inline bool LoadTextureBake(const string& sourcePath, TextureUsage usage, CompressedTexture& out)
+{
+	BakeSourceStamp stamp;
+	if (!GetBakeSourceStamp(sourcePath, stamp)) return false;
+
+	DDSHeader h;
+	if (!LoadDDS(GetTextureBakePath(sourcePath), out, &h)) return false;
+	const uint32_t* r = h.reserved1;
+	return r[0] == TEXTURE_BAKE_TAG && r[1] == TEXTURE_BAKE_VERSION && r[2] == (uint32_t)usage &&
+		r[3] == (uint32_t)stamp.size && r[4] == (uint32_t)(stamp.size >> 32) &&
+		r[5] == (uint32_t)stamp.mtime && r[6] == (uint32_t)((uint64_t)stamp.mtime >> 32);
+}
+
+inline bool WriteTextureBake(const string& sourcePath, TextureUsage usage, const CompressedTexture& texture)
+{
+	BakeSourceStamp stamp;
+	if (!texture.valid() || !GetBakeSourceStamp(sourcePath, stamp)) return false;
+	uint32_t reserved[11] = {};
+	reserved[0] = TEXTURE_BAKE_TAG;
+	reserved[1] = TEXTURE_BAKE_VERSION;
+	reserved[2] = (uint32_t)usage;
+	reserved[3] = (uint32_t)stamp.size;
+	reserved[4] = (uint32_t)(stamp.size >> 32);
+	reserved[5] = (uint32_t)stamp.mtime;
+	reserved[6] = (uint32_t)((uint64_t)stamp.mtime >> 32);
+	return WriteDDS(GetTextureBakePath(sourcePath), texture, reserved);
+}
+
+// pone el sello actual de la fuente en un bake del mismo uso y versión (contenido sin cambios)
+inline bool RestampTextureBake(const string& sourcePath, TextureUsage usage)
+{
+	BakeSourceStamp stamp;
+	if (!GetBakeSourceStamp(sourcePath, stamp)) return false;
+	FILE* f = OpenBakeFile(GetTextureBakePath(sourcePath), "r+b");
+	if (!f) return false;
+	uint32_t magic = 0;
+	DDSHeader h;
+	bool ok = fread(&magic, 4, 1, f) == 1 && fread(&h, sizeof(h), 1, f) == 1 && magic == DDS_MAGIC &&
+		h.reserved1[0] == TEXTURE_BAKE_TAG && h.reserved1[1] == TEXTURE_BAKE_VERSION && h.reserved1[2] == (uint32_t)usage;
+	if (ok) {
+		h.reserved1[3] = (uint32_t)stamp.size;
+		h.reserved1[4] = (uint32_t)(stamp.size >> 32);
+		h.reserved1[5] = (uint32_t)stamp.mtime;
+		h.reserved1[6] = (uint32_t)((uint64_t)stamp.mtime >> 32);
+		ok = fseek(f, 4, SEEK_SET) == 0 && fwrite(&h, sizeof(h), 1, f) == 1;
+	}
+	ok = fclose(f) == 0 && ok;
+	return ok;
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef TEXTURERESIDENCY_H
+#define TEXTURERESIDENCY_H
+
+#include <glad/glad.h>
+
+#include <jobsystem.h>
+#include <texturecompress.h>
+#include <loadprofiler.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief Residencia de mips de las texturas comprimidas según el tamaño en pantalla
+ * Cada textura registrada arranca sólo con los mips de BASE_SIZE píxeles o menos. Los objetos piden
+ * cada frame el tamaño con que se ven (require) y update() vuelve a leer el .dds del disco en el
+ * JobSystem para subir los mips que faltan. Si la memoria residente pasa del presupuesto se sueltan
+ * los mips grandes de las texturas usadas hace más tiempo: el nivel se re-especifica con 0x0 y
+ * GL_TEXTURE_BASE_LEVEL apunta al primer nivel que sigue en la GPU. Sólo desde el hilo de GL.
+ */
+class TextureResidency {
+public:
+	static const size_t DEFAULT_BUDGET = 256u << 20;
+	static const size_t BYTES_PER_UPDATE = 8u << 20; // subida máxima por frame (al menos una textura pasa)
+	static const int    BASE_SIZE = 64;              // lado del mip más grande con que arranca cada textura
+	static const size_t MAX_LOADS = 4;               // lecturas de disco simultáneas
+	static const unsigned int IDLE_FRAMES = 120;     // sin pedirse este tiempo, la textura baja hasta BASE_SIZE
+
+	static TextureResidency& instance() {
+		static TextureResidency residency;
+		return residency;
+	}
+
+	// primer nivel cuyo lado mayor no pasa de BASE_SIZE; con él se sube la textura al principio
+	static size_t initialLevel(const CompressedTexture& texture) {
+		size_t level = 0;
+		while (level + 1 < texture.levels.size() &&
+			std::max(texture.levels[level].width, texture.levels[level].height) > BASE_SIZE) level++;
+		return level;
+	}
+
+	/**
+	 * @brief Registra una textura 2D recién subida con sus niveles desde residentBase
+	 * @param path Archivo del que se pueden volver a leer los mips (.dds o fuente con bake)
+	 */
+	void track(unsigned int texture, const string& path, TextureUsage usage, GLenum internalFormat,
+		const CompressedTexture& data, size_t residentBase) {
+		untrack(texture);
+		Entry& entry = entries[texture];
+		entry = Entry();
+		entry.path = path;
+		entry.usage = usage;
+		entry.format = data.format;
+		entry.internalFormat = internalFormat;
+		entry.levels = data.levels;
+		entry.floorLevel = residentBase;
+		entry.residentBase = residentBase;
+		entry.wantedBase = residentBase;
+		entry.requestedBase = residentBase;
+		entry.lastUsedFrame = frame;
+		entry.serial = ++nextSerial;
+		residentBytes += entry.bytesFrom(residentBase);
+	}
+
+	// la textura se va a borrar; una lectura en curso se descarta al llegar
+	void untrack(unsigned int texture) {
+		auto it = entries.find(texture);
+		if (it == entries.end()) return;
+		residentBytes -= it->second.bytesFrom(it->second.residentBase);
+		entries.erase(it);
+	}
+
+	/**
+	 * @brief Pide que las texturas tengan detalle para cubrir pixels píxeles de pantalla
+	 * Se llama al dibujar; el nivel que se pide es el más chico cuyo lado mayor sigue siendo >= pixels.
+	 */
+	void require(unsigned int texture, float pixels) {
+		auto it = entries.find(texture);
+		if (it == entries.end()) return;
+		Entry& entry = it->second;
+		entry.lastUsedFrame = frame;
+
+		const CompressedLevel& top = entry.levels[0];
+		float size = (float)std::max(top.width, top.height);
+		size_t level = 0;
+		if (pixels * detailBias < size) {
+			float steps = std::floor(std::log2(size / std::max(pixels * detailBias, 1.0f)));
+			level = std::min((size_t)std::max(steps, 0.0f), entry.floorLevel);
+		}
+		entry.requestedBase = std::min(entry.requestedBase, level);
+	}
+
+	template <typename TextureT>
+	void require(const vector<TextureT>& textures, float pixels) {
+		for (const TextureT& texture : textures) require(texture.id, pixels);
+	}
+
+	/**
+	 * @brief Una vez por frame, antes de dibujar
+	 * Sube los mips que ya se leyeron, suelta mips si se pasó del presupuesto y lanza nuevas lecturas.
+	 */
+	void update() {
+		frame++;
+		for (auto& it : entries) {
+			Entry& entry = it.second;
+			if (entry.lastUsedFrame + 1 >= frame) entry.wantedBase = entry.requestedBase;
+			else if (entry.lastUsedFrame + IDLE_FRAMES < frame) entry.wantedBase = entry.floorLevel;
+			entry.requestedBase = entry.floorLevel;
+		}
+		uploadLoaded();
+		evict();
+		startLoads();
+	}
+
+	void setBudget(size_t bytes) { budget = bytes; }
+	size_t getBudget() const { return budget; }
+
+	// > 1 pide más detalle del que cubre el objeto en pantalla, < 1 menos
+	void setDetailBias(float bias) { detailBias = bias; }
+	float getDetailBias() const { return detailBias; }
+
+	// con la residencia apagada las texturas se suben completas (ver TextureStreamer)
+	void setEnabled(bool value) { enabled = value; }
+	bool isEnabled() const { return enabled; }
+
+	size_t getResidentBytes() const { return residentBytes; }
+	size_t trackedCount() const { return entries.size(); }
+
+private:
+	struct Entry {
+		string                  path;
+		TextureUsage            usage;
+		BlockFormat             format;
+		GLenum                  internalFormat;
+		vector<CompressedLevel> levels;
+		size_t                  floorLevel;    // nunca se suelta de aquí hacia abajo
+		size_t                  residentBase;  // primer nivel en la GPU (GL_TEXTURE_BASE_LEVEL)
+		size_t                  wantedBase;    // lo que pidieron los objetos el último frame en que se usó
+		size_t                  requestedBase; // acumulado del frame actual
+		unsigned int            lastUsedFrame;
+		unsigned int            serial;        // distingue un id de textura reutilizado
+		bool                    loading;
+		bool                    failed;        // el archivo ya no coincide: se queda como está
+
+		Entry() : usage(TEXTURE_USAGE_COLOR), format(BLOCK_FORMAT_NONE), internalFormat(0), floorLevel(0), residentBase(0),
+			wantedBase(0), requestedBase(0), lastUsedFrame(0), serial(0), loading(false), failed(false) {}
+
+		size_t bytesFrom(size_t base) const {
+			size_t bytes = 0;
+			for (size_t l = base; l < levels.size(); l++) bytes += levels[l].size;
+			return bytes;
+		}
+	};
+
+	struct Load {
+		unsigned int      texture;
+		unsigned int      serial;
+		CompressedTexture data;
+	};
+	typedef shared_ptr<Load> LoadPtr;
+
+	unordered_map<unsigned int, Entry> entries; // por id de textura
+	mutex loadedMutex;
+	deque<LoadPtr> loaded;
+	size_t loadsInFlight;
+	size_t residentBytes;
+	size_t budget;
+	float detailBias;
+	bool enabled;
+	unsigned int frame;
+	unsigned int nextSerial;
+
+	TextureResidency() : loadsInFlight(0), residentBytes(0), budget(DEFAULT_BUDGET), detailBias(1.0f),
+		enabled(true), frame(0), nextSerial(0) {}
+	TextureResidency(const TextureResidency&) = delete;
+	TextureResidency& operator=(const TextureResidency&) = delete;
+
+	static bool sameLayout(const Entry& entry, const CompressedTexture& data) {
+		if (!data.valid() || data.format != entry.format || data.levels.size() != entry.levels.size()) return false;
+		for (size_t l = 0; l < data.levels.size(); l++)
+			if (data.levels[l].width != entry.levels[l].width || data.levels[l].height != entry.levels[l].height) return false;
+		return true;
+	}
+
+	void uploadLoaded() {
+		size_t uploaded = 0;
+		while (uploaded < BYTES_PER_UPDATE) {
+			LoadPtr load;
+			{
+				lock_guard<mutex> lock(loadedMutex);
+				if (loaded.empty()) break;
+				load = loaded.front();
+				loaded.pop_front();
+			}
+			loadsInFlight--;
+
+			auto it = entries.find(load->texture);
+			if (it == entries.end() || it->second.serial != load->serial) continue; // se borró mientras se leía
+			Entry& entry = it->second;
+			entry.loading = false;
+			if (!sameLayout(entry, load->data)) {
+				cout << "TEXTURERESIDENCY:: " << entry.path << " changed on disk, mip streaming disabled for it" << endl;
+				entry.failed = true;
+				continue;
+			}
+			if (entry.wantedBase >= entry.residentBase) continue; // ya no hace falta
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glBindTexture(GL_TEXTURE_2D, it->first);
+			for (size_t l = entry.wantedBase; l < entry.residentBase; l++) {
+				const CompressedLevel& level = load->data.levels[l];
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)l, entry.internalFormat, level.width, level.height, 0,
+					(GLsizei)level.size, load->data.data.data() + level.offset);
+				uploaded += level.size;
+			}
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)entry.wantedBase);
+			glBindTexture(GL_TEXTURE_2D, 0);
+			residentBytes += entry.bytesFrom(entry.wantedBase) - entry.bytesFrom(entry.residentBase);
+			entry.residentBase = entry.wantedBase;
+		}
+	}
+
+	// suelta los niveles [residentBase, newBase)
+	void dropLevels(unsigned int texture, Entry& entry, size_t newBase) {
+		if (newBase <= entry.residentBase) return;
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)newBase);
+		for (size_t l = entry.residentBase; l < newBase; l++)
+			glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)l, entry.internalFormat, 0, 0, 0, 0, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		residentBytes -= entry.bytesFrom(entry.residentBase) - entry.bytesFrom(newBase);
+		entry.residentBase = newBase;
+	}
+
+	// primero lo que nadie pidió en más tiempo; a igual antigüedad, lo que libera más memoria
+	vector<unsigned int> leastRecentlyUsed() const {
+		vector<unsigned int> order;
+		order.reserve(entries.size());
+		for (const auto& it : entries) order.push_back(it.first);
+		std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+			const Entry& ea = entries.at(a);
+			const Entry& eb = entries.at(b);
+			if (ea.lastUsedFrame != eb.lastUsedFrame) return ea.lastUsedFrame < eb.lastUsedFrame;
+			return ea.bytesFrom(ea.residentBase) > eb.bytesFrom(eb.residentBase);
+		});
+		return order;
+	}
+
+	void evict() {
+		if (residentBytes <= budget) return;
+		vector<unsigned int> order = leastRecentlyUsed();
+		// primera pasada: mips que sobran respecto a lo pedido; segunda: un nivel a la vez aunque se use
+		for (int pass = 0; pass < 2 && residentBytes > budget; pass++) {
+			for (unsigned int texture : order) {
+				if (residentBytes <= budget) break;
+				Entry& entry = entries[texture];
+				if (entry.residentBase >= entry.floorLevel) continue;
+				size_t newBase = pass == 0 ? std::min(entry.wantedBase, entry.floorLevel) : entry.residentBase + 1;
+				dropLevels(texture, entry, newBase);
+			}
+		}
+	}
+
+	void startLoads() {
+		if (!enabled) return;
+		// lo más reciente primero; no se lee lo que no cabría en el presupuesto
+		vector<unsigned int> order = leastRecentlyUsed();
+		size_t projected = residentBytes;
+		for (auto it = order.rbegin(); it != order.rend() && loadsInFlight < MAX_LOADS; ++it) {
+			Entry& entry = entries[*it];
+			if (entry.loading || entry.failed || entry.wantedBase >= entry.residentBase) continue;
+			size_t extra = entry.bytesFrom(entry.wantedBase) - entry.bytesFrom(entry.residentBase);
+			if (projected + extra > budget) continue;
+			projected += extra;
+
+			entry.loading = true;
+			loadsInFlight++;
+			LoadPtr load = make_shared<Load>();
+			load->texture = *it;
+			load->serial = entry.serial;
+			string path = entry.path;
+			TextureUsage usage = entry.usage;
+			JobSystem::instance().submit([this, load, path, usage]() {
+				{
+					ScopedLoadTimer timer(path, "mip stream read");
+					bool ok = EndsWithDDS(path) ? LoadDDS(path, load->data) : LoadTextureBake(path, usage, load->data);
+					if (!ok) load->data = CompressedTexture();
+					timer.addBytes(LOAD_BYTES_TEXTURE, load->data.data.size());
+				}
+				lock_guard<mutex> lock(loadedMutex);
+				loaded.push_back(load);
+			});
+		}
+	}
+};
+
+#endif
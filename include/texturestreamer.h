@@ -0,0 +1,432 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <jobsystem.h>
+#include <texturecompress.h>
+#include <textureresidency.h>
+#include <loadprofiler.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+using namespace std;
+
+/**
+ * @brief Carga de texturas en segundo plano
+ * requestTexture/requestCubemap crean la textura con un placeholder de 1x1 y regresan su id de
+ * inmediato. La decodificación (stbi_load) corre en el JobSystem, una imagen por trabajo, y pump()
+ * sube lo que ya terminó a través de un anillo de pixel unpack buffers, re-especificando la misma
+ * textura: quien guardó el id no se entera del cambio. pump() y flush() sólo desde el hilo de GL.
+ * Con la compresión activa cada imagen se sube como BC1/BC5/BC7 con sus mips precalculados: se lee el
+ * .dds horneado junto a la fuente o, si no existe o está obsoleto, se codifica en el trabajo y se guarda.
+ * Las texturas pedidas con streamMips suben sólo sus mips chicos y TextureResidency trae el resto del disco.
+ */
+class TextureStreamer {
+public:
+	// bytes que se suben por llamada a pump() (al menos una textura siempre pasa)
+	static const size_t DEFAULT_BYTES_PER_PUMP = 16u << 20;
+	static const size_t RING_SIZE = 4;
+
+	static TextureStreamer& instance() {
+		static TextureStreamer streamer;
+		return streamer;
+	}
+
+	unsigned int requestTexture(const string& path, bool gamma = false, TextureUsage usage = TEXTURE_USAGE_COLOR, bool streamMips = false) {
+		querySupport();
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder());
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		enqueue(texture, GL_TEXTURE_2D, gamma, usage, vector<string>{ path }, streamMips);
+		return texture;
+	}
+
+	// las caras van en el orden +X, -X, +Y, -Y, +Z, -Z y se decodifican en paralelo
+	unsigned int requestCubemap(const vector<string>& faces) {
+		querySupport();
+		GLuint texture;
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+		for (unsigned int i = 0; i < 6; i++)
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder());
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+		enqueue(texture, GL_TEXTURE_CUBE_MAP, false, TEXTURE_USAGE_COLOR, faces, false);
+		return texture;
+	}
+
+	/**
+	 * @brief Sube las texturas ya decodificadas, hasta byteBudget bytes
+	 * Si el buffer del anillo que toca sigue en uso por la GPU se detiene y continúa el siguiente frame.
+	 */
+	void pump(size_t byteBudget = DEFAULT_BYTES_PER_PUMP) {
+		pumpInternal(byteBudget, false);
+	}
+
+	// bloquea hasta que todas las solicitudes hechas hasta ahora estén en la GPU
+	void flush() {
+		while (pending.load() > 0) {
+			{
+				unique_lock<mutex> lock(readyMutex);
+				readyChanged.wait(lock, [this]() { return !ready.empty(); });
+			}
+			pumpInternal((size_t)-1, true);
+		}
+	}
+
+	// solicitudes que todavía no llegan a la GPU (decodificando o esperando pump)
+	size_t pendingCount() const { return pending.load(); }
+
+	// compresión por bloques de las texturas que se pidan a partir de ahora (activa por defecto)
+	void setCompression(bool enabled) { compression = enabled; }
+	bool getCompression() const { return compression; }
+
+	// descarta la subida pendiente de una textura que se va a borrar (el id puede reutilizarse después)
+	void cancel(unsigned int texture) {
+		auto it = inFlight.find(texture);
+		if (it == inFlight.end()) return;
+		it->second->cancelled = true;
+		inFlight.erase(it);
+	}
+
+	~TextureStreamer() {
+		// el contexto de GL ya no existe aquí: sólo se libera la memoria de CPU
+		for (RequestPtr& request : ready)
+			for (Image& image : request->images) stbi_image_free(image.pixels);
+	}
+
+private:
+	struct Image {
+		string         path;
+		int            width, height, channels;
+		unsigned char* pixels; // RGBA/RGB sin comprimir (stbi_load); nullptr si se usa compressed o si falló
+		CompressedTexture compressed;
+		bool           onDisk; // compressed se puede volver a leer del disco (.dds o bake escrito)
+	};
+
+	struct Request {
+		GLuint         texture;
+		GLenum         target; // GL_TEXTURE_2D o GL_TEXTURE_CUBE_MAP
+		bool           gamma;
+		TextureUsage   usage;
+		bool           compress;
+		bool           streamMips; // 2D comprimida: sólo mips chicos, el resto por TextureResidency
+		vector<Image>  images; // una por cara
+		atomic<size_t> remaining;
+		bool           cancelled; // sólo se lee y escribe en el hilo de GL
+	};
+	typedef shared_ptr<Request> RequestPtr;
+
+	struct RingSlot {
+		GLuint pbo;
+		size_t capacity;
+		GLsync fence; // se señala cuando la GPU terminó de leer el buffer
+	};
+
+	// gris medio opaco mientras llega la imagen real
+	static const unsigned char* placeholder() {
+		static const unsigned char pixel[4] = { 128, 128, 128, 255 };
+		return pixel;
+	}
+
+	mutex readyMutex;
+	condition_variable readyChanged;
+	deque<RequestPtr> ready;
+	atomic<size_t> pending;
+	unordered_map<GLuint, RequestPtr> inFlight; // por id de textura, hasta que se sube o se cancela
+	vector<RingSlot> ring;
+	size_t nextSlot;
+	bool compression;
+	bool supportQueried;
+	BlockFormatSupport support; // se llena en el hilo de GL antes del primer trabajo
+
+	TextureStreamer() : pending(0), nextSlot(0), compression(true), supportQueried(false) {}
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+	void querySupport() {
+		if (supportQueried) return;
+		support = BlockFormatSupport::query();
+		supportQueried = true;
+	}
+
+	void enqueue(GLuint texture, GLenum target, bool gamma, TextureUsage usage, const vector<string>& paths, bool streamMips) {
+		RequestPtr request = make_shared<Request>();
+		request->texture = texture;
+		request->target = target;
+		request->gamma = gamma;
+		request->usage = usage;
+		request->compress = compression;
+		request->streamMips = streamMips && TextureResidency::instance().isEnabled();
+		request->cancelled = false;
+		request->images.resize(paths.size());
+		request->remaining = paths.size();
+		for (size_t i = 0; i < paths.size(); i++) {
+			request->images[i].path = paths[i];
+			request->images[i].pixels = nullptr;
+			request->images[i].onDisk = false;
+		}
+		pending++;
+		inFlight[texture] = request;
+
+		for (size_t i = 0; i < paths.size(); i++) {
+			JobSystem::instance().submit([this, request, i]() {
+				decode(*request, request->images[i]);
+				if (request->remaining.fetch_sub(1) == 1) {
+					lock_guard<mutex> lock(readyMutex);
+					ready.push_back(request);
+					readyChanged.notify_all();
+				}
+			});
+		}
+	}
+
+	bool wantsMipmaps(const Request& request) const {
+		return request.target == GL_TEXTURE_2D;
+	}
+
+	// corre en un hilo de trabajo: sólo CPU y disco
+	void decode(const Request& request, Image& image) {
+		if (EndsWithDDS(image.path)) {
+			ScopedLoadTimer timer(image.path, "dds read");
+			bool loaded = LoadDDS(image.path, image.compressed);
+			if (loaded) timer.addBytes(LOAD_BYTES_TEXTURE, image.compressed.data.size());
+			if (!loaded || !support.supports(image.compressed.format))
+				image.compressed = CompressedTexture();
+			image.onDisk = image.compressed.valid();
+			return;
+		}
+
+		if (request.compress) {
+			ScopedLoadTimer timer(image.path, "bake read");
+			if (LoadTextureBake(image.path, request.usage, image.compressed) && support.supports(image.compressed.format) &&
+				(!wantsMipmaps(request) || (image.compressed.levels.back().width == 1 && image.compressed.levels.back().height == 1))) {
+				image.onDisk = true;
+				timer.addBytes(LOAD_BYTES_TEXTURE, image.compressed.data.size());
+				return;
+			}
+			image.compressed = CompressedTexture();
+		}
+
+		{
+			ScopedLoadTimer timer(image.path, "stbi_load");
+			image.pixels = stbi_load(image.path.c_str(), &image.width, &image.height, &image.channels, request.compress ? 4 : 0);
+			if (image.pixels)
+				timer.addBytes(LOAD_BYTES_TEXTURE, (size_t)image.width * image.height * (request.compress ? 4 : image.channels));
+		}
+		if (!image.pixels || !request.compress) return;
+		image.channels = 4;
+
+		BlockFormat format = ChooseBlockFormat(request.usage, image.pixels, (size_t)image.width * image.height, support);
+		if (format == BLOCK_FORMAT_NONE) return; // el driver no lo soporta: se sube RGBA
+
+		{
+			ScopedLoadTimer timer(image.path, "block encode");
+			CompressTexture(image.pixels, image.width, image.height, format, wantsMipmaps(request),
+				request.usage == TEXTURE_USAGE_NORMAL, image.compressed);
+			timer.addBytes(LOAD_BYTES_TEXTURE, (size_t)image.width * image.height * 4);
+		}
+		{
+			ScopedLoadTimer timer(image.path, "bake write");
+			image.onDisk = WriteTextureBake(image.path, request.usage, image.compressed);
+		}
+		if (!image.onDisk)
+			cout << "TEXTURESTREAMER:: could not write " << GetTextureBakePath(image.path) << endl;
+		cout << "TEXTURESTREAMER:: encoded " << image.path << " as " << BlockFormatName(format) << " ("
+			<< image.compressed.levels.size() << " mips, " << image.compressed.data.size() / 1024 << " KB)" << endl;
+		stbi_image_free(image.pixels);
+		image.pixels = nullptr;
+	}
+
+	// niveles que se suben de una imagen comprimida: toda la cadena en 2D, sólo el nivel 0 en cubemaps
+	size_t uploadLevels(const Request& request, const Image& image) const {
+		return wantsMipmaps(request) ? image.compressed.levels.size() : 1;
+	}
+
+	// primer nivel que se sube; los anteriores quedan a cargo de TextureResidency
+	size_t firstUploadLevel(const Request& request, const Image& image) const {
+		if (!request.streamMips || !image.onDisk || !wantsMipmaps(request)) return 0;
+		return TextureResidency::initialLevel(image.compressed);
+	}
+
+	size_t imageBytes(const Request& request, const Image& image) const {
+		if (image.compressed.valid()) {
+			const CompressedLevel& last = image.compressed.levels[uploadLevels(request, image) - 1];
+			return last.offset + last.size;
+		}
+		return image.pixels ? (size_t)image.width * image.height * image.channels : 0;
+	}
+
+	void pumpInternal(size_t byteBudget, bool wait) {
+		if (ring.empty()) {
+			ring.resize(RING_SIZE, RingSlot{ 0, 0, nullptr });
+			for (RingSlot& slot : ring) glGenBuffers(1, &slot.pbo);
+		}
+
+		size_t uploaded = 0;
+		for (;;) {
+			RequestPtr request;
+			{
+				lock_guard<mutex> lock(readyMutex);
+				if (ready.empty()) break;
+				request = ready.front();
+				if (request->cancelled) ready.pop_front();
+			}
+			if (request->cancelled) {
+				for (Image& image : request->images) stbi_image_free(image.pixels);
+				pending--;
+				continue;
+			}
+
+			RingSlot& slot = ring[nextSlot];
+			if (slot.fence) {
+				GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? 1000000000ull : 0);
+				if (status == GL_TIMEOUT_EXPIRED) break;
+				glDeleteSync(slot.fence);
+				slot.fence = nullptr;
+			}
+
+			{
+				lock_guard<mutex> lock(readyMutex);
+				ready.pop_front();
+			}
+			inFlight.erase(request->texture);
+			uploaded += upload(*request, slot);
+			nextSlot = (nextSlot + 1) % ring.size();
+			pending--;
+			if (uploaded >= byteBudget) break;
+		}
+	}
+
+	size_t upload(Request& request, RingSlot& slot) {
+		ScopedLoadTimer timer(request.images.empty() ? string() : request.images[0].path, "gl upload");
+		vector<size_t> offsets(request.images.size(), 0);
+		size_t total = 0;
+		for (size_t i = 0; i < request.images.size(); i++) {
+			const Image& image = request.images[i];
+			size_t bytes = imageBytes(request, image);
+			if (bytes == 0) {
+				std::cout << "Texture failed to load at path: " << image.path << std::endl;
+				continue;
+			}
+			offsets[i] = total;
+			total += bytes;
+		}
+		if (total == 0) return 0; // se queda el placeholder
+		timer.addBytes(LOAD_BYTES_TEXTURE, total);
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.pbo);
+		if (slot.capacity < total) {
+			glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)total, nullptr, GL_STREAM_DRAW);
+			slot.capacity = total;
+		}
+		unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)total,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+		if (mapped) {
+			for (size_t i = 0; i < request.images.size(); i++) {
+				const Image& image = request.images[i];
+				const unsigned char* src = image.compressed.valid() ? image.compressed.data.data() : image.pixels;
+				if (src) memcpy(mapped + offsets[i], src, imageBytes(request, image));
+			}
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		else {
+			// sin PBO se sube directo desde memoria de CPU
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+
+		bool generateMipmaps = false;
+		GLint baseLevel = 0;
+		GLint maxLevel = 0;
+		glBindTexture(request.target, request.texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // filas RGB de ancho impar
+		for (size_t i = 0; i < request.images.size(); i++) {
+			Image& image = request.images[i];
+			GLenum face = request.target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)i : GL_TEXTURE_2D;
+
+			if (image.compressed.valid()) {
+				const CompressedTexture& tex = image.compressed;
+				bool srgb = request.gamma && tex.format != BLOCK_FORMAT_BC4 && tex.format != BLOCK_FORMAT_BC5;
+				size_t levels = uploadLevels(request, image);
+				size_t first = firstUploadLevel(request, image);
+				GLenum internalFormat = BlockFormatGL(tex.format, srgb);
+				for (size_t l = 0; l < first; l++) // sin el placeholder de 1x1 en el nivel 0
+					glCompressedTexImage2D(face, (GLint)l, internalFormat, 0, 0, 0, 0, nullptr);
+				for (size_t l = first; l < levels; l++) {
+					const CompressedLevel& level = tex.levels[l];
+					const void* source = mapped ? (const void*)(uintptr_t)(offsets[i] + level.offset) : (const void*)(tex.data.data() + level.offset);
+					glCompressedTexImage2D(face, (GLint)l, internalFormat, level.width, level.height, 0,
+						(GLsizei)level.size, source);
+				}
+				maxLevel = (GLint)levels - 1;
+				if (wantsMipmaps(request)) {
+					baseLevel = (GLint)first;
+					if (request.streamMips && image.onDisk)
+						TextureResidency::instance().track(request.texture, image.path, request.usage, internalFormat, tex, first);
+				}
+				continue;
+			}
+			if (!image.pixels) continue;
+
+			GLenum format = GL_RGBA;
+			GLenum internalFormat = request.gamma ? GL_SRGB8_ALPHA8 : GL_RGBA;
+			if (image.channels == 1) { format = GL_RED; internalFormat = GL_RED; }
+			else if (image.channels == 2) { format = GL_RG; internalFormat = GL_RG; }
+			else if (image.channels == 3) { format = GL_RGB; internalFormat = request.gamma ? GL_SRGB8 : GL_RGB; }
+
+			const void* source = mapped ? (const void*)(uintptr_t)offsets[i] : (const void*)image.pixels;
+			glTexImage2D(face, 0, internalFormat, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, source);
+			generateMipmaps = wantsMipmaps(request);
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		if (generateMipmaps) {
+			glTexParameteri(request.target, GL_TEXTURE_BASE_LEVEL, 0);
+			glTexParameteri(request.target, GL_TEXTURE_MAX_LEVEL, 1000);
+			ScopedLoadTimer mipTimer(request.images[0].path, "glGenerateMipmap");
+			glGenerateMipmap(request.target);
+		}
+		else if (wantsMipmaps(request)) {
+			// los mips ya vienen en el archivo: nada de glGenerateMipmap en el arranque
+			glTexParameteri(request.target, GL_TEXTURE_BASE_LEVEL, baseLevel);
+			glTexParameteri(request.target, GL_TEXTURE_MAX_LEVEL, maxLevel);
+		}
+		glBindTexture(request.target, 0);
+
+		if (mapped) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+
+		for (Image& image : request.images) {
+			stbi_image_free(image.pixels);
+			image.pixels = nullptr;
+			image.compressed = CompressedTexture();
+		}
+		return total;
+	}
+};
+
+#endif
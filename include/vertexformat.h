@@ -0,0 +1,116 @@
+#ifndef VERTEXFORMAT_H
+#define VERTEXFORMAT_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+
+/**
+ * @brief Empaquetado de atributos de vértice
+ * Normales y tangentes en 10:10:10:2 con signo (GL_INT_2_10_10_10_REV), UVs en half float,
+ * índices de hueso en uint8 y pesos en unorm8.
+ */
+
+// x en los bits 0-9, y en 10-19, z en 20-29 y w en 30-31 (complemento a dos)
+inline uint32_t PackSnorm1010102(const glm::vec3& v, float w)
+{
+	glm::vec3 c = glm::clamp(v, glm::vec3(-1.0f), glm::vec3(1.0f));
+	int32_t x = (int32_t)std::lround(c.x * 511.0f);
+	int32_t y = (int32_t)std::lround(c.y * 511.0f);
+	int32_t z = (int32_t)std::lround(c.z * 511.0f);
+	int32_t iw = w < 0.0f ? -1 : 1;
+	return ((uint32_t)x & 0x3FFu) | (((uint32_t)y & 0x3FFu) << 10) |
+		(((uint32_t)z & 0x3FFu) << 20) | (((uint32_t)iw & 0x3u) << 30);
+}
+
+inline glm::vec4 UnpackSnorm1010102(uint32_t p)
+{
+	// extensión de signo con desplazamientos aritméticos
+	int32_t x = (int32_t)(p << 22) >> 22;
+	int32_t y = (int32_t)(p << 12) >> 22;
+	int32_t z = (int32_t)(p << 2) >> 22;
+	int32_t w = (int32_t)p >> 30;
+	return glm::vec4(glm::max(x / 511.0f, -1.0f), glm::max(y / 511.0f, -1.0f),
+		glm::max(z / 511.0f, -1.0f), (float)glm::max(w, -1));
+}
+
+// float de 32 bits a half (IEEE 754 binary16) con redondeo al par más cercano
+inline uint16_t FloatToHalf(float value)
+{
+	uint32_t f;
+	memcpy(&f, &value, sizeof(f));
+	uint32_t sign = (f >> 16) & 0x8000u;
+	uint32_t exponent = (f >> 23) & 0xFFu;
+	uint32_t mantissa = f & 0x7FFFFFu;
+
+	if (exponent == 0xFFu) // inf / NaN
+		return (uint16_t)(sign | 0x7C00u | (mantissa ? 0x200u : 0u));
+
+	int32_t e = (int32_t)exponent - 127 + 15;
+	if (e >= 0x1F) // desbordamiento -> inf
+		return (uint16_t)(sign | 0x7C00u);
+	if (e <= 0) { // subnormal o cero
+		if (e < -10) return (uint16_t)sign;
+		mantissa |= 0x800000u;
+		uint32_t shift = (uint32_t)(14 - e);
+		uint32_t half = mantissa >> shift;
+		uint32_t rem = mantissa & ((1u << shift) - 1u);
+		uint32_t mid = 1u << (shift - 1);
+		if (rem > mid || (rem == mid && (half & 1u))) half++;
+		return (uint16_t)(sign | half);
+	}
+
+	uint32_t half = ((uint32_t)e << 10) | (mantissa >> 13);
+	uint32_t rem = mantissa & 0x1FFFu;
+	if (rem > 0x1000u || (rem == 0x1000u && (half & 1u))) half++; // puede subir al exponente: correcto
+	return (uint16_t)(sign | half);
+}
+
+inline float HalfToFloat(uint16_t h)
+{
+	uint32_t sign = ((uint32_t)h & 0x8000u) << 16;
+	uint32_t exponent = ((uint32_t)h >> 10) & 0x1Fu;
+	uint32_t mantissa = (uint32_t)h & 0x3FFu;
+	uint32_t f;
+	if (exponent == 0) {
+		if (mantissa == 0) f = sign;
+		else {
+			exponent = 127 - 15 + 1;
+			while ((mantissa & 0x400u) == 0) { mantissa <<= 1; exponent--; }
+			mantissa &= 0x3FFu;
+			f = sign | (exponent << 23) | (mantissa << 13);
+		}
+	}
+	else if (exponent == 0x1F) f = sign | 0x7F800000u | (mantissa << 13);
+	else f = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	float out;
+	memcpy(&out, &f, sizeof(out));
+	return out;
+}
+
+/**
+ * @brief Cuantiza pesos [0,1] a unorm8 conservando que la suma sea exactamente 255
+ * El residuo de redondeo se asigna a la influencia más fuerte.
+ */
+inline void QuantizeWeightsUnorm8(const float* weights, unsigned int count, uint8_t* out)
+{
+	int total = 0;
+	unsigned int strongest = 0;
+	float sum = 0.0f;
+	for (unsigned int i = 0; i < count; i++) sum += weights[i];
+	for (unsigned int i = 0; i < count; i++) {
+		float w = sum > 0.0f ? weights[i] / sum : 0.0f;
+		int q = (int)std::lround(w * 255.0f);
+		out[i] = (uint8_t)q;
+		total += q;
+		if (weights[i] > weights[strongest]) strongest = i;
+	}
+	if (sum > 0.0f) {
+		int fixed = (int)out[strongest] + (255 - total);
+		out[strongest] = (uint8_t)glm::clamp(fixed, 0, 255);
+	}
+}
+
+#endif
@@ -28,6 +28,8 @@
 #include <material.h>
 #include <light.h>
 #include <cubemap.h>
+#include <taskgraph.h>
+#include <LoadingScreen.h>
 
 #include <irrKlang.h>
 using namespace irrklang;
@@ -84,8 +86,8 @@ Material material;
 // Luces base y subconjuntos por objeto
 std::vector<Light> globalLights;
 
-// Audio
-ISoundEngine* SoundEngine = createIrrKlangDevice();
+// Audio (se crea en un hilo de trabajo durante Start)
+ISoundEngine* SoundEngine = nullptr;
 
 // Entrada a funcin principal
 int main()
@@ -130,32 +132,68 @@ bool Start() {
 		return false;
 	}
 
-	// DEPTH
-	glEnable(GL_DEPTH_TEST);
+	// Carga como grafo de tareas: lo independiente corre en paralelo en el JobSystem
+	// y el hilo principal dibuja la barra de progreso mientras ejecuta la parte de GL
+	LoadingScreen loadingScreen(window, 1);
+	loadingScreen.render();
+	TaskGraph startup;
+
+	// Audio
+	startup.addWorker("Audio", []() {
+		SoundEngine = createIrrKlangDevice();
+		if (!SoundEngine) std::cout << "Could not start the irrKlang sound engine" << std::endl;
+	}, {}, 0.5f);
 
 	// Compilacin y enlace de shaders
 	// (mismo VS/FS para los 3, instancias separadas)
-	const char* VS = "shaders/11_PhongShaderMultLights.vs";
-	const char* FS = "shaders/11_PhongShaderMultLights.fs";
-	phonIlumShader = new Shader(VS, FS);
-
-	cubemapShader = new Shader("shaders/10_vertex_cubemap.vs", "shaders/10_fragment_cubemap.fs");
-
-	// Modelos
-	lightDummy = new Model("models/lightDummy.fbx");
-	monsterHouse = new Model("models/monster_house.fbx");
+	TaskGraph::TaskId phongShaderTask = startup.addMain("Shader Phong", []() {
+		const char* VS = "shaders/11_PhongShaderMultLights_packed.vs";
+		const char* FS = "shaders/11_PhongShaderMultLights.fs";
+		phonIlumShader = new Shader(VS, FS);
+	}, {}, 0.5f);
+	TaskGraph::TaskId cubemapShaderTask = startup.addMain("Shader cubemap", []() {
+		cubemapShader = new Shader("shaders/10_vertex_cubemap.vs", "shaders/10_fragment_cubemap.fs");
+	}, {}, 0.5f);
+
+	// Modelos: importacin (bake o FBX) en hilos de trabajo, subida a la GPU en el hilo principal
+	lightDummy = new Model("models/lightDummy.fbx", false, MODEL_LOAD_DEFERRED);
+	monsterHouse = new Model("models/monster_house.fbx", false, MODEL_LOAD_DEFERRED);
+	TaskGraph::TaskId dummyImport = startup.addWorker("Importar lightDummy.fbx", []() { lightDummy->importModel(); });
+	TaskGraph::TaskId houseImport = startup.addWorker("Importar monster_house.fbx", []() { monsterHouse->importModel(); }, {}, 4.0f);
+	TaskGraph::TaskId dummyUpload = startup.addMain("Subir lightDummy", []() { lightDummy->uploadModel(); }, { dummyImport });
+	TaskGraph::TaskId houseUpload = startup.addMain("Subir monster_house", []() { monsterHouse->uploadModel(); }, { houseImport }, 2.0f);
+
+	// Cubemap: las caras se decodifican en el TextureStreamer
+	TaskGraph::TaskId cubemapTask = startup.addMain("Cubemap", []() {
+		std::vector<std::string> faces{
+			"textures/cubemap/01/px.jpg",
+			"textures/cubemap/01/nx.jpg",
+			"textures/cubemap/01/py.jpg",
+			"textures/cubemap/01/ny.jpg",
+			"textures/cubemap/01/pz.jpg",
+			"textures/cubemap/01/nz.jpg"
+		};
+		mainCubeMap = new CubeMap();
+		mainCubeMap->loadCubemap(faces);
+	}, {}, 0.5f);
+
+	// Texturas: todas las que pidieron los modelos y el cubemap ya estn en la GPU
+	startup.addWait("Texturas", []() { return TextureStreamer::instance().pendingCount() == 0; },
+		{ dummyUpload, houseUpload, cubemapTask, phongShaderTask, cubemapShaderTask }, 4.0f);
+
+	startup.start();
+	while (!startup.finished()) {
+		startup.pump();
+		TextureStreamer::instance().pump();
+		loadingScreen.updateProgress(startup.progress(), startup.currentTask());
+	}
+	startup.printTimings();
+	LoadProfiler::instance().print();
+	LoadProfiler::instance().writeJSON("load_profile.json");
+	glfwSetWindowTitle(window, "Illumination Models");
 
-	// Cubemap
-	std::vector<std::string> faces{
-		"textures/cubemap/01/px.jpg",
-		"textures/cubemap/01/nx.jpg",
-		"textures/cubemap/01/py.jpg",
-		"textures/cubemap/01/ny.jpg",
-		"textures/cubemap/01/pz.jpg",
-		"textures/cubemap/01/nz.jpg"
-	};
-	mainCubeMap = new CubeMap();
-	mainCubeMap->loadCubemap(faces);
+	// DEPTH
+	glEnable(GL_DEPTH_TEST);
 
 
 	Light l1;
@@ -212,6 +250,12 @@ bool Update() {
 	// Entrada
 	processInput(window);
 
+	// Texturas que terminaron de decodificarse en segundo plano
+	TextureStreamer::instance().pump();
+
+	// Mips grandes que pidieron los objetos en el frame anterior (y los que sobran si no hay memoria)
+	TextureResidency::instance().update();
+
 	// Clear con color oscuro para ver mejor
 	glClearColor(0.1f, 0.1f, 0.15f, 1.0f); // CAMBIADO
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -248,6 +292,7 @@ bool Update() {
 			lightModel = glm::scale(lightModel, glm::vec3(0.2f)); // Escala pequea
 			phonIlumShader->setMat4("model", lightModel);
 
+			TextureResidency::instance().require(lightDummy->textures_loaded, FLT_MAX);
 			lightDummy->Draw(*phonIlumShader);
 		}
 	}
@@ -273,6 +318,8 @@ bool Update() {
 		monsterHouseModel = glm::rotate(monsterHouseModel, glm::radians(-90.0f), glm::vec3(1, 0, 0));
 		phonIlumShader->setMat4("model", monsterHouseModel);
 
+		// la cmara recorre la casa por dentro: texturas completas
+		TextureResidency::instance().require(monsterHouse->textures_loaded, FLT_MAX);
 		monsterHouse->Draw(*phonIlumShader);
 	}
 
@@ -0,0 +1,525 @@
+// asset-baker: hornea fuera de línea los modelos y texturas que el juego convierte al arrancar.
+//
+// Escribe los mismos archivos que Model/AnimatedModel y TextureStreamer dejan junto a la fuente
+// (.mhbake con mallas soldadas, optimizadas para el caché de vértices y con LODs; .dds con BCn y
+// todos sus mips), así que el juego los toma tal cual. No crea contexto de GL: corre en las máquinas
+// del pipeline sin pantalla. Los archivos se procesan en paralelo en el JobSystem y se saltan los que
+// no cambiaron (hash del contenido + ajustes del baker, guardados en el manifiesto).
+//
+// Uso: asset-baker [--force] [--manifest archivo] [carpetas o archivos...]
+//      sin rutas usa assets/models y assets/textures
+
+#include <modelbake.h>
+#include <meshimport.h>
+#include <texturecompress.h>
+#include <texturecache.h>
+#include <animationdata.h>
+#include <animationcompress.h>
+#include <jobsystem.h>
+
+#include <stb_image.h>
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdint>
+#include <iostream>
+using namespace std;
+namespace fs = std::filesystem;
+
+// súbelo cuando cambie lo que el baker hace con una fuente: invalida todo el manifiesto
+#define ASSET_BAKER_VERSION 1u
+
+#define ASSET_BAKER_DEFAULT_MANIFEST "asset-baker.manifest"
+
+/*  ------------------------------------------------------------------
+ *  Hash de contenido y manifiesto
+ *  ------------------------------------------------------------------ */
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+{
+	const unsigned char* p = (const unsigned char*)data;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= p[i];
+		hash *= 0x100000001b3ull; // FNV-1a de 64 bits
+	}
+	return hash;
+}
+
+inline uint64_t HashString(const string& text)
+{
+	return HashBytes(text.data(), text.size());
+}
+
+// 0 si no se pudo leer
+inline uint64_t HashFile(const string& path, uint64_t& size)
+{
+	MappedFile file;
+	size = 0;
+	if (!file.open(path)) return 0;
+	size = file.size();
+	return HashBytes(file.data(), file.size());
+}
+
+/**
+ * @brief Hash del contenido y de los ajustes con que se horneó cada fuente
+ * Archivo de texto, una fuente por línea: "<hash contenido> <hash ajustes> <ruta>".
+ */
+class BakeManifest {
+public:
+	struct Entry {
+		uint64_t content;
+		uint64_t settings;
+	};
+
+	bool load(const string& path) {
+		ifstream in(path);
+		if (!in) return false;
+		string line;
+		while (getline(in, line)) {
+			istringstream fields(line);
+			Entry entry;
+			string source;
+			fields >> hex >> entry.content >> entry.settings >> ws;
+			getline(fields, source);
+			if (!fields.fail() && !source.empty()) entries[source] = entry;
+		}
+		return true;
+	}
+
+	bool save(const string& path) {
+		lock_guard<mutex> lock(entriesMutex);
+		FILE* f = OpenBakeFile(path, "w");
+		if (!f) return false;
+		for (const auto& e : entries)
+			fprintf(f, "%016llx %016llx %s\n", (unsigned long long)e.second.content, (unsigned long long)e.second.settings, e.first.c_str());
+		return fclose(f) == 0;
+	}
+
+	bool matches(const string& source, const Entry& current) {
+		lock_guard<mutex> lock(entriesMutex);
+		auto it = entries.find(source);
+		return it != entries.end() && it->second.content == current.content && it->second.settings == current.settings;
+	}
+
+	void set(const string& source, const Entry& entry) {
+		lock_guard<mutex> lock(entriesMutex);
+		entries[source] = entry;
+	}
+
+private:
+	map<string, Entry> entries; // ordenado para que el archivo se pueda comparar con diff
+	mutex entriesMutex;
+};
+
+/*  ------------------------------------------------------------------
+ *  Reporte
+ *  ------------------------------------------------------------------ */
+
+enum AssetStatus {
+	ASSET_BAKED,
+	ASSET_UP_TO_DATE,
+	ASSET_FAILED
+};
+
+struct AssetReport {
+	string      path;
+	bool        texture;
+	AssetStatus status;
+	uint64_t    sourceBytes;
+	uint64_t    bakeBytes;
+	double      seconds;
+	// modelos
+	bool        skinned;
+	size_t      meshes;
+	size_t      triangles;       // LOD0
+	size_t      coarseTriangles; // nivel más burdo de cada malla
+	size_t      lods;
+	size_t      bones;
+	size_t      clips;
+	size_t      keysRemoved;     // llaves redundantes quitadas (sólo al hornear)
+	vector<string> clipCompression; // razón y peor error de cada clip comprimido como en AnimatedModel
+	// texturas
+	int         width, height;
+	size_t      mips;
+	BlockFormat format;
+
+	AssetReport() : texture(false), status(ASSET_FAILED), sourceBytes(0), bakeBytes(0), seconds(0.0), skinned(false), meshes(0),
+		triangles(0), coarseTriangles(0), lods(0), bones(0), clips(0), keysRemoved(0), width(0), height(0), mips(0), format(BLOCK_FORMAT_NONE) {}
+};
+
+// textura que usa algún material, con el uso que decide su formato
+struct TextureJob {
+	string       path;
+	TextureUsage usage;
+};
+
+inline uint64_t FileSize(const string& path)
+{
+	error_code ec;
+	uintmax_t size = fs::file_size(path, ec);
+	return ec ? 0 : (uint64_t)size;
+}
+
+/*  ------------------------------------------------------------------
+ *  Modelos
+ *  ------------------------------------------------------------------ */
+
+// malla lista para WriteModelBake (los vértices ya en su formato nativo)
+struct PreparedMesh {
+	uint32_t              format;
+	vector<unsigned char> vertices;
+	size_t                vertexCount;
+	vector<Texture>       textures;
+	MeshData*             data;
+};
+
+template <typename VertexT>
+PreparedMesh PrepareMesh(MeshData& data, const vector<BakedTextureRef>& refs)
+{
+	PreparedMesh mesh;
+	vector<VertexT> vertices = ConvertVertices<VertexT>(data.vertices);
+	mesh.format = (uint32_t)VertexT::format();
+	mesh.vertexCount = vertices.size();
+	mesh.vertices.assign((const unsigned char*)vertices.data(), (const unsigned char*)(vertices.data() + vertices.size()));
+	for (const BakedTextureRef& ref : refs)
+		mesh.textures.push_back(Texture{ 0, ref.type, ref.path });
+	if (data.lods.empty()) // como Mesh::setLods: un solo nivel con todos los índices
+		data.lods.push_back(MeshLod{ 0, (unsigned int)data.indices.size(), 0.0f });
+	mesh.data = &data;
+	return mesh;
+}
+
+inline string ModelSettings()
+{
+	ostringstream s;
+	s << "model baker " << ASSET_BAKER_VERSION << " bake " << MODEL_BAKE_VERSION << " formats " << BakeVertexFormatSizes();
+	return s.str();
+}
+
+/**
+ * @brief Importa un modelo con Assimp y escribe su .mhbake como lo haría el juego
+ * Un modelo con huesos se hornea como AnimatedModel (SkinnedVertex, sin LODs ni materiales); los demás
+ * como Model (StaticTangentVertex si el material tiene mapa de normales, LODs y materiales). Si el juego lo
+ * carga con la otra clase, el cargador ve que el bake no le sirve (BakeHasMeshesFor) y reimporta.
+ */
+inline bool BakeModel(const string& path, AssetReport& report)
+{
+	Assimp::Importer importer;
+	const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+		cout << "ERROR::ASSIMP:: " << path << ": " << importer.GetErrorString() << endl;
+		return false;
+	}
+
+	bool skinned = false;
+	for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+		skinned = skinned || scene->mMeshes[m]->HasBones();
+
+	vector<MeshData> meshData = ConvertSceneMeshes(scene->mRootNode, scene, !skinned);
+
+	// Model guarda primero las mallas sin mapa de normales y luego las que lo tienen
+	vector<PreparedMesh> plain, normalMapped;
+	for (MeshData& data : meshData) {
+		const aiMaterial* material = scene->mMaterials[data.source->mMaterialIndex];
+		vector<BakedTextureRef> refs = CollectMaterialTextureRefs(material, !skinned);
+		bool hasNormalMap = false;
+		for (const BakedTextureRef& ref : refs)
+			hasNormalMap = hasNormalMap || ref.type == "texture_normal";
+		if (skinned)
+			plain.push_back(PrepareMesh<SkinnedVertex>(data, refs));
+		else if (hasNormalMap)
+			normalMapped.push_back(PrepareMesh<StaticTangentVertex>(data, refs));
+		else
+			plain.push_back(PrepareMesh<StaticVertex>(data, refs));
+	}
+	vector<BakeMeshSource> bakeMeshes;
+	for (const vector<PreparedMesh>* group : { &plain, &normalMapped })
+		for (const PreparedMesh& m : *group)
+			bakeMeshes.push_back({ m.format, m.vertices.data(), m.vertexCount, &m.data->indices, m.data->materialIndex, &m.textures, &m.data->lods });
+
+	vector<BakedMaterial> materials;
+	if (!skinned)
+		for (unsigned int i = 0; i < scene->mNumMaterials; i++)
+			materials.push_back(ReadBakedMaterial(scene->mMaterials[i]));
+
+	// los huesos de la última malla, como en los cargadores
+	vector<Bone> bones;
+	if (!meshData.empty()) bones = meshData.back().bones;
+
+	NodeHierarchy nodes;
+	BuildNodeHierarchy(scene->mRootNode, -1, nodes);
+	vector<AnimationClip> animations = BuildAnimationClips(scene, nodes);
+	for (AnimationClip& clip : animations)
+		report.keysRemoved += CompactAnimationClip(clip);
+
+	aiMatrix4x4 inverseTransform = scene->mRootNode->mTransformation;
+	inverseTransform.Inverse();
+	return WriteModelBake(path, nodes, animations, bakeMeshes, materials, bones, AiMatrixToGlm(inverseTransform));
+}
+
+// llena el reporte desde el bake y agrega las texturas que piden sus materiales
+inline bool InspectModelBake(const string& path, AssetReport& report, vector<TextureJob>& textures)
+{
+	BakedModel baked;
+	if (!LoadModelBake(path, baked)) return false;
+	report.skinned = !BakeHasMeshesFor(baked, false);
+	string directory = fs::path(path).parent_path().generic_string();
+	report.meshes = baked.meshes.size();
+	for (const BakedMesh& mesh : baked.meshes) {
+		report.triangles += (mesh.lods.empty() ? mesh.indexCount : mesh.lods.front().indexCount) / 3;
+		report.coarseTriangles += (mesh.lods.empty() ? mesh.indexCount : mesh.lods.back().indexCount) / 3;
+		report.lods = std::max(report.lods, mesh.lods.size());
+		for (const BakedTextureRef& ref : mesh.textures)
+			if (ref.path != "procedural_color")
+				textures.push_back(TextureJob{ directory + '/' + ref.path, TextureUsageForType(ref.type) });
+	}
+	report.bones = baked.bones.size();
+	report.clips = baked.animations.size();
+	for (const AnimationClip& clip : baked.animations) {
+		AnimationCompressionReport compression;
+		CompressAnimationClip(clip, AnimationCompressionSettings(), &compression);
+		report.clipCompression.push_back(compression.summary(clip.name));
+	}
+	report.bakeBytes = baked.file.size();
+	return true;
+}
+
+/*  ------------------------------------------------------------------
+ *  Texturas
+ *  ------------------------------------------------------------------ */
+
+inline string TextureSettings(TextureUsage usage)
+{
+	ostringstream s;
+	s << "texture baker " << ASSET_BAKER_VERSION << " bake " << TEXTURE_BAKE_VERSION << " usage " << (int)usage << " mips";
+	return s.str();
+}
+
+// igual que TextureStreamer con compresión y mips, pero con todos los formatos de bloque disponibles
+inline bool BakeTexture(const TextureJob& job)
+{
+	int width, height, channels;
+	unsigned char* pixels = stbi_load(job.path.c_str(), &width, &height, &channels, 4);
+	if (!pixels) {
+		cout << "ERROR:: could not decode " << job.path << ": " << stbi_failure_reason() << endl;
+		return false;
+	}
+	BlockFormat format = ChooseBlockFormat(job.usage, pixels, (size_t)width * height, BlockFormatSupport::all());
+	CompressedTexture compressed;
+	CompressTexture(pixels, width, height, format, true, job.usage == TEXTURE_USAGE_NORMAL, compressed);
+	stbi_image_free(pixels);
+	return WriteTextureBake(job.path, job.usage, compressed);
+}
+
+inline bool InspectTextureBake(const TextureJob& job, AssetReport& report)
+{
+	CompressedTexture compressed;
+	if (!LoadTextureBake(job.path, job.usage, compressed)) return false;
+	report.width = compressed.width;
+	report.height = compressed.height;
+	report.mips = compressed.levels.size();
+	report.format = compressed.format;
+	report.bakeBytes = FileSize(GetTextureBakePath(job.path));
+	return true;
+}
+
+/*  ------------------------------------------------------------------
+ *  Recorrido de las entradas
+ *  ------------------------------------------------------------------ */
+
+inline string LowerExtension(const fs::path& path)
+{
+	string ext = path.extension().string();
+	for (char& c : ext) c = (char)tolower((unsigned char)c);
+	return ext;
+}
+
+inline bool IsImageFile(const fs::path& path)
+{
+	static const set<string> extensions = { ".jpg", ".jpeg", ".png", ".tga", ".bmp" };
+	return extensions.count(LowerExtension(path)) > 0;
+}
+
+inline bool IsModelFile(const fs::path& path)
+{
+	static const set<string> extensions = { ".fbx", ".obj", ".dae", ".gltf", ".glb", ".3ds", ".blend" };
+	return extensions.count(LowerExtension(path)) > 0;
+}
+
+inline void CollectInputs(const string& root, vector<string>& models, vector<string>& images)
+{
+	error_code ec;
+	auto visit = [&](const fs::path& path) {
+		if (IsModelFile(path)) models.push_back(path.generic_string());
+		else if (IsImageFile(path)) images.push_back(path.generic_string());
+	};
+	if (fs::is_regular_file(root, ec)) {
+		visit(fs::path(root));
+		return;
+	}
+	if (!fs::is_directory(root, ec)) {
+		cout << "asset-baker: skipping " << root << " (not found)" << endl;
+		return;
+	}
+	for (fs::recursive_directory_iterator it(root, ec), end; it != end; it.increment(ec))
+		if (it->is_regular_file(ec)) visit(it->path());
+}
+
+inline const char* StatusName(AssetStatus status)
+{
+	switch (status) {
+	case ASSET_BAKED:      return "baked";
+	case ASSET_UP_TO_DATE: return "up to date";
+	default:               return "FAILED";
+	}
+}
+
+inline void PrintReport(const vector<AssetReport>& models, const vector<AssetReport>& textures, double seconds)
+{
+	char line[512];
+	uint64_t sourceTotal = 0, bakeTotal = 0;
+	size_t baked = 0, skipped = 0, failed = 0;
+	auto count = [&](const AssetReport& r) {
+		sourceTotal += r.sourceBytes;
+		bakeTotal += r.bakeBytes;
+		if (r.status == ASSET_BAKED) baked++;
+		else if (r.status == ASSET_UP_TO_DATE) skipped++;
+		else failed++;
+	};
+
+	cout << endl << "MODELS" << endl;
+	snprintf(line, sizeof(line), "  %-40s %-10s %9s %9s %6s %9s %9s %4s %5s %5s %8s", "asset", "status", "src KB", "bake KB",
+		"meshes", "tris", "tris LODn", "lods", "bones", "clips", "ms");
+	cout << line << endl;
+	for (const AssetReport& r : models) {
+		snprintf(line, sizeof(line), "  %-40s %-10s %9llu %9llu %6zu %9zu %9zu %4zu %5zu %5zu %8.1f%s", r.path.c_str(), StatusName(r.status),
+			(unsigned long long)(r.sourceBytes / 1024), (unsigned long long)(r.bakeBytes / 1024), r.meshes, r.triangles, r.coarseTriangles,
+			r.lods, r.bones, r.clips, r.seconds * 1000.0, r.skinned ? "  skinned" : "");
+		cout << line;
+		if (r.keysRemoved > 0) cout << "  (-" << r.keysRemoved << " keys)";
+		cout << endl;
+		for (const string& clip : r.clipCompression)
+			cout << "      clip " << clip << endl;
+		count(r);
+	}
+
+	cout << endl << "TEXTURES" << endl;
+	snprintf(line, sizeof(line), "  %-52s %-10s %9s %9s %11s %6s %4s %8s", "asset", "status", "src KB", "bake KB", "size", "format", "mips", "ms");
+	cout << line << endl;
+	for (const AssetReport& r : textures) {
+		char size[32];
+		snprintf(size, sizeof(size), "%dx%d", r.width, r.height);
+		snprintf(line, sizeof(line), "  %-52s %-10s %9llu %9llu %11s %6s %4zu %8.1f", r.path.c_str(), StatusName(r.status),
+			(unsigned long long)(r.sourceBytes / 1024), (unsigned long long)(r.bakeBytes / 1024), size, BlockFormatName(r.format),
+			r.mips, r.seconds * 1000.0);
+		cout << line << endl;
+		count(r);
+	}
+
+	snprintf(line, sizeof(line), "%zu baked, %zu up to date, %zu failed; %.1f MB of sources -> %.1f MB of bakes in %.2f s",
+		baked, skipped, failed, sourceTotal / (1024.0 * 1024.0), bakeTotal / (1024.0 * 1024.0), seconds);
+	cout << endl << line << endl;
+}
+
+int main(int argc, char** argv)
+{
+	bool force = false;
+	string manifestPath = ASSET_BAKER_DEFAULT_MANIFEST;
+	vector<string> roots;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--force") force = true;
+		else if (arg == "--manifest" && i + 1 < argc) manifestPath = argv[++i];
+		else if (arg == "--help" || arg == "-h") {
+			cout << "usage: asset-baker [--force] [--manifest file] [dirs or files...]" << endl
+				<< "  bakes models (.mhbake) and textures (.dds) next to their sources; default dirs: assets/models assets/textures" << endl;
+			return 0;
+		}
+		else roots.push_back(arg);
+	}
+	if (roots.empty()) roots = { "assets/models", "assets/textures" };
+
+	auto begin = chrono::steady_clock::now();
+	BakeManifest manifest;
+	if (!force) manifest.load(manifestPath);
+
+	vector<string> modelPaths, imagePaths;
+	for (const string& root : roots)
+		CollectInputs(root, modelPaths, imagePaths);
+
+	// 1. Modelos; de sus bakes salen las texturas que usan y con qué uso
+	vector<AssetReport> models(modelPaths.size());
+	vector<vector<TextureJob>> referenced(modelPaths.size());
+	uint64_t modelSettings = HashString(ModelSettings());
+	JobSystem::instance().parallelFor(modelPaths.size(), [&](size_t i) {
+		auto start = chrono::steady_clock::now();
+		const string& path = modelPaths[i];
+		AssetReport& report = models[i];
+		report.path = path;
+		BakeManifest::Entry entry{ HashFile(path, report.sourceBytes), modelSettings };
+
+		bool upToDate = !force && manifest.matches(path, entry) && RestampModelBake(path);
+		if (upToDate) report.status = ASSET_UP_TO_DATE;
+		else if (BakeModel(path, report)) report.status = ASSET_BAKED;
+		if (report.status != ASSET_FAILED && !InspectModelBake(path, report, referenced[i]))
+			report.status = ASSET_FAILED;
+		if (report.status != ASSET_FAILED) manifest.set(path, entry);
+		report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	});
+
+	// 2. Texturas: las de los materiales (los mapas de normales van a BC5) más las imágenes sueltas
+	vector<TextureJob> textureJobs;
+	map<string, size_t> textureIndex; // ruta canónica -> trabajo
+	auto addTexture = [&](const TextureJob& job) {
+		auto it = textureIndex.find(CanonicalTexturePath(job.path));
+		if (it == textureIndex.end()) {
+			textureIndex[CanonicalTexturePath(job.path)] = textureJobs.size();
+			textureJobs.push_back(job);
+		}
+		else if (job.usage == TEXTURE_USAGE_NORMAL)
+			textureJobs[it->second].usage = TEXTURE_USAGE_NORMAL;
+	};
+	for (const vector<TextureJob>& jobs : referenced)
+		for (const TextureJob& job : jobs)
+			if (fs::exists(job.path)) addTexture(job);
+			else cout << "asset-baker: missing texture " << job.path << endl;
+	for (const string& image : imagePaths)
+		addTexture(TextureJob{ image, TEXTURE_USAGE_COLOR });
+
+	vector<AssetReport> textures(textureJobs.size());
+	JobSystem::instance().parallelFor(textureJobs.size(), [&](size_t i) {
+		auto start = chrono::steady_clock::now();
+		const TextureJob& job = textureJobs[i];
+		AssetReport& report = textures[i];
+		report.path = job.path;
+		report.texture = true;
+		BakeManifest::Entry entry{ HashFile(job.path, report.sourceBytes), HashString(TextureSettings(job.usage)) };
+
+		bool upToDate = !force && manifest.matches(job.path, entry) && RestampTextureBake(job.path, job.usage);
+		if (upToDate) report.status = ASSET_UP_TO_DATE;
+		else if (BakeTexture(job)) report.status = ASSET_BAKED;
+		if (report.status != ASSET_FAILED && !InspectTextureBake(job, report))
+			report.status = ASSET_FAILED;
+		if (report.status != ASSET_FAILED) manifest.set(job.path, entry);
+		report.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	});
+
+	if (!manifest.save(manifestPath))
+		cout << "asset-baker: could not write " << manifestPath << endl;
+
+	PrintReport(models, textures, chrono::duration<double>(chrono::steady_clock::now() - begin).count());
+	for (const AssetReport& r : models) if (r.status == ASSET_FAILED) return 1;
+	for (const AssetReport& r : textures) if (r.status == ASSET_FAILED) return 1;
+	return 0;
+}